@@ -0,0 +1,79 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+// pattern-bench measures the cost of rendering a record, per record,
+// with the patterns compiled at runtime against the compile time ones
+// of the same layout.
+#include <time.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <slog/pattern.h>
+#include <slog/runtime_pattern.h>
+
+using namespace std;
+using namespace slog;
+
+namespace {
+
+// cpu_time is the CPU time of the thread, the time the benchmark
+// is preempted is not counted
+chrono::nanoseconds cpu_time() {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return chrono::seconds(ts.tv_sec) + chrono::nanoseconds(ts.tv_nsec);
+}
+
+template <typename P>
+double ns_per_record(const P& pattern, string& out) {
+    const string name{"bench"};
+    int rounds = 0;
+    auto start = cpu_time();
+    auto elapsed = chrono::nanoseconds(0);
+    do {
+        // the time of the records advances, as in the loggers
+        for (int i = 0; i < 1000; i++) {
+            pattern::Record r{LogLevel::Info, name, chrono::system_clock::now()};
+            pattern.Format(out, r, "order %d of %s shipped", i, "alice");
+        }
+        rounds++;
+        elapsed = cpu_time() - start;
+    } while (elapsed < chrono::milliseconds(50));
+    return elapsed.count() / (rounds * 1000.0);
+}
+
+template <typename P>
+void run(const char *layout, const P& pattern, const RuntimePattern& runtime) {
+    // the best of alternating trials, the machine noise only adds
+    string a, b;
+    double p = 1e9, r = 1e9;
+    for (int i = 0; i < 20; i++) {
+        p = min(p, ns_per_record(pattern, a));
+        r = min(r, ns_per_record(runtime, b));
+    }
+    // both render the same layout, but for the time
+    if (a.size() != b.size()) {
+        fprintf(stderr, "%s: layouts differ:\n  %s\n  %s\n", layout, a.c_str(), b.c_str());
+    }
+    printf("%-32s %12.0f %12.0f %+12.0f %9.2fx\n", layout, p, r, r - p, r / p);
+}
+
+} // namespace
+
+int main() {
+    printf("%-32s %12s %12s %12s %10s\n", "layout", "Pattern ns", "Runtime ns", "overhead ns", "ratio");
+    run("DefaultPattern", DefaultPattern{}, RuntimePattern{});
+    run("timestamp us, tid, level, name",
+        Pattern<pattern::Timestamp<pattern::us>, pattern::ThreadId, pattern::Level, pattern::Name,
+                pattern::Message>{},
+        RuntimePattern{"[%Y-%m-%d %H:%M:%S.%f] [%t] [%L] [%n] %v"});
+    run("level, message",
+        Pattern<pattern::Level, pattern::Message>{}, RuntimePattern{"[%L] %v"});
+    return 0;
+}
@@ -0,0 +1,130 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_COMPRESSION_H_
+#define __SLOG_COMPRESSION_H_
+
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <slog/memory.h>
+
+namespace slog {
+namespace lz {
+
+/**
+ * A small LZ77 block compressor in the spirit of LZ4, so that slog
+ * keeps depending on nothing but the C++ standard library.
+ *
+ * A compressed block is a sequence of:
+ *
+ *    token | [literal length bytes] | literals | offset | [match length bytes]
+ *
+ * The token holds the literal length in its high and the match length
+ * (minus 4) in its low nibble, a nibble of 15 continues in the following
+ * bytes, each adding up to 255. The offset is 16 bits little endian.
+ * The last sequence of a block has literals only.
+*/
+
+// Compress compresses n bytes of src and appends them to out.
+// Returns the number of bytes appended.
+size_t Compress(const char *src, size_t n, std::string& out);
+
+// Decompress decompresses a block of n bytes which inflates to
+// raw_size bytes, and appends them to out. Returns false if the
+// block is corrupt.
+bool Decompress(const char *src, size_t n, size_t raw_size, std::string& out);
+
+/**
+ * Compressed log files are a sequence of independently decodable
+ * frames, each holding a block of whole records:
+ *
+ *    magic | flags | raw size | data size | checksum | data
+ *
+ * All the header fields are 32 bits little endian, the checksum is
+ * the FNV-1a hash of the raw data. A block that does not compress is
+ * stored as-is and flagged with frame_stored.
+*/
+const uint32_t frame_magic = 0x315a4c53; // "SLZ1"
+const uint32_t frame_stored = 0x1;
+const size_t frame_header_size = 20;
+
+enum frame_status_t {
+    frame_ok,
+    frame_incomplete, // not enough data, e.g. a torn frame at the end of file
+    frame_corrupt
+};
+
+// EncodeFrame appends a frame of the given raw block to out.
+void EncodeFrame(const char *raw, size_t n, std::string& out);
+
+// DecodeFrame decodes the frame at the beginning of the n bytes of src,
+// appends its records to out and sets consumed to the frame size.
+frame_status_t DecodeFrame(const char *src, size_t n, std::string& out, size_t& consumed);
+
+// checksum returns the FNV-1a hash of the data.
+uint32_t checksum(const char *data, size_t n);
+
+} // namespace lz
+
+/**
+ * BlockWriter collects the records into blocks and writes them as
+ * compressed frames to the given file. Compression and writing is
+ * done on a background thread, the callers only copy the records into
+ * the current block.
+ *
+ * A crash loses at most the records of the not yet written blocks.
+ */
+class BlockWriter {
+public:
+    // Maximum number of sealed blocks waiting for the background
+    // thread, Append() blocks when the compressor falls that far behind.
+    static const size_t MaxPendingBlocks = 16;
+
+    // BlockWriter allocates the blocks from the given memory resource
+    BlockWriter(FILE *fp, size_t block_size, MemoryResource *memory = nullptr);
+    ~BlockWriter();
+
+    // Do not support copying/assigning objects
+    BlockWriter(const BlockWriter &) = delete;
+    BlockWriter &operator=(const BlockWriter &) = delete;
+
+    // Append adds a record of len bytes to the current block, terminated
+    // with a line feed if it has none. Records are never split across blocks.
+    // Returns false if the record is dropped, as the memory resource
+    // refused to grow the block.
+    bool Append(const char *data, size_t len);
+
+    // Flush writes out the current block, waits for all the pending
+    // blocks to be written and flushes the file.
+    void Flush();
+
+private:
+    void seal();
+    void run();
+
+    FILE *fp_;
+    size_t block_size_;
+    std::mutex mutex_;
+    std::condition_variable work_cv_; // signals the writer thread
+    std::condition_variable done_cv_; // signals the waiting callers
+    MemoryResource *memory_;
+    MemoryBuffer current_;
+    std::deque<MemoryBuffer> pending_;
+    bool busy_{false};
+    bool stop_{false};
+    std::thread thread_;
+}; // class BlockWriter
+
+} // namespace slog
+
+#endif // __SLOG_COMPRESSION_H_
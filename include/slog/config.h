@@ -0,0 +1,325 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_CONFIG_H_
+#define __SLOG_CONFIG_H_
+
+#include <atomic>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <slog/logger.h>
+#include <slog/runtime_pattern.h>
+
+namespace slog {
+
+/**
+ * ConfigException is thrown when a configuration
+ * file could not be read or is invalid
+*/
+class ConfigException: public std::exception {
+public:
+    ConfigException(const std::string& file, const std::string& msg)
+        : file_(file), error_(file + ": " + msg) {}
+
+    const char *what() const noexcept {
+        return error_.c_str();
+    }
+
+    const std::string& file() const {
+        return file_;
+    }
+
+private:
+    std::string file_;  // configuration file name
+    std::string error_; // error string
+}; // class ConfigException
+
+class ConfiguredLogger;
+
+/**
+ * Config builds the loggers and the targets from a configuration file:
+ *
+ *    # targets, [target.<name>]
+ *    [target.app]
+ *    type = file               # file, sharded, console, stdout, stderr or shm
+ *    path = logs/app.log       # file/sharded: file name, shm: queue name
+ *    level = trace
+ *    index_interval = 65536    # file: see FileOptions
+ *    compress_block = 0
+ *    framed = false
+ *    escape = false
+ *    memory_budget = 1048576   # file: bytes, see FileOptions::memory
+ *    spill = 4194304           # file: bytes, see FileOptions::spill
+ *    spill_timeout_ms = 50
+ *    flush_level = error       # see FlushPolicy
+ *    flush_every = 0
+ *    flush_interval_ms = 200
+ *    sync = false
+ *    redact = password=*, token=*  # see RedactorOptions
+ *    redact_cards = true
+ *    throttle_latency_us = 2000  # see GovernorOptions
+ *    throttle_lock_wait_us = 1000
+ *    throttle_recovery_ms = 1000
+ *    throttle_floor = debug
+ *
+ *    [target.console]
+ *    type = console
+ *    stream = stdout           # stdout or stderr
+ *    color = auto              # auto, always or never
+ *    buffer_size = 65536
+ *    flush_interval_ms = 100
+ *
+ *    # loggers, [logger.<name>]
+ *    [logger.app]
+ *    level = info
+ *    pattern = %Y-%m-%d %H:%M:%S.%f [%p:%t] %l %n: %v
+ *    targets = app, console
+ *    payload_limit = 65536     # see BasicLogger::SetPayloadLimit
+ *    memory_budget = 1048576   # see BasicLogger::SetMemoryAccount
+ *    degrade_level = debug
+ *
+ * Lines starting with '#' or ';' are comments. Loggers that are not
+ * configured are served by the "default" logger, if there is one,
+ * else by a logger with the default level logging to stdout.
+ *
+ * Reload() builds the new logger graph from the file, off the logging
+ * path, and swaps it in atomically. Targets with an unchanged
+ * configuration are carried over to the new graph, so their files stay
+ * open. Watch() reloads the configuration on every change of the file.
+ *
+ * The replaced graph is released by Reload() itself, on the reloading
+ * thread, once no thread is still logging with it: Reload() waits for
+ * the log calls in flight to complete. A graph still in use by the
+ * reloading thread itself is released by the next reload.
+ */
+class Config {
+public:
+    using logger_t = BasicLogger<RuntimePattern>;
+
+    // Config loads the configuration file, throws ConfigException
+    // if it could not be read or is invalid.
+    explicit Config(const std::string& path) noexcept(false);
+    ~Config();
+
+    // Do not support copying/assigning objects
+    Config(const Config &) = delete;
+    Config &operator=(const Config &) = delete;
+
+    // Get returns the handle of the named logger, which follows the
+    // configuration reloads. It must not outlive the Config.
+    ConfiguredLogger Get(const std::string& name) const;
+
+    // Logger returns the named logger of the current configuration
+    std::shared_ptr<logger_t> Logger(const std::string& name) const;
+
+    // Reload reads the configuration file again. On failure the
+    // current configuration is kept, see LastError().
+    bool Reload();
+
+    // Watch starts watching the configuration file for changes,
+    // it is reloaded on every change. Throws ConfigException if the
+    // file could not be watched.
+    void Watch();
+
+    // Unwatch stops watching the configuration file
+    void Unwatch();
+
+    // Generation is incremented on every successful reload
+    uint64_t Generation() const {
+        return generation_.load(std::memory_order_acquire);
+    }
+
+    // LastError returns the error of the last failed reload
+    std::string LastError() const;
+
+private:
+    friend class ConfiguredLogger;
+    struct graph_t;
+
+    // reader_t tells Reload() which graphs a thread may be logging
+    // with, see ConfiguredLogger::current(). Written by its thread only.
+    struct reader_t {
+        explicit reader_t(std::thread::id id): owner(id) {}
+        std::atomic<uint32_t> depth{0};      // nested log calls of the thread
+        std::atomic<uint64_t> generation{0}; // pinned by the outermost one
+        const std::thread::id owner;
+    };
+
+    std::shared_ptr<graph_t> build(const std::string& text) const noexcept(false);
+    // quiesce waits for the threads logging with a graph older than the
+    // given generation, returns false if the calling thread itself is.
+    bool quiesce(uint64_t generation) const;
+    // reader registers a reader of the calling thread
+    std::shared_ptr<reader_t> reader() const;
+    void watch();
+    // key returns the process wide unique key of the named logger
+    // of this configuration, used by the ConfiguredLogger caches.
+    uint64_t key(const std::string& name) const;
+
+    std::string path_;
+    std::shared_ptr<graph_t> graph_; // accessed with std::atomic_load/store only
+    std::atomic<uint64_t> generation_{0};
+    mutable std::mutex mutex_;       // serializes reloads, protects error_ and keys_
+    std::string error_;
+    mutable std::map<std::string, uint64_t> keys_; // see key()
+    std::vector<std::shared_ptr<graph_t> > retired_; // replaced, still in use, see Reload()
+    std::shared_ptr<const char> alive_{std::make_shared<const char>(0)}; // expires with the Config
+    mutable std::mutex readers_mutex_;
+    mutable std::vector<std::shared_ptr<reader_t> > readers_;
+    std::thread watcher_;
+    int inotify_fd_{-1};
+    int stop_fd_{-1};                // wakes up the watcher thread
+}; // class Config
+
+/**
+ * ConfiguredLogger is a handle of a configured logger. Each thread
+ * caches the logger of the current configuration, a reload is picked
+ * up on the next log call of the thread by comparing the configuration
+ * generation. The cache holds no reference to the loggers: each log
+ * call pins the generation it started with, so that Reload() knows
+ * when the replaced loggers can be released. The handles of the same
+ * logger share the cache entry, the entries of the destroyed
+ * configurations are dropped when a thread caches a new logger.
+ *
+ * The streams returned by a handle must not outlive it.
+ */
+class ConfiguredLogger {
+    friend class LogStream<ConfiguredLogger>;
+public:
+    // pin_t is the logger of the calling thread, pinned until
+    // it goes out of scope
+    class pin_t {
+    public:
+        pin_t(Config::reader_t *reader, Config::logger_t *logger)
+            : reader_(reader), logger_(logger) {}
+
+        pin_t(pin_t&& other): reader_(other.reader_), logger_(other.logger_) {
+            other.reader_ = nullptr;
+        }
+
+        // Do not support copying/assigning objects
+        pin_t(const pin_t &) = delete;
+        pin_t &operator=(const pin_t &) = delete;
+
+        ~pin_t() {
+            if (!reader_) return;
+            // pairs with the loads of Config::quiesce()
+            reader_->depth.store(reader_->depth.load(std::memory_order_relaxed) - 1,
+                                 std::memory_order_release);
+        }
+
+        Config::logger_t *operator->() const {
+            return logger_;
+        }
+
+        Config::logger_t &operator*() const {
+            return *logger_;
+        }
+
+    private:
+        Config::reader_t *reader_;
+        Config::logger_t *logger_;
+    }; // class pin_t
+
+    ConfiguredLogger(const Config& config, const std::string& name);
+
+    template <typename ...Args>
+    void Trace(const std::string& frmt, Args&&... args) {
+        current()->Trace(frmt, std::forward<Args>(args)...);
+    }
+
+    template <typename ...Args>
+    void Debug(const std::string& frmt, Args&&... args) {
+        current()->Debug(frmt, std::forward<Args>(args)...);
+    }
+
+    template <typename ...Args>
+    void Info(const std::string& frmt, Args&&... args) {
+        current()->Info(frmt, std::forward<Args>(args)...);
+    }
+
+    template <typename ...Args>
+    void Warning(const std::string& frmt, Args&&... args) {
+        current()->Warning(frmt, std::forward<Args>(args)...);
+    }
+
+    template <typename ...Args>
+    void Error(const std::string& frmt, Args&&... args) {
+        current()->Error(frmt, std::forward<Args>(args)...);
+    }
+
+    template <typename ...Args>
+    void Critical(const std::string& frmt, Args&&... args) {
+        current()->Critical(frmt, std::forward<Args>(args)...);
+    }
+
+    template <typename ...Args>
+    void LogPayload(LogLevel::level_t level, const Payload& payload, const std::string& frmt, Args&&... args) {
+        current()->LogPayload(level, payload, frmt, std::forward<Args>(args)...);
+    }
+
+    LogStream<ConfiguredLogger> Trace() {
+        return Stream(LogLevel::Trace);
+    }
+
+    LogStream<ConfiguredLogger> Debug() {
+        return Stream(LogLevel::Debug);
+    }
+
+    LogStream<ConfiguredLogger> Info() {
+        return Stream(LogLevel::Info);
+    }
+
+    LogStream<ConfiguredLogger> Warning() {
+        return Stream(LogLevel::Warning);
+    }
+
+    LogStream<ConfiguredLogger> Error() {
+        return Stream(LogLevel::Error);
+    }
+
+    LogStream<ConfiguredLogger> Critical() {
+        return Stream(LogLevel::Critical);
+    }
+
+    // Stream returns a stream logging to the logger of the
+    // configuration current when it goes out of scope
+    LogStream<ConfiguredLogger> Stream(LogLevel::level_t level) {
+        return LogStream<ConfiguredLogger>{*this, level};
+    }
+
+    bool Enabled(LogLevel::level_t level) {
+        return current()->Enabled(level);
+    }
+
+    void Flush() {
+        current()->Flush();
+    }
+
+    // current returns the calling thread's instance of the logger,
+    // which must not be used once the returned pin is gone
+    pin_t current() const;
+
+private:
+    void commit_stream(LogLevel::level_t msg_lvl, const std::string& msg) {
+        current()->commit_stream(msg_lvl, msg);
+    }
+
+    const Config *config_;
+    std::string name_;
+    uint64_t key_; // identifies the logger in the per-thread cache, see Config::key()
+}; // class ConfiguredLogger
+
+} // namespace slog
+
+#endif // __SLOG_CONFIG_H_
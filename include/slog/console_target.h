@@ -0,0 +1,192 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_CONSOLE_TARGET_H_
+#define __SLOG_CONSOLE_TARGET_H_
+
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <slog/target.h>
+#include <slog/utils.h>
+
+namespace slog {
+
+/**
+ * ConsoleOptions holds the options of a ConsoleTarget.
+ */
+struct ConsoleOptions {
+    enum color_t {
+        color_auto,   // color the records if the console is a terminal
+        color_always,
+        color_never
+    };
+
+    // Size of the internal buffer, the records are written out once
+    // it fills up.
+    size_t buffer_size{64 * 1024};
+
+    // Maximum time the records stay in the buffer, they are flushed
+    // from the FlushTimer thread. 0 keeps them until the buffer fills
+    // up or the target is flushed.
+    std::chrono::milliseconds flush_interval{100};
+
+    color_t color{color_auto};
+};
+
+/**
+ * ConsoleTarget writes the records straight to a console file
+ * descriptor, stdout by default, bypassing stdio. The records are
+ * collected in a large buffer and written out with a single write()
+ * once it fills up, on Flush(), or at the latest after
+ * ConsoleOptions::flush_interval.
+ *
+ * Records are colored by their level (ANSI escape codes) when the
+ * console is a terminal, the escape sequences of each level are
+ * rendered once at construction.
+ *
+ * Writes of other code to the same descriptor, e.g. printf(), are
+ * not ordered with the buffered records.
+ *
+ * ConsoleTarget is thread-safe when it is instantiated with
+ * a valid mutex(std::mutex).
+ */
+template <typename Mutex>
+class ConsoleTarget : public Target {
+public:
+    explicit ConsoleTarget(int fd = STDOUT_FILENO, LogLevel::level_t lvl = LogLevel::Debug,
+                           const ConsoleOptions& options = ConsoleOptions())
+        : Target(lvl), fd_(fd), options_(options), terminal_(::isatty(fd) == 1) {
+        colored_ = options.color == ConsoleOptions::color_always ||
+                   (options.color == ConsoleOptions::color_auto && terminal_);
+        if (colored_) {
+            static const char *const colors[LogLevel::Max] = {
+                "",            // None
+                "\033[1;31m",  // Critical: bold red
+                "\033[31m",    // Error: red
+                "\033[33m",    // Warning: yellow
+                "",            // Info: default
+                "\033[36m",    // Debug: cyan
+                "\033[90m"     // Trace: gray
+            };
+            for (int l = 0; l < LogLevel::Max; l++) {
+                color_[l] = colors[l];
+                reset_[l] = *colors[l] ? "\033[0m\n" : "\n";
+            }
+        } else {
+            for (int l = 0; l < LogLevel::Max; l++) {
+                reset_[l] = "\n";
+            }
+        }
+        buffer_.reserve(options_.buffer_size);
+        if (options_.flush_interval.count() > 0) {
+            FlushPolicy policy;
+            policy.interval = options_.flush_interval;
+            SetFlushPolicy(policy);
+        }
+    }
+
+    // Do not support copying/assigning objects
+    ConsoleTarget(const ConsoleTarget &) = delete;
+    ConsoleTarget &operator=(const ConsoleTarget &) = delete;
+
+    virtual ~ConsoleTarget() {
+        cancel_flush_timer();
+        std::lock_guard<Mutex> lock(mutex_);
+        write_out();
+    }
+
+    // IsTerminal tells if the console is a terminal
+    bool IsTerminal() const {
+        return terminal_;
+    }
+
+    // IsColored tells if the records are colored
+    bool IsColored() const {
+        return colored_;
+    }
+
+protected:
+    bool log(const std::string& frmt, va_list args) override {
+        std::lock_guard<Mutex> lock(mutex_);
+        size_t base = buffer_.size();
+        if (!utils::vappend(buffer_, frmt.c_str(), args)) {
+            return false;
+        }
+        if (buffer_.size() == base || buffer_.back() != '\n') {
+            buffer_ += '\n';
+        }
+        return buffer_.size() < options_.buffer_size || write_out();
+    }
+
+    bool write(LogLevel::level_t level, const char *msg, size_t len) override {
+        std::lock_guard<Mutex> lock(mutex_);
+        append_record(level, msg, len);
+        return buffer_.size() < options_.buffer_size || write_out();
+    }
+
+    bool write_batch(const RecordBatch& batch) override {
+        std::lock_guard<Mutex> lock(mutex_);
+        for (auto &e : batch.Entries()) {
+            if (!this->admits(e.level)) continue;
+            append_record(e.level, batch.Data() + e.offset, e.len);
+        }
+        return buffer_.size() < options_.buffer_size || write_out();
+    }
+
+    void flush() override {
+        std::lock_guard<Mutex> lock(mutex_);
+        write_out();
+    }
+
+private:
+    // append_record adds a record to the buffer, colored by its level.
+    // Must be called with the mutex held.
+    void append_record(LogLevel::level_t level, const char *msg, size_t len) {
+        if (level < LogLevel::None || level >= LogLevel::Max) level = LogLevel::None;
+        if (len && msg[len-1] == '\n') len--;
+        buffer_.append(color_[level]);
+        buffer_.append(msg, len);
+        buffer_.append(reset_[level]);
+    }
+
+    // write_out writes the buffered records to the console.
+    // Must be called with the mutex held.
+    bool write_out() {
+        const char *data = buffer_.data();
+        size_t left = buffer_.size();
+        while (left) {
+            ssize_t res = ::write(fd_, data, left);
+            if (res < 0) {
+                if (errno == EINTR) continue;
+                // the console is gone or not writable, drop the records
+                buffer_.clear();
+                return false;
+            }
+            data += res;
+            left -= res;
+        }
+        buffer_.clear();
+        return true;
+    }
+
+    Mutex mutex_;
+    int fd_;
+    ConsoleOptions options_;
+    bool terminal_;
+    bool colored_{false};
+    std::string color_[LogLevel::Max]; // escape sequence starting the records of a level
+    std::string reset_[LogLevel::Max]; // resets the color and ends the record
+    std::string buffer_;
+}; // class ConsoleTarget
+
+} // namespace slog
+
+#endif // __SLOG_CONSOLE_TARGET_H_
@@ -0,0 +1,31 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_CRC32C_H_
+#define __SLOG_CRC32C_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace slog {
+
+// crc32c extends the CRC32C (Castagnoli) checksum crc, 0 for the first
+// block, with the n bytes of data:
+//
+//    crc32c(crc32c(0, a, na), b, nb) == crc32c(0, ab, na + nb)
+//
+// The SSE4.2 crc32 instruction is used when the CPU supports it.
+uint32_t crc32c(uint32_t crc, const void *data, size_t n);
+
+// crc32c_software is the table driven implementation of crc32c(),
+// used on the CPUs without SSE4.2.
+uint32_t crc32c_software(uint32_t crc, const void *data, size_t n);
+
+} // namespace slog
+
+#endif // __SLOG_CRC32C_H_
@@ -9,12 +9,11 @@
 #ifndef __SLOG_DECORATORS_H_
 #define __SLOG_DECORATORS_H_
 
-#include <unistd.h> // ::get_pid()
 #include <string>  // std::string
-#include <thread>  // std::this_thread::get_pid()
 #include <sstream> // std::ostringstream
 #include <ctime>   // std::time()
 #include <iomanip> // std::put_time()
+#include <slog/thread_context.h>
 
 
 namespace slog {
@@ -32,7 +31,7 @@ public:
     PidDecorator() = default;
 
     std::string string() {
-        return "[" + std::to_string(static_cast<int>(::getpid())) + "]";
+        return "[" + std::to_string(static_cast<int>(ThreadContext::Current().Pid())) + "]";
     }
 };
 
@@ -41,9 +40,7 @@ public:
     ThreadidDecorator() = default;
 
     std::string string() {
-        std::ostringstream oss;
-        oss << "[" <<std::this_thread::get_id() << "]";
-        return oss.str();
+        return "[" + ThreadContext::Current().ThreadId() + "]";
     }
 };
 
@@ -0,0 +1,36 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_ESCAPE_H_
+#define __SLOG_ESCAPE_H_
+
+#include <cstddef>
+#include <string>
+
+namespace slog {
+
+// find_control returns the offset of the first control character in
+// the n bytes of data, n if there is none. The control characters are
+// the bytes below 0x20 but the tab, and DEL (0x7f).
+//
+// The data is scanned with AVX2 or SSE2 when the CPU supports it.
+size_t find_control(const char *data, size_t n);
+
+// find_control_software is the portable implementation of
+// find_control(), scanning 8 bytes at a time.
+size_t find_control_software(const char *data, size_t n);
+
+// escape_control appends the n bytes of data to out, with the control
+// characters escaped, so that the data stays on a single line and could
+// not carry terminal escape sequences: line feeds and carriage returns
+// as "\n" and "\r", the others as "\xHH", e.g. ESC as "\x1b".
+void escape_control(const char *data, size_t n, std::string& out);
+
+} // namespace slog
+
+#endif // __SLOG_ESCAPE_H_
@@ -0,0 +1,110 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_FILE_INDEX_H_
+#define __SLOG_FILE_INDEX_H_
+
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace slog {
+
+/**
+ * FileIndex is a sparse time index of a log file, stored next to it
+ * in "<log-file>.idx". It maps the wall clock time a record was
+ * written to the byte offset of that record in the log file, one
+ * entry roughly every FileOptions::index_interval bytes.
+ *
+ * The index file consists of an 8 byte magic followed by fixed size
+ * entries in host byte order.
+ */
+class FileIndex {
+public:
+    struct entry_t {
+        int64_t time;    // nanoseconds since the epoch
+        uint64_t offset; // offset of the record in the log file
+    };
+
+    // Path returns the index file path of the given log file.
+    static std::string Path(const std::string& log_file) {
+        return log_file + ".idx";
+    }
+
+    // Load reads the index file of the given log file.
+    // Returns false if the file does not exist or is not an index.
+    bool Load(const std::string& log_file);
+
+    const std::vector<entry_t>& Entries() const {
+        return entries_;
+    }
+
+    // Begin returns the offset from which all records written
+    // at or after the given time are found.
+    uint64_t Begin(int64_t time) const;
+
+    // End returns an offset up to which all the records written
+    // at or before the given time are found, or UINT64_MAX if they
+    // might extend to the end of the file.
+    uint64_t End(int64_t time) const;
+
+private:
+    std::vector<entry_t> entries_;
+}; // class FileIndex
+
+/**
+ * FileIndexWriter appends index entries for a log file while it is
+ * written. It is not thread-safe, the owning target serializes it.
+ */
+class FileIndexWriter {
+public:
+    FileIndexWriter() = default;
+    ~FileIndexWriter();
+
+    // Do not support copying/assigning objects
+    FileIndexWriter(const FileIndexWriter &) = delete;
+    FileIndexWriter &operator=(const FileIndexWriter &) = delete;
+
+    // Open opens (or creates) the index of the given log file, whose
+    // current size is offset. Throws a FileException on failure.
+    void Open(const std::string& log_file, uint64_t offset, size_t interval) noexcept(false);
+
+    bool IsOpen() const {
+        return fp_ != nullptr;
+    }
+
+    // Mark must be called before writing a record at the current
+    // offset, it adds an index entry for the record if one is due.
+    void Mark() {
+        if (offset_ >= next_) {
+            add_entry();
+        }
+    }
+
+    // Advance accounts len bytes written to the log file.
+    void Advance(size_t len) {
+        offset_ += len;
+    }
+
+    void Flush() {
+        if (fp_) ::fflush(fp_);
+    }
+
+private:
+    void add_entry();
+
+    FILE *fp_{nullptr};
+    size_t interval_{0};
+    uint64_t offset_{0}; // current size of the log file
+    uint64_t next_{0};   // offset after which the next entry is due
+}; // class FileIndexWriter
+
+} // namespace slog
+
+#endif // __SLOG_FILE_INDEX_H_
@@ -11,10 +11,25 @@
 
 #include <string>
 #include <mutex>
+#include <memory>
+#include <atomic>
+#include <condition_variable>
+#include <chrono>
+#include <thread>
+#include <cerrno>
 #include <stdio.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <vector>
 #include <slog/target.h>
 #include <slog/utils.h>
 #include <slog/file_exception.h>
+#include <slog/file_index.h>
+#include <slog/compression.h>
+#include <slog/frame.h>
+#include <slog/spill_buffer.h>
+#include <slog/escape.h>
+#include <slog/probes.h>
 
 using namespace std;
 
@@ -22,6 +37,53 @@ namespace slog {
 
 class FileException;
 
+/**
+ * FileOptions holds the optional features of a FileTarget.
+ */
+struct FileOptions {
+    // Write a sparse time index of the log file to "<file>.idx", with
+    // an entry roughly every index_interval bytes. 0 disables the index.
+    size_t index_interval{0};
+
+    // Write the log file as a sequence of compressed frames of about
+    // compress_block bytes of records each (see lz::EncodeFrame), which
+    // are compressed on a background thread. 0 disables compression.
+    // The index is not written for compressed files.
+    size_t compress_block{0};
+
+    // Write every record as a frame with a sequence number and a CRC32C
+    // checksum (see frame.h), so that torn and damaged records could be
+    // detected. The damaged tail left by a crash is truncated when the
+    // file is opened, and the sequence numbers continue from the last
+    // valid record. Framed files are neither indexed nor compressed.
+    bool framed{false};
+
+    // Memory resource of the buffers of the target: the stdio buffer of
+    // the file, the compressed blocks and the multi-part records, see
+    // MemoryAccount. If the stdio buffer could not be allocated the file
+    // is written unbuffered; records that do not fit into the budget of
+    // the compressed blocks are dropped.
+    std::shared_ptr<MemoryResource> memory;
+
+    // Divert the records to an in-memory spill buffer of up to spill
+    // bytes while the file could not be written, e.g. the disk is full,
+    // or while a write holds the file for longer than spill_timeout,
+    // e.g. on a stalled NFS server, instead of losing them or waiting.
+    // A background thread replays them in order once the file could be
+    // written again, retrying with a backoff from spill_retry up to a
+    // second. The records that do not fit are dropped (see Spill()).
+    // 0 disables the spill buffer.
+    size_t spill{0};
+    std::chrono::milliseconds spill_timeout{50};
+    std::chrono::milliseconds spill_retry{10};
+
+    // Keep every record on a single line: the line feeds, carriage
+    // returns and other control characters of the records, e.g. the
+    // ANSI escape sequences of user input, are escaped (see
+    // escape_control()). The records without any are written as is.
+    bool escape{false};
+};
+
 /**
  * FileTargetGeneric file target used for logging to a regular file.
  * It does not accept symlinks as a log target.
@@ -30,16 +92,33 @@ class FileException;
  * 
  * FileTarget is thread-safe when it is instantiated with
  * a valid mutex(std::mutex).
+ *
+ * Records are numbered in the order they are written, see Sequence().
+ * SyncTo() makes them durable with fdatasync(), concurrent callers
+ * share a single fdatasync() call (group commit).
+ *
+ * Records of DirectWriteSize or more bytes made of several parts, like
+ * large payloads, are written with writev() straight from the caller's
+ * memory instead of being copied into the stdio buffer.
  */
 template <typename Mutex>
 class FileTarget : public Target {
 public:
+    // Minimum size of the multi-part records written with writev()
+    static const size_t DirectWriteSize = 4096;
+
     explicit FileTarget(const string& file_name, LogLevel::level_t lvl = LogLevel::Debug) noexcept(false)
         : Target(lvl), file_name_(file_name) {
 
         prepare_log_file();
     }
 
+    FileTarget(const string& file_name, LogLevel::level_t lvl, const FileOptions& options) noexcept(false)
+        : Target(lvl), file_name_(file_name), options_(options) {
+
+        prepare_log_file();
+    }
+
     // Intended for creating console file targets
     explicit FileTarget(FILE *fp, bool is_console = true)
         : fp_(fp), console_(is_console) {}
@@ -51,8 +130,24 @@ public:
     FileTarget &operator=(FileTarget &&) = delete;
 
     bool log(const std::string& frmt, va_list args) override{
-        lock_guard<Mutex> lock(mutex_);
+        if (spill_) {
+            static thread_local string rendered;
+            if (!utils::vformat(rendered, frmt.c_str(), args)) {
+                return false;
+            }
+            return write(LogLevel::None, rendered.data(), rendered.size());
+        }
+        auto lock = acquire();
         if (!fp_) return false;
+        if (compressor_ || options_.framed || options_.escape) {
+            if (!utils::vformat(buffer_, frmt.c_str(), args)) {
+                return false;
+            }
+            return write_record(LogLevel::None, buffer_.data(), buffer_.size());
+        }
+        if (index_.IsOpen()) {
+            index_.Mark();
+        }
         auto res = vfprintf(fp_, frmt.c_str(), args);
         if (res < 0) {
             return false;
@@ -61,30 +156,400 @@ public:
         // NOTE(avalluri): make it configurable?
         if (frmt.empty() || frmt[frmt.size()-1] != '\n') {
             fwrite("\n", 1, 1, fp_);
+            res++;
+        }
+        if (index_.IsOpen()) {
+            index_.Advance(res);
+        }
+        written_.fetch_add(1, memory_order_release);
+        return true;
+    }
+
+    bool write(LogLevel::level_t level, const char *msg, size_t len) override {
+        if (spill_) {
+            auto lock = spill_lock();
+            return spill_record(lock, level, msg, len);
+        }
+        auto lock = acquire();
+        return write_record(level, msg, len);
+    }
+
+    bool write_iov(LogLevel::level_t level, const struct iovec *iov, int iovcnt) override {
+        if (spill_) {
+            // the parts are joined, to be spilled as one record
+            return Target::write_iov(level, iov, iovcnt);
+        }
+        size_t len = 0;
+        for (int i = 0; i < iovcnt; i++) {
+            len += iov[i].iov_len;
         }
+        auto lock = acquire();
+        if (!fp_) return false;
+        if (compressor_ || options_.escape) {
+            buffer_.clear();
+            for (int i = 0; i < iovcnt; i++) {
+                buffer_.append(static_cast<const char *>(iov[i].iov_base), iov[i].iov_len);
+            }
+            return write_record(level, buffer_.data(), buffer_.size());
+        }
+        if (index_.IsOpen()) {
+            index_.Mark();
+        }
+        bool newline = true;
+        for (int i = iovcnt - 1; i >= 0; i--) {
+            if (iov[i].iov_len) {
+                newline = static_cast<const char *>(iov[i].iov_base)[iov[i].iov_len-1] != '\n';
+                break;
+            }
+        }
+        char header[FrameHeaderSize];
+        if (options_.framed) {
+            if (!assign_iov(iov, iovcnt, newline, nullptr)) {
+                return false;
+            }
+            encode_frame_header(header, next_sequence(), level, iov_.data(), static_cast<int>(iov_.size()));
+        }
+        if (len < DirectWriteSize) {
+            // small records are cheaper to copy into the stdio buffer
+            if (options_.framed && fwrite(header, 1, sizeof(header), fp_) != sizeof(header)) {
+                return false;
+            }
+            for (int i = 0; i < iovcnt; i++) {
+                if (fwrite(iov[i].iov_base, 1, iov[i].iov_len, fp_) != iov[i].iov_len) {
+                    return false;
+                }
+            }
+            if (newline) fwrite("\n", 1, 1, fp_);
+        } else {
+            // write out the buffered records first to keep the order
+            if (::fflush(fp_) != 0) {
+                return false;
+            }
+            if (!assign_iov(iov, iovcnt, newline, options_.framed ? header : nullptr)) {
+                return false;
+            }
+            if (!utils::writev_all(fileno(fp_), iov_.data(), static_cast<int>(iov_.size()))) {
+                return false;
+            }
+        }
+        if (newline) len++;
+        if (index_.IsOpen()) {
+            index_.Advance(len);
+        }
+        written_.fetch_add(1, memory_order_release);
         return true;
     }
 
+    // write_batch writes the records under a single lock, so that
+    // they are not interleaved with the records of other threads.
+    bool write_batch(const RecordBatch& batch) override {
+        auto lock = spill_ ? spill_lock() : acquire();
+        bool res = true;
+        for (auto &e : batch.Entries()) {
+            if (!this->admits(e.level)) continue;
+            if (spill_) {
+                res = spill_record(lock, e.level, batch.Data() + e.offset, e.len) && res;
+            } else {
+                res = write_record(e.level, batch.Data() + e.offset, e.len) && res;
+            }
+        }
+        return res;
+    }
+
     void flush() override {
-        lock_guard<Mutex> lock(mutex_);
-        if (!fp_) return;
-       ::fflush(fp_);
+        // with a spill buffer, do not wait for a stalled file, the
+        // failures are left to the next writes
+        auto lock = spill_ ? spill_lock() : acquire();
+        if (!lock.owns_lock() || !fp_) return;
+        if (compressor_) {
+            compressor_->Flush();
+            return;
+        }
+        if (::fflush(fp_) != 0 && spill_) clearerr(fp_);
+        index_.Flush();
+    }
+
+    bool sync() override {
+        return SyncTo(Sequence());
+    }
+
+    // Sequence returns the number of records written so far, which is
+    // also the sequence number of the last written record.
+    uint64_t Sequence() const {
+        return written_.load(memory_order_acquire);
+    }
+
+    // SyncTo waits until all the records up to the given sequence number
+    // are durable. Concurrent callers are served by a single fdatasync(),
+    // the first caller syncs on behalf of all the waiting ones.
+    // Returns false if the file could not be synced, or, with a spill
+    // buffer, if it is stalled or records are being spilled.
+    bool SyncTo(uint64_t seq) {
+        unique_lock<mutex> lock(sync_mtx_);
+        for (;;) {
+            if (durable_ >= seq) return true;
+            if (!syncing_) break;
+            sync_cv_.wait(lock);
+        }
+        syncing_ = true;
+        lock.unlock();
+
+        bool ok = true;
+        uint64_t upto;
+        int fd = -1;
+        {
+            auto l = spill_ ? spill_lock() : acquire();
+            upto = Sequence();
+            if (!l.owns_lock()) {
+                ok = false;
+            } else if (fp_) {
+                if (compressor_) {
+                    compressor_->Flush();
+                } else {
+                    ok = ::fflush(fp_) == 0;
+                    index_.Flush();
+                }
+                fd = fileno(fp_);
+            }
+        }
+        // consoles and pipes could not be synced, flushing them is all we can do
+        if (ok && fd >= 0 && fdatasync(fd) != 0 && errno != EINVAL && errno != EROFS) {
+            ok = false;
+        }
+
+        lock.lock();
+        syncing_ = false;
+        if (ok && upto > durable_) durable_ = upto;
+        sync_cv_.notify_all();
+        return ok && durable_ >= seq;
+    }
+
+    // Memory returns the memory resource of the target buffers,
+    // nullptr for the default one.
+    const std::shared_ptr<MemoryResource>& Memory() const override {
+        return options_.memory;
+    }
+
+    // Spill returns the spill buffer of the target, nullptr if
+    // FileOptions::spill is not set.
+    const SpillBuffer *Spill() const {
+        return spill_.get();
     }
 
     virtual ~FileTarget() {
+        cancel_flush_timer();
+        if (spill_) {
+            // a last chance for the spilled records
+            spill_->Stop();
+            replay_spill();
+            spill_.reset();
+        }
+        // write out the pending blocks before closing the file
+        compressor_.reset();
         if (fp_ != nullptr && ! console_) {
             fclose(fp_);
             fp_ = nullptr;
         }
+        if (stdio_buffer_) {
+            options_.memory->Deallocate(stdio_buffer_, BUFSIZ);
+        }
     }
 
 protected:
+    // file_lock holds the target lock, and fires the lock_release
+    // probe before releasing it
+    class file_lock: public unique_lock<Mutex> {
+    public:
+        file_lock(unique_lock<Mutex>&& lock, const char *name)
+            : unique_lock<Mutex>(std::move(lock)), name_(name) {}
+        file_lock(file_lock&&) = default;
+        ~file_lock() {
+            if (this->owns_lock()) {
+                SLOG_PROBE1(lock_release, name_);
+            }
+        }
+    private:
+        const char *name_;
+    };
+
+    // acquire takes the target lock, reporting the time spent
+    // waiting for it to the governor
+    file_lock acquire() {
+        SLOG_PROBE1(lock_acquire, file_name_.c_str());
+        Governor *g = this->governor();
+        auto start = g ? chrono::steady_clock::now() : chrono::steady_clock::time_point();
+        unique_lock<Mutex> lock(mutex_);
+        if (g) {
+            g->RecordLockWait(chrono::duration_cast<chrono::nanoseconds>(
+                chrono::steady_clock::now() - start).count());
+        }
+        SLOG_PROBE1(lock_acquired, file_name_.c_str());
+        return file_lock(std::move(lock), file_name_.c_str());
+    }
+
     Mutex mutex_;
     string file_name_;
     FILE*  fp_{nullptr};
     bool   console_{false}; // track if the file is a console or not
+    FileOptions options_;
+    FileIndexWriter index_;
+    unique_ptr<BlockWriter> compressor_;
+    string buffer_; // rendering buffer of the records not written with stdio directly
+    string escaped_; // the record being written, escaped
+    vector<struct iovec, Allocator<struct iovec> > iov_{Allocator<struct iovec>(options_.memory.get())}; // parts of the record written with writev()
+    char *stdio_buffer_{nullptr}; // allocated from options_.memory
+
+    unique_ptr<SpillBuffer> spill_;
+
+    atomic<uint64_t> written_{0}; // number of records written
+    uint64_t base_seq_{0};        // frame sequence number of the last record found in the file
+    mutex sync_mtx_;              // protects the group commit state below
+    condition_variable sync_cv_;
+    bool syncing_{false};         // a caller is running fdatasync()
+    uint64_t durable_{0};         // records known to be durable
 
 private:
+    // spill_lock takes the target lock, unless records are being spilled,
+    // or the lock could not be taken within the spill timeout. The records
+    // written without the lock are spilled.
+    file_lock spill_lock() {
+        if (spill_->Active()) {
+            return file_lock(unique_lock<Mutex>(mutex_, defer_lock), file_name_.c_str());
+        }
+        SLOG_PROBE1(lock_acquire, file_name_.c_str());
+        if (!try_lock_for(mutex_, options_.spill_timeout, 0)) {
+            return file_lock(unique_lock<Mutex>(mutex_, defer_lock), file_name_.c_str());
+        }
+        SLOG_PROBE1(lock_acquired, file_name_.c_str());
+        return file_lock(unique_lock<Mutex>(mutex_, adopt_lock), file_name_.c_str());
+    }
+
+    // spill_record writes the record if the lock is held and nothing is
+    // spilled, else, or if the write fails, adds it to the spill buffer.
+    bool spill_record(unique_lock<Mutex>& lock, LogLevel::level_t level, const char *msg, size_t len) {
+        if (lock.owns_lock() && !spill_->Active()) {
+            if (write_record(level, msg, len)) {
+                return true;
+            }
+            if (fp_) clearerr(fp_);
+        }
+        return spill_->Add(level, msg, len);
+    }
+
+    // replay_spill writes out the spilled records, called by the retry
+    // thread of the spill buffer. Returns false if the file could still
+    // not be written.
+    bool replay_spill() {
+        lock_guard<Mutex> lock(mutex_);
+        if (!fp_) return false;
+        // the records buffered before the failure go first
+        if (::fflush(fp_) != 0) {
+            clearerr(fp_);
+            return false;
+        }
+        bool ok = spill_->Drain([this](LogLevel::level_t level, const char *msg, size_t len) {
+            return write_record(level, msg, len);
+        });
+        if (!ok || ::fflush(fp_) != 0) {
+            clearerr(fp_);
+            return false;
+        }
+        return true;
+    }
+
+    // try_lock_for takes the lock within the timeout. Mutexes without
+    // try_lock() are waited for.
+    template<typename M>
+    static auto try_lock_for(M& m, chrono::milliseconds timeout, int) -> decltype(m.try_lock()) {
+        auto deadline = chrono::steady_clock::now() + timeout;
+        for (int i = 0; !m.try_lock(); i++) {
+            if (i < 64) {
+                this_thread::yield();
+            } else if (chrono::steady_clock::now() >= deadline) {
+                return false;
+            } else {
+                this_thread::sleep_for(chrono::microseconds(20));
+            }
+        }
+        return true;
+    }
+
+    template<typename M>
+    static bool try_lock_for(M& m, chrono::milliseconds, long) {
+        m.lock();
+        return true;
+    }
+
+    // next_sequence returns the frame sequence number of the record
+    // being written, must be called with the mutex held.
+    uint64_t next_sequence() const {
+        return base_seq_ + written_.load(memory_order_relaxed) + 1;
+    }
+
+    // assign_iov copies the record parts into iov_, preceded by the frame
+    // header if any, and followed by a line feed if needed. Returns false
+    // if the memory resource refused to grow iov_.
+    bool assign_iov(const struct iovec *iov, int iovcnt, bool newline, char *header) {
+        try {
+            iov_.assign(iov, iov + iovcnt);
+            if (newline) iov_.push_back(iovec{const_cast<char *>("\n"), 1});
+            if (header) iov_.insert(iov_.begin(), iovec{header, FrameHeaderSize});
+        } catch (const std::bad_alloc&) {
+            return false;
+        }
+        return true;
+    }
+
+    // write_record writes a rendered record, must be called
+    // with the mutex held.
+    bool write_record(LogLevel::level_t level, const char *msg, size_t len) {
+        if (!fp_) return false;
+        if (options_.escape) {
+            // the line feed ending the record is not escaped
+            size_t body = len && msg[len-1] == '\n' ? len - 1 : len;
+            if (find_control(msg, body) < body) {
+                escaped_.clear();
+                escape_control(msg, body, escaped_);
+                msg = escaped_.data();
+                len = escaped_.size();
+            }
+        }
+        if (compressor_) {
+            if (!compressor_->Append(msg, len)) {
+                return false;
+            }
+            written_.fetch_add(1, memory_order_release);
+            return true;
+        }
+        if (options_.framed) {
+            bool newline = len == 0 || msg[len-1] != '\n';
+            struct iovec parts[2] = {{const_cast<char *>(msg), len}, {const_cast<char *>("\n"), newline ? 1u : 0u}};
+            char header[FrameHeaderSize];
+            encode_frame_header(header, next_sequence(), level, parts, 2);
+            if (fwrite(header, 1, sizeof(header), fp_) != sizeof(header) || fwrite(msg, 1, len, fp_) != len ||
+                (newline && fwrite("\n", 1, 1, fp_) != 1)) {
+                return false;
+            }
+            written_.fetch_add(1, memory_order_release);
+            return true;
+        }
+        if (index_.IsOpen()) {
+            index_.Mark();
+        }
+        if (fwrite(msg, 1, len, fp_) != len) {
+            return false;
+        }
+        if (len == 0 || msg[len-1] != '\n') {
+            fwrite("\n", 1, 1, fp_);
+            len++;
+        }
+        if (index_.IsOpen()) {
+            index_.Advance(len);
+        }
+        written_.fetch_add(1, memory_order_release);
+        return true;
+    }
+
     void prepare_log_file() {
         if (utils::is_symlink(file_name_)) {
             throw FileException{file_name_, "Log file cannot be a symbolic link", true};
@@ -92,10 +557,36 @@ private:
         if (!utils::ensure_directory_path(utils::dirname(file_name_))) {
             throw FileException{file_name_, "Failed to create log directory"};
         }
+        if (options_.framed) {
+            if (options_.compress_block) {
+                throw FileException{file_name_, "Framed log files could not be compressed"};
+            }
+            // cut off the records torn by a crash, so that the new
+            // records follow the last valid one
+            base_seq_ = recover_frames(file_name_, true).last_seq;
+        }
         fp_ = fopen(file_name_.c_str(), "ab");
         if (!fp_) {
             throw FileException{file_name_, "Failed to open log file"};
         }
+        if (options_.memory) {
+            try {
+                stdio_buffer_ = static_cast<char *>(options_.memory->Allocate(BUFSIZ));
+                setvbuf(fp_, stdio_buffer_, _IOFBF, BUFSIZ);
+            } catch (const std::bad_alloc&) {
+                setvbuf(fp_, nullptr, _IONBF, 0);
+            }
+        }
+        if (options_.spill) {
+            spill_.reset(new SpillBuffer(options_.spill, [this]() { return replay_spill(); },
+                options_.spill_retry, chrono::milliseconds(1000), options_.memory.get()));
+        }
+        if (options_.compress_block) {
+            compressor_.reset(new BlockWriter(fp_, options_.compress_block, options_.memory.get()));
+        } else if (options_.index_interval && !options_.framed) {
+            fseek(fp_, 0, SEEK_END);
+            index_.Open(file_name_, ftell(fp_), options_.index_interval);
+        }
     }
 }; // class FileTarget
 
@@ -0,0 +1,70 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_FLUSH_TIMER_H_
+#define __SLOG_FLUSH_TIMER_H_
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+namespace slog {
+
+class Target;
+
+/**
+ * FlushTimer is a single background thread shared by all the targets
+ * with a periodic flush policy (see FlushPolicy::interval). It is
+ * started on the first registration, and stopped with Stop().
+ * The targets are flushed without holding the timer lock, a stalled
+ * disk does not block the registrations of the other targets.
+ */
+class FlushTimer {
+public:
+    // Instance returns the process wide flush timer.
+    static FlushTimer& Instance();
+
+    // Register schedules the target to be flushed every interval.
+    // Registering a target again updates its interval.
+    void Register(Target *target, std::chrono::milliseconds interval);
+
+    // Unregister cancels flushing the target. Once it returns the
+    // target is guaranteed not to be flushed by the timer anymore,
+    // it waits for an ongoing flush of the target.
+    void Unregister(Target *target);
+
+    // Stop stops and joins the timer thread, e.g. before the process
+    // exits. A later registration starts it again.
+    void Stop();
+
+private:
+    FlushTimer() = default;
+    void run(uint64_t generation);
+
+    struct entry_t {
+        Target *target;
+        std::chrono::milliseconds interval;
+        std::chrono::steady_clock::time_point due;
+    };
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::condition_variable flushed_cv_; // signals the end of a flush
+    Target *flushing_{nullptr};          // the target being flushed
+    std::vector<entry_t> entries_;
+    bool started_{false};
+    uint64_t generation_{0}; // incremented by Stop(), ends the thread
+    std::thread thread_;
+}; // class FlushTimer
+
+} // namespace slog
+
+#endif // __SLOG_FLUSH_TIMER_H_
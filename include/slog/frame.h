@@ -0,0 +1,129 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_FRAME_H_
+#define __SLOG_FRAME_H_
+
+#include <sys/uio.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <slog/log_level.h>
+
+namespace slog {
+
+/**
+ * The framed log format (see FileOptions::framed) prefixes every record
+ * with a header, which allows to detect the torn and damaged records:
+ *
+ *    offset size
+ *         0    4  magic "SLF1"
+ *         4    4  payload length
+ *         8    8  sequence number
+ *        16    1  log level
+ *        17    3  reserved, zero
+ *        20    4  CRC32C of the bytes 4 to 19 and the payload
+ *
+ * All the numbers are little endian. The payload is the rendered
+ * record, terminated with a line feed.
+ */
+const size_t FrameHeaderSize = 24;
+
+// Magic of the frame headers, the first 4 bytes of a framed log file
+const char FrameMagic[4] = {'S', 'L', 'F', '1'};
+
+// Frames larger than this are treated as damaged
+const uint32_t MaxFrameSize = 64 * 1024 * 1024;
+
+// encode_frame_header writes the header of the frame made of the given
+// payload parts into out, which must hold FrameHeaderSize bytes.
+void encode_frame_header(char *out, uint64_t seq, LogLevel::level_t level,
+                         const struct iovec *parts, int nparts);
+
+/**
+ * FrameRecovery is the result of recover_frames()
+ */
+struct FrameRecovery {
+    uint64_t size{0};      // size of the file as found
+    uint64_t valid_end{0}; // end of the last valid frame
+    uint64_t last_seq{0};  // sequence number of the last valid frame, 0 if none
+};
+
+// recover_frames finds the last valid frame of a framed log file,
+// scanning backwards from the end, so that only the damaged tail is
+// read. With truncate the damaged tail is cut off, so that the
+// records appended next follow the last valid frame.
+// Throws FileException if the file could not be read, or is not empty
+// and does not start with a frame.
+FrameRecovery recover_frames(const std::string& path, bool truncate) noexcept(false);
+
+/**
+ * Frame is a record read by FrameReader
+ */
+struct Frame {
+    uint64_t offset;         // offset of the frame in the file
+    uint64_t seq;
+    LogLevel::level_t level;
+    const char *data;        // payload, valid until the next read
+    size_t len;
+};
+
+/**
+ * FrameReader reads the records of a framed log file in order. The
+ * damaged regions are skipped, reading resumes at the next frame with
+ * a valid checksum.
+ *
+ * A frame not yet completely written at the end of the file is not
+ * treated as damaged: Next() stops before it, and returns it once
+ * it is complete, so that a growing file could be followed.
+ */
+class FrameReader {
+public:
+    // FrameReader opens the file, reading from the given offset.
+    // Throws FileException if the file could not be opened.
+    explicit FrameReader(const std::string& path, uint64_t offset = 0) noexcept(false);
+
+    // FrameReader reads the already opened file, it takes over the
+    // file descriptor.
+    FrameReader(int fd, uint64_t offset);
+    ~FrameReader();
+
+    // Do not support copying/assigning objects
+    FrameReader(const FrameReader &) = delete;
+    FrameReader &operator=(const FrameReader &) = delete;
+
+    // Next reads the next valid frame. Returns false at the end of
+    // the file.
+    bool Next(Frame& frame);
+
+    // Offset returns the offset of the file up to which it has been
+    // read, to resume reading later
+    uint64_t Offset() const {
+        return offset_;
+    }
+
+    // Skipped returns the number of damaged bytes skipped so far
+    uint64_t Skipped() const {
+        return skipped_;
+    }
+
+private:
+    bool fill(size_t n);
+
+    int fd_{-1};
+    std::vector<char> buf_;
+    size_t begin_{0};     // unread data of buf_
+    size_t end_{0};
+    uint64_t offset_{0};  // file offset of buf_[begin_]
+    uint64_t skipped_{0};
+}; // class FrameReader
+
+} // namespace slog
+
+#endif // __SLOG_FRAME_H_
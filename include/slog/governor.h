@@ -0,0 +1,150 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_GOVERNOR_H_
+#define __SLOG_GOVERNOR_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <slog/log_level.h>
+
+namespace slog {
+
+/**
+ * GovernorOptions configures when a Governor considers its target
+ * saturated, and when recovered.
+ */
+struct GovernorOptions {
+    // average write latency, waiting for the target lock included,
+    // that marks the target as saturated
+    std::chrono::microseconds latency{2000};
+
+    // average time waiting for the target lock that marks the target
+    // as saturated, for targets which report it (FileTarget)
+    std::chrono::microseconds lock_wait{1000};
+
+    // period over which the samples are averaged, one shed level is
+    // added or restored at most once per period
+    std::chrono::milliseconds interval{100};
+
+    // time the target must stay healthy, below half of both the
+    // thresholds, before each shed level is restored
+    std::chrono::milliseconds recovery{1000};
+
+    // the most severe level that may be shed
+    LogLevel::level_t floor{LogLevel::Debug};
+};
+
+/**
+ * Governor sheds the least severe records of a target while writing to
+ * it is slow, e.g. because the disk is saturated (see Target::SetGovernor):
+ *
+ *    auto file = std::make_shared<FileTarget<std::mutex>>("logs/app.log", LogLevel::Trace);
+ *    file->SetGovernor(std::make_shared<Governor>());
+ *
+ * The target reports the latency of every write, and the time spent
+ * waiting for its lock. When the average of an interval crosses one of
+ * the thresholds the governor stops admitting the least severe admitted
+ * level, starting from the level of the target, down to
+ * GovernorOptions::floor. Once the averages stayed below half of the
+ * thresholds for the recovery time, the levels are restored one by one.
+ *
+ * The records that are not admitted are counted. The target writes a
+ * warning record when the shedding starts, and a summary of the shed
+ * records when the configured level is restored.
+ */
+class Governor {
+public:
+    explicit Governor(const GovernorOptions& options = GovernorOptions{});
+
+    // Do not support copying/assigning objects
+    Governor(const Governor &) = delete;
+    Governor &operator=(const Governor &) = delete;
+
+    // Admits returns if the records of the given level are written
+    bool Admits(LogLevel::level_t level) const {
+        return level <= admitted_.load(std::memory_order_relaxed);
+    }
+
+    // Threshold returns the least severe level admitted
+    LogLevel::level_t Threshold() const {
+        return admitted_.load(std::memory_order_relaxed);
+    }
+
+    // SetLevel sets the level of the governed target, the least severe
+    // level admitted while the target is healthy. It is set by
+    // Target::SetGovernor() and Target::SetLogLevel().
+    void SetLevel(LogLevel::level_t level);
+
+    // Record adds the latency of a write, in nanoseconds
+    void Record(int64_t latency_ns);
+
+    // RecordLockWait adds the time a write waited for the target lock,
+    // in nanoseconds. It is reported before the Record() of that write.
+    void RecordLockWait(int64_t wait_ns) {
+        lock_wait_ns_.fetch_add(wait_ns, std::memory_order_relaxed);
+    }
+
+    // Shed counts a record that was not admitted
+    void Shed(LogLevel::level_t level);
+
+    // ShedCount returns the number of records of the level shed so far
+    uint64_t ShedCount(LogLevel::level_t level) const {
+        return level > LogLevel::None && level < LogLevel::Max ?
+            shed_[level].load(std::memory_order_relaxed) : 0;
+    }
+
+    // Episodes returns the number of times the shedding started
+    uint64_t Episodes() const {
+        return episodes_.load(std::memory_order_relaxed);
+    }
+
+    // ReportPending returns if there is a record to write about the
+    // state of the governor, taken with TakeReport().
+    bool ReportPending() const {
+        return report_pending_.load(std::memory_order_relaxed);
+    }
+
+    // TakeReport moves the pending record to report, returns false
+    // if there is none.
+    bool TakeReport(std::string& report);
+
+    const GovernorOptions& Options() const {
+        return options_;
+    }
+
+private:
+    void evaluate(int64_t now);
+    void report(const std::string& text);
+
+    const GovernorOptions options_;
+    std::atomic<LogLevel::level_t> admitted_{LogLevel::Trace};
+    LogLevel::level_t level_{LogLevel::Trace}; // of the target, guarded by mutex_
+    std::atomic<int64_t> next_evaluation_{0};  // steady clock, nanoseconds
+    std::atomic<int64_t> latency_ns_{0};       // sums of the current period
+    std::atomic<int64_t> lock_wait_ns_{0};
+    std::atomic<uint64_t> samples_{0};
+    std::atomic<uint64_t> shed_[LogLevel::Max];
+    std::atomic<uint64_t> episodes_{0};
+    std::atomic<bool> report_pending_{false};
+
+    // evaluation state, guarded by mutex_
+    std::mutex mutex_;
+    int64_t healthy_since_{0};  // 0 while not healthy
+    int64_t episode_start_{0};  // 0 while not shedding
+    int64_t peak_latency_ns_{0};
+    uint64_t shed_before_[LogLevel::Max];
+    std::string report_;
+}; // class Governor
+
+} // namespace slog
+
+#endif // __SLOG_GOVERNOR_H_
@@ -0,0 +1,158 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_LOG_READER_H_
+#define __SLOG_LOG_READER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <slog/frame.h>
+#include <slog/record_format.h>
+
+namespace slog {
+
+/**
+ * LogRecord is a record read by LogReader. It is a view over the
+ * reader buffer, valid until the next call of the reader.
+ */
+struct LogRecord {
+    uint64_t offset{0};    // offset of the record in the file
+    const char *data{nullptr}; // the whole record, without its last line feed
+    size_t len{0};
+    RecordFields fields;   // text records: the parsed fields, level Unknown if
+                           // the record is not in the record layout.
+                           // framed records: the level and the message.
+    uint64_t seq{0};       // framed records: the sequence number
+};
+
+/**
+ * ReaderCheckpoint identifies the position of a LogReader in the log
+ * file, to resume reading after a restart.
+ */
+struct ReaderCheckpoint {
+    uint64_t inode{0};
+    uint64_t offset{0};
+
+    // Load reads the checkpoint saved in the file, returns false if
+    // there is none.
+    bool Load(const std::string& path);
+
+    // Save writes the checkpoint to the file, atomically replacing it.
+    // Returns false on failure.
+    bool Save(const std::string& path) const;
+};
+
+/**
+ * LogReader follows a log file written by FileTarget, plain text or
+ * framed (FileOptions::framed, detected from the file contents), and
+ * reads it record by record:
+ *
+ *    LogReader reader{"logs/app.log", checkpoint};
+ *    for (;;) {
+ *        LogRecord r;
+ *        while (reader.Next(r)) {
+ *            ship(r.data, r.len);
+ *        }
+ *        reader.Checkpoint().Save("app.checkpoint");
+ *        reader.Wait(1000);
+ *    }
+ *
+ * Text records are parsed with RecordParser, the lines that are not in
+ * the record layout continue the previous record. A record is returned
+ * only once it is complete: its last line ended, and either the next
+ * record has started or the data written so far ends there.
+ *
+ * The file is read in chunks into a buffer which the records point to.
+ * Wait() blocks on inotify events of the log directory. When the file
+ * is rotated (renamed or replaced) the rest of the old file is read
+ * before switching to the new one. A file truncated below the read
+ * offset, e.g. by copytruncate, is read again from its beginning.
+ *
+ * LogReader is not thread-safe.
+ */
+class LogReader {
+public:
+    // LogReader opens the log file, resuming from the checkpoint if it
+    // refers to the same file, else from its beginning. The file may
+    // not exist yet. Throws FileException if it could not be read.
+    explicit LogReader(const std::string& path, const ReaderCheckpoint& checkpoint = ReaderCheckpoint{}) noexcept(false);
+    ~LogReader();
+
+    // Do not support copying/assigning objects
+    LogReader(const LogReader &) = delete;
+    LogReader &operator=(const LogReader &) = delete;
+
+    // Next reads the next complete record. Returns false if there is
+    // none yet.
+    bool Next(LogRecord& record) noexcept(false);
+
+    // Wait waits until the log file changes, at most timeout_ms
+    // milliseconds (-1 for ever). Returns false on timeout, or if only
+    // other files of the directory changed. The writes to a file renamed
+    // by a rotation are not noticed, use a timeout to catch up with them.
+    bool Wait(int timeout_ms);
+
+    // Checkpoint returns the position of the next record to read
+    ReaderCheckpoint Checkpoint() const;
+
+    // Rotations returns the number of times the reader switched to a
+    // new file, and Truncations the number of times the file was
+    // truncated under the reader.
+    uint64_t Rotations() const {
+        return rotations_;
+    }
+
+    uint64_t Truncations() const {
+        return truncations_;
+    }
+
+    // Skipped returns the number of damaged or incomplete bytes skipped
+    uint64_t Skipped() const {
+        return skipped_ + (frames_ ? frames_->Skipped() : 0);
+    }
+
+private:
+    enum format_t {
+        format_unknown, // the file is empty
+        format_text,
+        format_framed
+    };
+
+    bool open() noexcept(false);
+    void close();
+    bool detect();
+    bool read_text(LogRecord& record);
+    bool fill(size_t n);
+    bool line_end(size_t from, size_t& end);
+    bool reopen() noexcept(false);
+
+    std::string path_;
+    std::string dir_;
+    std::string base_;
+    int inotify_fd_{-1};
+    ReaderCheckpoint checkpoint_;         // where to resume in the first file
+    int fd_{-1};
+    uint64_t inode_{0};
+    format_t format_{format_unknown};
+    std::unique_ptr<FrameReader> frames_; // reads the framed files
+    std::vector<char> buf_;               // reads the text files
+    size_t begin_{0};                     // unread data of buf_
+    size_t end_{0};
+    uint64_t offset_{0};                  // file offset of buf_[begin_]
+    RecordParser parser_;
+    uint64_t rotations_{0};
+    uint64_t truncations_{0};
+    uint64_t skipped_{0};
+}; // class LogReader
+
+} // namespace slog
+
+#endif // __SLOG_LOG_READER_H_
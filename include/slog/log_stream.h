@@ -0,0 +1,148 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_LOG_STREAM_H_
+#define __SLOG_LOG_STREAM_H_
+
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <slog/log_level.h>
+
+namespace slog {
+namespace detail {
+
+/**
+ * StringBuf is a std::streambuf appending to a string
+ */
+class StringBuf: public std::streambuf {
+public:
+    explicit StringBuf(std::string& out): out_(out) {}
+
+protected:
+    int_type overflow(int_type c) override;
+    std::streamsize xsputn(const char *s, std::streamsize n) override;
+
+private:
+    std::string& out_;
+}; // class StringBuf
+
+/**
+ * StreamState is the stream a LogStream renders the message with.
+ * Each thread reuses its own, constructing a std::ostream and its
+ * locale is paid once per thread.
+ */
+struct StreamState {
+    StreamState();
+
+    std::string text;
+    StringBuf buf{text};
+    std::ostream os{&buf};
+    std::ios_base::fmtflags flags; // initial flags of os
+    bool busy{false};
+};
+
+// acquire_stream returns the calling thread's stream, reset to its
+// initial state, or a new one if it is in use by an outer LogStream.
+StreamState *acquire_stream();
+
+// release_stream gives back a stream returned by acquire_stream()
+void release_stream(StreamState *s);
+
+} // namespace detail
+
+/**
+ * LogStream renders a record with the std::ostream operators, it is
+ * logged when the stream is destroyed, at the end of the statement:
+ *
+ *    log.Info() << "connected to " << host << ':' << port;
+ *
+ * Nothing is rendered if the level is not enabled, but the operands are
+ * still evaluated. The SLOG_STREAM macros skip the whole expression:
+ *
+ *    SLOG_DEBUG(log) << "state: " << dump_state();
+ *
+ * The manipulators apply to the current record only.
+ */
+template <typename LoggerT>
+class LogStream {
+public:
+    LogStream(LoggerT& logger, LogLevel::level_t level)
+        : logger_(&logger), level_(level),
+          state_(logger.Enabled(level) ? detail::acquire_stream() : nullptr) {}
+
+    LogStream(LogStream&& other)
+        : logger_(other.logger_), level_(other.level_), state_(other.state_) {
+        other.state_ = nullptr;
+    }
+
+    // Do not support copying/assigning objects
+    LogStream(const LogStream &) = delete;
+    LogStream &operator=(const LogStream &) = delete;
+
+    ~LogStream() {
+        if (!state_) return;
+        logger_->commit_stream(level_, state_->text);
+        detail::release_stream(state_);
+    }
+
+    template <typename T>
+    LogStream& operator<<(const T& value) {
+        if (state_) state_->os << value;
+        return *this;
+    }
+
+    LogStream& operator<<(std::ostream& (*manip)(std::ostream&)) {
+        if (state_) manip(state_->os);
+        return *this;
+    }
+
+    LogStream& operator<<(std::ios_base& (*manip)(std::ios_base&)) {
+        if (state_) manip(state_->os);
+        return *this;
+    }
+
+    // returns false if the record is not logged
+    explicit operator bool() const {
+        return state_ != nullptr;
+    }
+
+private:
+    LoggerT *logger_;
+    LogLevel::level_t level_;
+    detail::StreamState *state_;
+}; // class LogStream
+
+namespace detail {
+
+// Voidify turns the streaming expression into void, so that it could
+// be an operand of the conditional operator in SLOG_STREAM. The
+// precedence of & is lower than <<.
+struct Voidify {
+    template <typename LoggerT>
+    void operator&(const LogStream<LoggerT>&) const {}
+};
+
+} // namespace detail
+} // namespace slog
+
+// SLOG_STREAM logs a record streamed to it, the stream expression is
+// not evaluated if the level is not enabled:
+//
+//    SLOG_STREAM(log, slog::LogLevel::Info) << "x=" << x;
+#define SLOG_STREAM(logger, level) \
+    !(logger).Enabled(level) ? (void)0 : ::slog::detail::Voidify() & (logger).Stream(level)
+
+#define SLOG_TRACE(logger) SLOG_STREAM(logger, ::slog::LogLevel::Trace)
+#define SLOG_DEBUG(logger) SLOG_STREAM(logger, ::slog::LogLevel::Debug)
+#define SLOG_INFO(logger) SLOG_STREAM(logger, ::slog::LogLevel::Info)
+#define SLOG_WARNING(logger) SLOG_STREAM(logger, ::slog::LogLevel::Warning)
+#define SLOG_ERROR(logger) SLOG_STREAM(logger, ::slog::LogLevel::Error)
+#define SLOG_CRITICAL(logger) SLOG_STREAM(logger, ::slog::LogLevel::Critical)
+
+#endif // __SLOG_LOG_STREAM_H_
@@ -9,13 +9,23 @@
 #ifndef __SLOG_LOGGER_H_
 #define __SLOG_LOGGER_H_
 
+#include <algorithm>
+#include <atomic>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <string>
 #include <vector>
 #include <memory>
 #include <slog/target.h>
 #include <slog/decorators.h>
+#include <slog/pattern.h>
+#include <slog/probes.h>
+#include <slog/runtime_pattern.h>
+#include <slog/span.h>
+#include <slog/log_stream.h>
+#include <slog/payload.h>
+#include <slog/router.h>
 #include <slog/file_target.h>
 
 using namespace std;
@@ -26,39 +36,149 @@ namespace slog {
  */
 const static LogLevel::level_t DefaultLogLevel = LogLevel::Info;
 
-class Logger {
+/**
+ * Maximum number of payload bytes logged by default, see
+ * BasicLogger::SetPayloadLimit()
+ */
+const static size_t DefaultPayloadLimit = 64 * 1024;
+
+class ConfiguredLogger;
+
+/**
+ * LogBatch collects the records logged through it and writes them to
+ * the logger targets as one contiguous group when it goes out of scope
+ * (or on Commit()), with a single lock per target:
+ *
+ *    {
+ *        auto batch = log.Batch();
+ *        for (auto &kv : settings) {
+ *            batch.Info("%s = %s", kv.first.c_str(), kv.second.c_str());
+ *        }
+ *    } // written here
+ *
+ * A batch must be used by a single thread.
+ */
+template <typename LoggerT>
+class LogBatch {
+public:
+    explicit LogBatch(LoggerT& logger)
+        : logger_(&logger), batch_(logger.GetMemoryAccount().get()) {}
+
+    LogBatch(LogBatch&& other)
+        : logger_(other.logger_), batch_(move(other.batch_)) {
+        other.logger_ = nullptr;
+    }
+
+    // Do not support copying/assigning objects
+    LogBatch(const LogBatch &) = delete;
+    LogBatch &operator=(const LogBatch &) = delete;
+
+    ~LogBatch() {
+        Commit();
+    }
+
+    template <typename ...Args>
+    void Trace(const string& frmt, Args&&... args) {
+        add(LogLevel::Trace, frmt, forward<Args>(args)...);
+    }
+
+    template <typename ...Args>
+    void Debug(const string& frmt, Args&&... args) {
+        add(LogLevel::Debug, frmt, forward<Args>(args)...);
+    }
+
+    template <typename ...Args>
+    void Info(const string& frmt, Args&&... args) {
+        add(LogLevel::Info, frmt, forward<Args>(args)...);
+    }
+
+    template <typename ...Args>
+    void Warning(const string& frmt, Args&&... args) {
+        add(LogLevel::Warning, frmt, forward<Args>(args)...);
+    }
+
+    template <typename ...Args>
+    void Error(const string& frmt, Args&&... args) {
+        add(LogLevel::Error, frmt, forward<Args>(args)...);
+    }
+
+    template <typename ...Args>
+    void Critical(const string& frmt, Args&&... args) {
+        add(LogLevel::Critical, frmt, forward<Args>(args)...);
+    }
+
+    // Commit writes out the records collected so far
+    void Commit() {
+        if (!logger_ || batch_.Empty()) return;
+        logger_->commit_batch(batch_);
+        batch_.Clear();
+    }
+
+private:
+    template <typename ...Args>
+    void add(LogLevel::level_t level, const string& frmt, Args&&... args) {
+        const std::string *record = logger_->render(level, frmt, forward<Args>(args)...);
+        if (record && !batch_.Add(level, record->data(), record->size())) {
+            logger_->dropped_.fetch_add(1, memory_order_relaxed);
+        }
+    }
+
+    LoggerT *logger_;
+    RecordBatch batch_;
+}; // class LogBatch
+
+/**
+ * BasicLogger renders the log records with the given Pattern and
+ * hands them over to its targets. See slog::Pattern for defining
+ * custom record layouts.
+ *
+ * The records are dispatched through a routing table, which lists the
+ * targets accepting each level: its own targets and the targets of the
+ * matching Router routes. Targets that would reject a record are never
+ * called, and a record no target accepts is not even rendered. The
+ * table is rebuilt on the first log call after a change of the
+ * targets, the levels or the routes.
+ */
+template <typename LogPattern>
+class BasicLogger {
     using target_ptr_t = shared_ptr<Target>;
+    friend class LogBatch<BasicLogger>;
+    friend class Span<BasicLogger>;
+    friend class LogStream<BasicLogger>;
+    friend class ConfiguredLogger;
 public:
-    explicit Logger(string name)
+    explicit BasicLogger(string name)
         : context_(move(name)) {}
 
     template <typename It>
-    Logger(string name, It begin, It end)
+    BasicLogger(string name, It begin, It end)
         : context_(name), targets_(begin, end) {}
     
     template <typename It>
-    Logger(string name, LogLevel::level_t level, It begin, It end)
+    BasicLogger(string name, LogLevel::level_t level, It begin, It end)
         : context_(name), level_(level), targets_(begin, end) {}
 
-    Logger(string name, LogLevel::level_t level, initializer_list<target_ptr_t> targets)
-        : Logger{name, level, targets.begin(), targets.end()} {}
+    BasicLogger(string name, LogLevel::level_t level, initializer_list<target_ptr_t> targets)
+        : BasicLogger{name, level, targets.begin(), targets.end()} {}
 
-    Logger(string name, initializer_list<target_ptr_t> targets)
-        : Logger{name, targets.begin(), targets.end()} {}
+    BasicLogger(string name, initializer_list<target_ptr_t> targets)
+        : BasicLogger{name, targets.begin(), targets.end()} {}
     
-    Logger(string name, target_ptr_t target)
-        : Logger{name, {target}} {}
+    BasicLogger(string name, target_ptr_t target)
+        : BasicLogger{name, {target}} {}
 
-    Logger(string name, LogLevel::level_t level)
+    BasicLogger(string name, LogLevel::level_t level)
         : context_(move(name)), level_(level) {
         // reset the default target log level to the logger level
         targets_[0].get()->SetLogLevel(level);
     }
 
-    Logger(string name, LogLevel::level_t level, target_ptr_t target)
-        : Logger{name, level, {target}} {}
+    BasicLogger(string name, LogLevel::level_t level, target_ptr_t target)
+        : BasicLogger{name, level, {target}} {}
 
-    ~Logger() {};
+    ~BasicLogger() {
+        spans_.Drain();
+    }
 
     const string& Name() const {
         return context_;
@@ -66,6 +186,7 @@ public:
 
     void SetName(string name) {
         context_ = move(name);
+        routing_epoch.fetch_add(1, memory_order_release);
     }
 
     const vector<target_ptr_t>& Targets() const {
@@ -75,6 +196,7 @@ public:
     void AddTarget(target_ptr_t target) {
         std::lock_guard<std::mutex> lock(targets_mtx_);
         targets_.push_back(target);
+        routing_epoch.fetch_add(1, memory_order_release);
     }
 
     void RemoveTarget(target_ptr_t target) {
@@ -85,6 +207,19 @@ public:
                 break;
             }
         }
+        routing_epoch.fetch_add(1, memory_order_release);
+    }
+
+    // GetPattern returns the pattern used for rendering the records
+    const LogPattern& GetPattern() const {
+        return pattern_;
+    }
+
+    // SetPattern changes the record layout, e.g. to a RuntimePattern
+    // read from the configuration. It must not be called while other
+    // threads are logging with this logger.
+    void SetPattern(LogPattern pattern) {
+        pattern_ = move(pattern);
     }
 
     LogLevel::level_t GetLevel() const {
@@ -93,14 +228,35 @@ public:
 
     void SetLevel(LogLevel::level_t lvl) {
         level_ = lvl;
+        routing_epoch.fetch_add(1, memory_order_release);
     }
 
     void Flush() {
-        for (auto &t : targets_) {
+        spans_.Drain();
+        auto r = routes();
+        for (auto &t : r->all) {
             t->Flush();
         }
     }
 
+    // SetSpanThreshold logs the spans taking threshold or longer as
+    // records of the given level. A zero threshold disables it.
+    void SetSpanThreshold(std::chrono::nanoseconds threshold, LogLevel::level_t level = LogLevel::Warning) {
+        span_threshold_ = threshold.count();
+        span_level_ = level;
+    }
+
+    // Sync makes the records logged so far durable on all the targets.
+    // Returns false if any of the targets failed to sync.
+    bool Sync() {
+        bool ok = true;
+        auto r = routes();
+        for (auto &t : r->all) {
+            ok = t->Sync() && ok;
+        }
+        return ok;
+    }
+
     template <typename ...Args>
     void Trace(const string& frmt, Args&&... args) {
         log_entry(LogLevel::Trace, frmt, forward<Args>(args)...);
@@ -131,29 +287,457 @@ public:
         log_entry(LogLevel::Critical, move(frmt), forward<Args>(args)...);
     }
 
+    // Trace() ... Critical() return a stream the record is rendered
+    // with, see LogStream:
+    //
+    //    log.Info() << "x=" << x;
+    LogStream<BasicLogger> Trace() {
+        return Stream(LogLevel::Trace);
+    }
+
+    LogStream<BasicLogger> Debug() {
+        return Stream(LogLevel::Debug);
+    }
+
+    LogStream<BasicLogger> Info() {
+        return Stream(LogLevel::Info);
+    }
+
+    LogStream<BasicLogger> Warning() {
+        return Stream(LogLevel::Warning);
+    }
+
+    LogStream<BasicLogger> Error() {
+        return Stream(LogLevel::Error);
+    }
+
+    LogStream<BasicLogger> Critical() {
+        return Stream(LogLevel::Critical);
+    }
+
+    LogStream<BasicLogger> Stream(LogLevel::level_t msg_lvl) {
+        return LogStream<BasicLogger>(*this, msg_lvl);
+    }
+
+    // Enabled returns true if any of the targets accepts
+    // the records of the given level
+    bool Enabled(LogLevel::level_t msg_lvl) {
+        return valid_level(msg_lvl) && !routes()->by_level[msg_lvl].empty() && !degraded(msg_lvl);
+    }
+
+    // SetMemoryAccount makes the logger allocate its buffers, like the
+    // batches, from the account. While the account, or the account of
+    // any of the targets (see Target::Memory()), is under pressure the
+    // records less severe than degrade_level are dropped, the trace
+    // records by default. It must not be called while other threads
+    // are logging with this logger.
+    void SetMemoryAccount(shared_ptr<MemoryAccount> account, LogLevel::level_t degrade_level = LogLevel::Debug) {
+        memory_ = move(account);
+        degrade_level_ = degrade_level;
+        routing_epoch.fetch_add(1, memory_order_release);
+    }
+
+    const shared_ptr<MemoryAccount>& GetMemoryAccount() const {
+        return memory_;
+    }
+
+    // Dropped returns the number of records dropped for lack of memory
+    uint64_t Dropped() const {
+        return dropped_.load(memory_order_relaxed);
+    }
+
+    // LogPayload logs the record followed by the payload, on the next
+    // line(s). Only the first PayloadLimit() bytes of the payload are
+    // logged. Text payloads are not copied by the logger, but for the
+    // targets with a redactor. Hex dumps are not redacted:
+    //
+    //    log.LogPayload(LogLevel::Debug, slog::Payload(body), "request body of %s", id);
+    //    log.LogPayload(LogLevel::Trace, slog::Hexdump(packet, len), "packet from %s", peer);
+    template <typename ...Args>
+    void LogPayload(LogLevel::level_t msg_lvl, const Payload& payload, const string& fmt, Args&&... args) {
+        if (!valid_level(msg_lvl)) return;
+        auto r = routes();
+        auto &targets = r->by_level[msg_lvl];
+        if (targets.empty()) return;
+        if (!render(msg_lvl, fmt, forward<Args>(args)...)) return;
+        std::string &record = record_buffer();
+        if (record.empty() || record[record.size()-1] != '\n') {
+            record += '\n';
+        }
+
+        // truncate before anything gets copied
+        size_t size = payload.size < payload_limit_ ? payload.size : payload_limit_;
+        const char *data = static_cast<const char *>(payload.data);
+        struct iovec iov[3];
+        int n = 0;
+        iov[n++] = iovec{&record[0], record.size()};
+        if (payload.encoding == Payload::Hex) {
+            std::string &hex = payload_buffer();
+            hex.clear();
+            hexdump(hex, data, size);
+            data = hex.data();
+            size = hex.size();
+        }
+        int text = -1; // iov of the text payload
+        if (size) {
+            if (payload.encoding == Payload::Text) text = n;
+            iov[n++] = iovec{const_cast<char *>(data), size};
+        }
+        char note[64];
+        if (payload.size > payload_limit_) {
+            bool newline = size && data[size-1] != '\n';
+            int len = snprintf(note, sizeof(note), "%s[%zu of %zu bytes truncated]",
+                newline ? "\n" : "", payload.size - payload_limit_, payload.size);
+            iov[n++] = iovec{note, static_cast<size_t>(len)};
+        }
+        // every redactor masks copies of the record and of the caller's
+        // payload, as rendered
+        const Redactor *redacted = nullptr;
+        for (auto &route: targets) {
+            if (route.redactor != redacted) {
+                std::string &copy = redact_buffer();
+                copy.assign(record);
+                route.redactor->Redact(&copy[0], copy.size());
+                iov[0].iov_base = &copy[0];
+                if (text >= 0) {
+                    std::string &body = payload_buffer();
+                    body.assign(data, size);
+                    route.redactor->Redact(&body[0], body.size());
+                    iov[text].iov_base = &body[0];
+                }
+                redacted = route.redactor;
+            }
+            route.target->WriteIov(msg_lvl, iov, n);
+        }
+    }
+
+    // PayloadLimit returns the maximum number of payload bytes logged
+    size_t PayloadLimit() const {
+        return payload_limit_;
+    }
+
+    // SetPayloadLimit changes the maximum number of payload bytes logged,
+    // the rest of a payload is dropped.
+    void SetPayloadLimit(size_t limit) {
+        payload_limit_ = limit;
+    }
+
+    // Batch returns a scope object that collects records and writes
+    // them to the targets as one group, see LogBatch.
+    LogBatch<BasicLogger> Batch() {
+        return LogBatch<BasicLogger>(*this);
+    }
+
 protected:
     template<typename ...Args>
     void log_entry(LogLevel::level_t msg_lvl, const string& fmt, Args&&... args) {
-        // do nothing if the log level is not enabled.
-        if (LogLevel{msg_lvl} > level_) return;
+        if (!valid_level(msg_lvl)) return;
+        auto r = routes();
+        auto &targets = r->by_level[msg_lvl];
+        if (targets.empty()) return;
+        // render the message only once and hand over the same
+        // bytes to all the targets.
+        if (!render(msg_lvl, fmt, forward<Args>(args)...)) return;
+        std::string &record = record_buffer();
+        SLOG_PROBE3(log_entry, msg_lvl, Name().c_str(), record.size());
+        // the targets without a redactor come first, the others get
+        // a copy of the record masked by their own redactor only
+        const Redactor *redacted = nullptr;
+        const std::string *out = &record;
+        for (auto &route: targets) {
+            if (route.redactor != redacted) {
+                std::string &copy = redact_buffer();
+                copy.assign(record);
+                route.redactor->Redact(&copy[0], copy.size());
+                out = &copy;
+                redacted = route.redactor;
+            }
+            route.target->Write(msg_lvl, out->data(), out->size());
+        }
+    }
+
+    // render renders the record into the calling thread's record buffer.
+    // Returns nullptr if the log level is not enabled or rendering fails.
+    template<typename ...Args>
+    const std::string *render(LogLevel::level_t msg_lvl, const string& fmt, Args&&... args) {
+        if (LogLevel{msg_lvl} > level_) return nullptr;
+        if (degraded(msg_lvl)) {
+            dropped_.fetch_add(1, memory_order_relaxed);
+            return nullptr;
+        }
 
-        // TODO(avalluri): currently using a predefined list and order of 
-        // log message decorators. This shall be configurable per logger/target.
-        std::string decorated_msg = DateTimeDecorator().string() + " " +
-            PidDecorator().string() + " " +
-            LogLevelDecorator(msg_lvl).string() + " " + fmt;
+        std::string &record = record_buffer();
+        pattern::Record rec{msg_lvl, context_, std::chrono::system_clock::now()};
+        if (!pattern_.Format(record, rec, fmt.c_str(), args...)) {
+            return nullptr;
+        }
+        return &record;
+    }
 
-        for (auto &target: targets_) {
-            target->Log(msg_lvl, decorated_msg, forward<Args>(args)...);
+    // degraded returns true if the records of the level are dropped
+    // as the memory account of the logger or of a target is under pressure
+    bool degraded(LogLevel::level_t msg_lvl) {
+        if (LogLevel{msg_lvl} <= LogLevel{degrade_level_}) return false;
+        auto r = routes();
+        for (auto account : r->accounts) {
+            if (account->UnderPressure()) return true;
+        }
+        return false;
+    }
+
+    // end_span records a span that ended, see SLOG_SPAN
+    void end_span(const char *name, int64_t start, int64_t end) {
+        spans_.Add(name, start, end - start);
+        if (span_threshold_ && end - start >= span_threshold_) {
+            log_entry(span_level_, "span %s took %.3f ms", name, (end - start) / 1e6);
+        }
+    }
+
+    // commit_stream logs the message rendered by a LogStream, the
+    // pattern copies its bytes into the record
+    void commit_stream(LogLevel::level_t msg_lvl, const std::string& msg) {
+        static const std::string none;
+        log_entry(msg_lvl, none, pattern::Text{msg.data(), msg.size()});
+    }
+
+    void commit_batch(const RecordBatch& batch) {
+        auto r = routes();
+        // the most verbose record, the routes capped below it
+        // get the records of their level only
+        LogLevel verbose{LogLevel::None};
+        for (auto &e : batch.Entries()) {
+            if (LogLevel{e.level} > verbose) verbose = e.level;
+        }
+        // the targets without a redactor come first, the others get
+        // a copy of the batch masked by their own redactor only
+        RecordBatch copy(memory_.get());
+        bool copied = false;
+        const Redactor *copy_redactor = nullptr;
+        LogLevel::level_t copy_level = LogLevel::Trace;
+        for (auto &route: r->capped) {
+            auto level = verbose <= LogLevel{route.max_level} ? LogLevel::Trace : route.max_level;
+            if (!route.redactor && level == LogLevel::Trace) {
+                route.target->WriteBatch(batch);
+                continue;
+            }
+            if (!copied || route.redactor != copy_redactor || level != copy_level) {
+                copied = copy.Assign(batch, level);
+                if (!copied) {
+                    for (auto &e : batch.Entries()) {
+                        if (LogLevel{e.level} <= LogLevel{level}) {
+                            dropped_.fetch_add(1, memory_order_relaxed);
+                        }
+                    }
+                    continue;
+                }
+                if (route.redactor) copy.Redact(*route.redactor);
+                copy_redactor = route.redactor;
+                copy_level = level;
+            }
+            if (!copy.Empty()) route.target->WriteBatch(copy);
         }
     }
 
+    // record_buffer returns the calling thread's buffer used
+    // for rendering the log records.
+    static std::string& record_buffer() {
+        static thread_local std::string buffer;
+        return buffer;
+    }
+
+    // payload_buffer returns the calling thread's buffer used
+    // for rendering the hex dumps of the payloads, or for masking
+    // the text payloads.
+    static std::string& payload_buffer() {
+        static thread_local std::string buffer;
+        return buffer;
+    }
+
+    // redact_buffer returns the calling thread's buffer used
+    // for masking the records.
+    static std::string& redact_buffer() {
+        static thread_local std::string buffer;
+        return buffer;
+    }
+
 private:
+    struct route_t {
+        Target *target;
+        const Redactor *redactor;
+        LogLevel::level_t max_level; // the most verbose level routed to it
+    };
+
+    // routes_t is the routing table of the logger. The targets are
+    // ordered by their redactor, the ones without a redactor first.
+    struct routes_t {
+        uint64_t epoch;                            // routing_epoch it was built at
+        vector<target_ptr_t> all;                  // own and routed targets
+        vector<route_t> by_level[LogLevel::Max];   // targets accepting each level
+        vector<route_t> capped;                    // all the targets, with their route level
+        vector<shared_ptr<const Redactor> > redactors; // keeps the redactors alive
+        vector<const MemoryAccount *> accounts;   // of the logger and the targets
+    };
+
+    // routes_ref_t holds on to a routing table while it is used, the
+    // tables replaced meanwhile are not freed until it is released.
+    class routes_ref_t {
+    public:
+        routes_ref_t(BasicLogger *logger, const routes_t *table): logger_(logger), table_(table) {}
+        routes_ref_t(routes_ref_t&& other): logger_(other.logger_), table_(other.table_) {
+            other.logger_ = nullptr;
+        }
+        ~routes_ref_t() {
+            if (logger_) logger_->release_routes();
+        }
+        const routes_t *operator->() const {
+            return table_;
+        }
+    private:
+        BasicLogger *logger_;
+        const routes_t *table_;
+    };
+
+    // routes returns the current routing table, rebuilding it
+    // if anything changed since it was built.
+    routes_ref_t routes() {
+        // counted before loading the table, see release_routes()
+        readers_.fetch_add(1, memory_order_seq_cst);
+        const routes_t *r = routes_.load(memory_order_seq_cst);
+        if (!r || r->epoch != routing_epoch.load(memory_order_acquire)) {
+            r = rebuild_routes();
+        }
+        return routes_ref_t(this, r);
+    }
+
+    // release_routes frees the replaced tables once no thread uses a
+    // table. A thread that starts using one after the count dropped to
+    // zero loads the current table, which is never freed here.
+    void release_routes() {
+        if (readers_.fetch_sub(1, memory_order_seq_cst) != 1 ||
+            !retired_.load(memory_order_relaxed)) {
+            return;
+        }
+        std::unique_lock<std::mutex> lock(targets_mtx_, std::try_to_lock);
+        if (!lock.owns_lock() || readers_.load(memory_order_seq_cst) != 0) {
+            return;
+        }
+        tables_.erase(tables_.begin(), tables_.end() - 1);
+        retired_.store(false, memory_order_relaxed);
+    }
+
+    const routes_t *rebuild_routes() {
+        std::lock_guard<std::mutex> lock(targets_mtx_);
+        // read the epoch first, the changes made while building
+        // the table invalidate it
+        uint64_t epoch = routing_epoch.load(memory_order_acquire);
+        const routes_t *r = routes_.load(memory_order_seq_cst);
+        if (r && r->epoch == epoch) {
+            return r;
+        }
+
+        unique_ptr<routes_t> t{new routes_t};
+        t->epoch = epoch;
+        // own targets are kept for flushing even if they accept no level
+        auto add = [this, &t](const target_ptr_t& target, LogLevel::level_t max_level, bool own) {
+            bool added = own;
+            route_t route{target.get(), target->GetRedactor().get(), max_level};
+            for (int l = LogLevel::None; l < LogLevel::Max; l++) {
+                auto lvl = static_cast<LogLevel::level_t>(l);
+                auto &targets = t->by_level[l];
+                if (LogLevel{lvl} > level_ || LogLevel{lvl} > LogLevel{max_level} || !target->ShouldLog(lvl) ||
+                    find_if(targets.begin(), targets.end(), [&target](const route_t& r) {
+                        return r.target == target.get();
+                    }) != targets.end()) {
+                    continue;
+                }
+                targets.push_back(route);
+                added = true;
+            }
+            if (!added) return;
+            if (find(t->all.begin(), t->all.end(), target) == t->all.end()) {
+                t->all.push_back(target);
+            }
+            // a target routed more than once takes the most verbose level
+            auto it = find_if(t->capped.begin(), t->capped.end(), [&target](const route_t& r) {
+                return r.target == target.get();
+            });
+            if (it == t->capped.end()) {
+                t->capped.push_back(route);
+            } else if (LogLevel{max_level} > LogLevel{it->max_level}) {
+                it->max_level = max_level;
+            }
+        };
+        for (auto &target : targets_) {
+            add(target, LogLevel::Trace, true);
+        }
+        for (auto &route : Router::Instance().Match(context_)) {
+            add(route.target, route.level, false);
+        }
+        auto unredacted_first = [](const Redactor *a, const Redactor *b) {
+            return (a != nullptr) < (b != nullptr) || (a && b && std::less<const Redactor *>()(a, b));
+        };
+        auto by_redactor = [&](const route_t& a, const route_t& b) {
+            return unredacted_first(a.redactor, b.redactor);
+        };
+        for (auto &targets : t->by_level) {
+            stable_sort(targets.begin(), targets.end(), by_redactor);
+        }
+        stable_sort(t->capped.begin(), t->capped.end(), by_redactor);
+        stable_sort(t->all.begin(), t->all.end(), [&](const target_ptr_t& a, const target_ptr_t& b) {
+            return unredacted_first(a->GetRedactor().get(), b->GetRedactor().get());
+        });
+        for (auto &target : t->all) {
+            if (target->GetRedactor()) t->redactors.push_back(target->GetRedactor());
+        }
+        if (memory_) t->accounts.push_back(memory_.get());
+        for (auto &target : t->all) {
+            auto account = dynamic_cast<const MemoryAccount *>(target->Memory().get());
+            if (account && find(t->accounts.begin(), t->accounts.end(), account) == t->accounts.end()) {
+                t->accounts.push_back(account);
+            }
+        }
+
+        // the threads logging concurrently may still use the previous
+        // tables, they are freed by release_routes()
+        routes_.store(t.get(), memory_order_seq_cst);
+        tables_.push_back(move(t));
+        retired_.store(tables_.size() > 1, memory_order_relaxed);
+        return tables_.back().get();
+    }
+
+    // valid_level returns if the level indexes the routing tables
+    static bool valid_level(LogLevel::level_t msg_lvl) {
+        return msg_lvl >= LogLevel::None && msg_lvl < LogLevel::Max;
+    }
+
+    LogPattern pattern_;
     string  context_;
     LogLevel level_{DefaultLogLevel};
     vector<shared_ptr<slog::Target> > targets_{make_shared<StdoutTarget<mutex> >(LogLevel::Trace)};
-    std::mutex targets_mtx_; // mutex to protect targets_ from concurrent access
-}; // class logger
+    std::mutex targets_mtx_; // mutex to protect targets_ and tables_ from concurrent access
+    std::atomic<const routes_t *> routes_{nullptr};
+    vector<unique_ptr<routes_t> > tables_; // the current table, last, and the replaced ones
+    std::atomic<uint32_t> readers_{0};     // threads using a table
+    std::atomic<bool> retired_{false};     // tables_ holds replaced tables
+    int64_t span_threshold_{0}; // nanoseconds
+    LogLevel::level_t span_level_{LogLevel::Warning};
+    size_t payload_limit_{DefaultPayloadLimit};
+    shared_ptr<MemoryAccount> memory_;
+    LogLevel::level_t degrade_level_{LogLevel::Debug};
+    std::atomic<uint64_t> dropped_{0};
+    // the spans count as Info records against the route levels
+    SpanCollector spans_{[this](const SpanEvent *events, size_t n) {
+        auto r = routes();
+        for (auto &route: r->capped) {
+            if (LogLevel{LogLevel::Info} <= LogLevel{route.max_level}) {
+                route.target->WriteSpans(events, n);
+            }
+        }
+    }};
+}; // class BasicLogger
+
+// Logger is the logger with the default record layout
+using Logger = BasicLogger<DefaultPattern>;
 
 } // namespace slog
 
@@ -0,0 +1,161 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_MEMORY_H_
+#define __SLOG_MEMORY_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <string>
+
+namespace slog {
+
+/**
+ * MemoryResource is the source of the memory of the buffers of the
+ * loggers and the targets, modelled after std::pmr::memory_resource.
+ * Allocate() throws std::bad_alloc if the memory could not be provided.
+ */
+class MemoryResource {
+public:
+    virtual ~MemoryResource() = default;
+
+    void *Allocate(size_t bytes, size_t align = alignof(std::max_align_t)) {
+        return allocate(bytes, align);
+    }
+
+    void Deallocate(void *p, size_t bytes, size_t align = alignof(std::max_align_t)) {
+        deallocate(p, bytes, align);
+    }
+
+protected:
+    virtual void *allocate(size_t bytes, size_t align) = 0;
+    virtual void deallocate(void *p, size_t bytes, size_t align) = 0;
+}; // class MemoryResource
+
+// DefaultMemoryResource returns the resource allocating with
+// operator new, used when no other resource is given.
+MemoryResource *DefaultMemoryResource();
+
+/**
+ * Allocator adapts a MemoryResource to the standard containers, like
+ * std::pmr::polymorphic_allocator. Containers copied or moved keep the
+ * resource they were created with.
+ */
+template <typename T>
+class Allocator {
+public:
+    using value_type = T;
+
+    Allocator(MemoryResource *resource = nullptr)
+        : resource_(resource ? resource : DefaultMemoryResource()) {}
+
+    template <typename U>
+    Allocator(const Allocator<U>& other): resource_(other.Resource()) {}
+
+    T *allocate(size_t n) {
+        return static_cast<T *>(resource_->Allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *p, size_t n) {
+        resource_->Deallocate(p, n * sizeof(T), alignof(T));
+    }
+
+    MemoryResource *Resource() const {
+        return resource_;
+    }
+
+private:
+    MemoryResource *resource_;
+}; // class Allocator
+
+template <typename T, typename U>
+bool operator==(const Allocator<T>& a, const Allocator<U>& b) {
+    return a.Resource() == b.Resource();
+}
+
+template <typename T, typename U>
+bool operator!=(const Allocator<T>& a, const Allocator<U>& b) {
+    return !(a == b);
+}
+
+// MemoryBuffer is a byte buffer allocated from a MemoryResource
+using MemoryBuffer = std::basic_string<char, std::char_traits<char>, Allocator<char> >;
+
+/**
+ * MemoryAccount is a MemoryResource that counts the bytes allocated
+ * through it, and refuses to grow past its budget:
+ *
+ *    auto logging = std::make_shared<MemoryAccount>(8 << 20);  // 8 MiB for all the logging
+ *    FileOptions options;
+ *    options.memory = std::make_shared<MemoryAccount>(4 << 20, logging);
+ *    ...
+ *    log.SetMemoryAccount(logging);  // drop the trace records under pressure
+ *
+ * Accounts could be nested: the allocations of an account are made
+ * from its upstream resource, so they count against the budgets of
+ * all the accounts up the chain.
+ */
+class MemoryAccount: public MemoryResource {
+public:
+    // MemoryAccount creates an account of the given budget in bytes,
+    // 0 for unlimited, allocating from the upstream resource.
+    explicit MemoryAccount(size_t budget = 0, std::shared_ptr<MemoryResource> upstream = nullptr);
+
+    // Current returns the number of bytes currently allocated
+    size_t Current() const {
+        return current_.load(std::memory_order_relaxed);
+    }
+
+    // Peak returns the highest number of bytes ever allocated
+    size_t Peak() const {
+        return peak_.load(std::memory_order_relaxed);
+    }
+
+    size_t Budget() const {
+        return budget_;
+    }
+
+    // Refused returns the number of allocations refused, as they
+    // would have exceeded the budget
+    uint64_t Refused() const {
+        return refused_.load(std::memory_order_relaxed);
+    }
+
+    // SetPressureLimit sets the number of bytes from which on the
+    // account is under pressure, 3/4 of the budget by default.
+    void SetPressureLimit(size_t bytes) {
+        pressure_limit_.store(bytes, std::memory_order_relaxed);
+    }
+
+    // UnderPressure returns true if the allocations are close to the
+    // budget, the users of the account should cut down on logging.
+    bool UnderPressure() const {
+        size_t limit = pressure_limit_.load(std::memory_order_relaxed);
+        return limit && Current() >= limit;
+    }
+
+protected:
+    void *allocate(size_t bytes, size_t align) override;
+    void deallocate(void *p, size_t bytes, size_t align) override;
+
+private:
+    size_t budget_;
+    std::atomic<size_t> pressure_limit_;
+    std::shared_ptr<MemoryResource> upstream_;
+    MemoryResource *resource_; // upstream_ or the default resource
+    std::atomic<size_t> current_{0};
+    std::atomic<size_t> peak_{0};
+    std::atomic<uint64_t> refused_{0};
+}; // class MemoryAccount
+
+} // namespace slog
+
+#endif // __SLOG_MEMORY_H_
@@ -0,0 +1,265 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_PATTERN_H_
+#define __SLOG_PATTERN_H_
+
+#include <ctime>
+#include <cstdint>
+#include <chrono>
+#include <string>
+#include <slog/log_level.h>
+#include <slog/utils.h>
+#include <slog/thread_context.h>
+
+namespace slog {
+namespace pattern {
+
+/**
+ * Pattern elements
+ *
+ * A pattern element renders one field of the log record, straight
+ * into the record buffer:
+ *
+ *    struct MyElement {
+ *        static void format(std::string& out, const Record& r);
+ *    };
+ *
+ * Message is the placeholder for the formatted log message. Elements
+ * that render nothing, e.g. an empty Mdc, are left out with their
+ * separator.
+*/
+
+using seconds = std::chrono::seconds;
+using ms = std::chrono::milliseconds;
+using us = std::chrono::microseconds;
+using ns = std::chrono::nanoseconds;
+
+// Record holds the attributes of the log record being rendered.
+struct Record {
+    LogLevel::level_t level;
+    const std::string& name;  // logger name
+    std::chrono::system_clock::time_point time;
+};
+
+// Text is a message already rendered, e.g. by a LogStream. Passed as the
+// only argument of Format(), its bytes are copied as they are and the
+// format string is ignored.
+struct Text {
+    const char *data;
+    size_t size;
+};
+
+namespace detail {
+
+// append_message renders the message at the end of out, from the
+// printf-style format string and its arguments
+template <typename ...Args>
+inline bool append_message(std::string& out, const char *fmt, const Args&... args) {
+    return utils::append(out, fmt, args...);
+}
+
+inline bool append_message(std::string& out, const char *, const Text& text) {
+    out.append(text.data, text.size);
+    return true;
+}
+
+// append_uint appends the decimal digits of v to out,
+// zero padded to at least width digits.
+inline void append_uint(std::string& out, uint64_t v, size_t width = 0) {
+    char buf[24];
+    char *p = buf + sizeof(buf);
+    do {
+        *--p = static_cast<char>('0' + v % 10);
+        v /= 10;
+    } while (v);
+    while (static_cast<size_t>(buf + sizeof(buf) - p) < width && p > buf) {
+        *--p = '0';
+    }
+    out.append(p, buf + sizeof(buf) - p);
+}
+
+// fraction_digits returns the number of decimal digits of a fraction
+// of second with the given ratio denominator, e.g. 1000 => 3.
+constexpr size_t fraction_digits(intmax_t den) {
+    return den <= 1 ? 0 : 1 + fraction_digits(den / 10);
+}
+
+} // namespace detail
+
+// DateTime renders the local time in the locale's format, "[%c]".
+struct DateTime {
+    static void format(std::string& out, const Record& r) {
+        // strftime() runs once per second and thread
+        static thread_local std::time_t cached{-1};
+        static thread_local char text[64];
+        static thread_local size_t len{0};
+        std::time_t t = std::chrono::system_clock::to_time_t(r.time);
+        if (t != cached) {
+            std::tm tm;
+            localtime_r(&t, &tm);
+            len = std::strftime(text, sizeof(text), "[%c]", &tm);
+            cached = t;
+        }
+        out.append(text, len);
+    }
+};
+
+// Timestamp renders the local time as "[YYYY-mm-dd HH:MM:SS.fff]"
+// with the fraction of second in the given precision.
+template <typename Precision = us>
+struct Timestamp {
+    static_assert(Precision::period::num == 1, "Timestamp precision must be a fraction of second");
+
+    static void format(std::string& out, const Record& r) {
+        static thread_local std::time_t cached{-1};
+        static thread_local char text[32];
+        static thread_local size_t len{0};
+        auto since = r.time.time_since_epoch();
+        auto secs = std::chrono::duration_cast<std::chrono::seconds>(since);
+        std::time_t t = static_cast<std::time_t>(secs.count());
+        if (t != cached) {
+            std::tm tm;
+            localtime_r(&t, &tm);
+            len = std::strftime(text, sizeof(text), "[%Y-%m-%d %H:%M:%S", &tm);
+            cached = t;
+        }
+        out.append(text, len);
+        const size_t digits = detail::fraction_digits(Precision::period::den);
+        if (digits) {
+            out += '.';
+            detail::append_uint(out,
+                std::chrono::duration_cast<Precision>(since - secs).count(), digits);
+        }
+        out += ']';
+    }
+};
+
+// Pid renders the process id, "[1234]".
+struct Pid {
+    static void format(std::string& out, const Record&) {
+        out += '[';
+        detail::append_uint(out, static_cast<uint64_t>(ThreadContext::Current().Pid()));
+        out += ']';
+    }
+};
+
+// ThreadId renders the kernel thread id, "[1234]".
+struct ThreadId {
+    static void format(std::string& out, const Record&) {
+        out += '[';
+        detail::append_uint(out, static_cast<uint64_t>(ThreadContext::Current().Tid()));
+        out += ']';
+    }
+};
+
+// ThreadName renders the thread name, or the sequential thread
+// number if the thread has no name, "[worker]" or "[3]".
+struct ThreadName {
+    static void format(std::string& out, const Record&) {
+        const ThreadContext& context = ThreadContext::Current();
+        out += '[';
+        if (context.Name().empty()) {
+            detail::append_uint(out, context.Number());
+        } else {
+            out += context.Name();
+        }
+        out += ']';
+    }
+};
+
+// Mdc renders the thread's mapped diagnostic context,
+// "request=42 user=bob", nothing if it is empty.
+struct Mdc {
+    static void format(std::string& out, const Record&) {
+        out += ThreadContext::Current().Mdc();
+    }
+};
+
+// Level renders the log level character, "[I]".
+struct Level {
+    static void format(std::string& out, const Record& r) {
+        char text[3] = {'[', LogLevel(r.level).ToChar(), ']'};
+        out.append(text, sizeof(text));
+    }
+};
+
+// Name renders the logger name, "[name]".
+struct Name {
+    static void format(std::string& out, const Record& r) {
+        out += '[';
+        out += r.name;
+        out += ']';
+    }
+};
+
+// Message is the placeholder of the formatted log message.
+struct Message {};
+
+namespace detail {
+
+template <typename Element, typename ...Args>
+inline bool format_element(Element, std::string& out, const Record& r, bool& first,
+                           const char *, const Args&...) {
+    size_t mark = out.size();
+    if (!first) out += ' ';
+    size_t start = out.size();
+    Element::format(out, r);
+    if (out.size() == start) {
+        // drop the separator of an empty element
+        out.resize(mark);
+    } else {
+        first = false;
+    }
+    return true;
+}
+
+template <typename ...Args>
+inline bool format_element(Message, std::string& out, const Record&, bool& first,
+                           const char *fmt, const Args&... args) {
+    if (!first) out += ' ';
+    first = false;
+    return append_message(out, fmt, args...);
+}
+
+} // namespace detail
+} // namespace pattern
+
+/**
+ * Pattern defines the layout of the log records at compile time,
+ * as a list of pattern elements separated with a space:
+ *
+ *    slog::BasicLogger<slog::Pattern<pattern::Timestamp<pattern::us>,
+ *        pattern::ThreadId, pattern::Level, pattern::Message>> log{"app"};
+ *
+ * The elements are expanded inline, the compiler generates a
+ * specialized formatting function for each pattern.
+*/
+template <typename ...Elements>
+class Pattern {
+public:
+    // Format renders the record into out, replacing its contents.
+    // Returns false if the message could not be rendered.
+    template <typename ...Args>
+    bool Format(std::string& out, const pattern::Record& r, const char *fmt, const Args&... args) const {
+        out.clear();
+        bool ok = true, first = true;
+        int expand[] = {0, (ok = pattern::detail::format_element(
+            Elements{}, out, r, first, fmt, args...) && ok, 0)...};
+        (void)expand;
+        return ok;
+    }
+}; // class Pattern
+
+// DefaultPattern is the record layout used by slog::Logger:
+//    [Thu Nov  2 12:38:19 2023] [508754] [I] message
+using DefaultPattern = Pattern<pattern::DateTime, pattern::Pid, pattern::Level, pattern::Message>;
+
+} // namespace slog
+
+#endif // __SLOG_PATTERN_H_
@@ -0,0 +1,67 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_PAYLOAD_H_
+#define __SLOG_PAYLOAD_H_
+
+#include <cstddef>
+#include <string>
+#include <type_traits>
+
+namespace slog {
+
+/**
+ * Payload refers to a caller owned buffer which is logged after the
+ * record message, see BasicLogger::LogPayload(). The buffer is written
+ * as it is (Text), or as a `hexdump -C` style dump (Hex).
+ *
+ * Payload does not copy the buffer, it must stay valid until the log
+ * call returns.
+ */
+struct Payload {
+    enum encoding_t { Text, Hex };
+
+    Payload(const void *data, size_t size, encoding_t encoding = Text)
+        : data(data), size(size), encoding(encoding) {}
+
+    // Payload of any contiguous container, e.g. std::string or
+    // std::vector<uint8_t>
+    template <typename C, typename = decltype(std::declval<const C&>().data()),
+              typename = decltype(std::declval<const C&>().size())>
+    Payload(const C& c, encoding_t encoding = Text)
+        : data(c.data()), size(c.size() * sizeof(*c.data())), encoding(encoding) {}
+
+    const void *data;
+    size_t size;
+    encoding_t encoding;
+};
+
+// Hexdump returns a payload logged as hex dump of the buffer
+inline Payload Hexdump(const void *data, size_t size) {
+    return Payload(data, size, Payload::Hex);
+}
+
+template <typename C>
+Payload Hexdump(const C& c) {
+    return Payload(c, Payload::Hex);
+}
+
+// HexdumpLineSize is the size of a full line of the hex dump
+const size_t HexdumpLineSize = 79;
+
+// hexdump appends the `hexdump -C` style dump of the buffer to out:
+//
+//    00000000  68 65 6c 6c 6f 20 77 6f  72 6c 64 0a              |hello world.|
+//
+// Every line ends with a line feed. The full lines are converted 16
+// bytes at a time with SSE2, where available.
+void hexdump(std::string& out, const void *data, size_t size);
+
+} // namespace slog
+
+#endif // __SLOG_PAYLOAD_H_
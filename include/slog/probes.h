@@ -0,0 +1,120 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_PROBES_H_
+#define __SLOG_PROBES_H_
+
+#include <cstdint>
+#include <type_traits>
+
+/**
+ * Static tracing probes of the logging path, in the SystemTap SDT
+ * format understood by perf, bpftrace, SystemTap and bcc (USDT):
+ *
+ *    $ bpftrace -e 'usdt:./app:slog:log_entry { @bytes[str(arg1)] = sum(arg2); }'
+ *    $ perf buildid-cache --add ./app && perf record -e sdt_slog:flush_begin ./app
+ *
+ * A probe is a single nop instruction, with a note in the .note.stapsdt
+ * section of the binary recording its address and where to find its
+ * arguments. The tracers replace the nop with a breakpoint when they
+ * attach, so the probes cost nothing else without one. The arguments
+ * are evaluated anyway, they must be cheap.
+ *
+ * The probes of the "slog" provider, and their arguments:
+ *
+ *    log_entry(level, logger name, bytes)    a record rendered by a logger
+ *    target_enter(target, level, bytes)      a record handed to a target,
+ *                                            before the level filter
+ *    target_accept(target, level, bytes)     a record passed the filter
+ *    lock_acquire(file name)                 FileTarget locks the file
+ *    lock_acquired(file name)
+ *    lock_release(file name)
+ *    flush_begin(target)                     around Target::Flush()
+ *    flush_end(target)
+ *
+ * The target probes fire for Log(), Write(), WriteIov() and each record
+ * of WriteBatch(); the bytes of Log() records are unknown, reported as 0,
+ * those of WriteIov() are the sum of its parts. The probes are built on x86-64 and AArch64 ELF targets, unless
+ * SLOG_NO_PROBES is defined; elsewhere they expand to nothing.
+ */
+
+#if !defined(SLOG_NO_PROBES) && defined(__ELF__) && (defined(__x86_64__) || defined(__aarch64__))
+
+namespace slog {
+namespace detail {
+
+// probe_arg passes the probe arguments as 64-bit signed integers
+template <typename T>
+inline typename std::enable_if<!std::is_pointer<T>::value, int64_t>::type probe_arg(T v) {
+    return static_cast<int64_t>(v);
+}
+
+template <typename T>
+inline int64_t probe_arg(T *p) {
+    return static_cast<int64_t>(reinterpret_cast<intptr_t>(p));
+}
+
+} // namespace detail
+} // namespace slog
+
+#define SLOG_PROBE_STR_(x) #x
+#define SLOG_PROBE_STR(x) SLOG_PROBE_STR_(x)
+
+// SLOG_PROBE_NOTE_ emits the nop of the probe and its note: the probe
+// address, the base address and semaphore (none), the provider, the
+// name and the argument descriptions.
+#define SLOG_PROBE_NOTE_(name, args) \
+    "990: nop\n" \
+    ".pushsection .note.stapsdt,\"?\",\"note\"\n" \
+    ".balign 4\n" \
+    ".4byte 992f-991f, 994f-993f, 3\n" \
+    "991: .asciz \"stapsdt\"\n" \
+    "992: .balign 4\n" \
+    "993: .8byte 990b\n" \
+    ".8byte _.stapsdt.base\n" \
+    ".8byte 0\n" \
+    ".asciz \"slog\"\n" \
+    ".asciz \"" SLOG_PROBE_STR(name) "\"\n" \
+    ".asciz \"" args "\"\n" \
+    "994: .balign 4\n" \
+    ".popsection\n" \
+    ".ifndef _.stapsdt.base\n" \
+    ".pushsection .stapsdt.base,\"aG\",\"progbits\",.stapsdt.base,comdat\n" \
+    ".weak _.stapsdt.base\n" \
+    ".hidden _.stapsdt.base\n" \
+    "_.stapsdt.base: .space 1\n" \
+    ".size _.stapsdt.base, 1\n" \
+    ".popsection\n" \
+    ".endif\n"
+
+#define SLOG_PROBE0(name) \
+    __asm__ __volatile__(SLOG_PROBE_NOTE_(name, ""))
+
+#define SLOG_PROBE1(name, a1) \
+    __asm__ __volatile__(SLOG_PROBE_NOTE_(name, "-8@%0") \
+        :: "nor"(::slog::detail::probe_arg(a1)))
+
+#define SLOG_PROBE2(name, a1, a2) \
+    __asm__ __volatile__(SLOG_PROBE_NOTE_(name, "-8@%0 -8@%1") \
+        :: "nor"(::slog::detail::probe_arg(a1)), "nor"(::slog::detail::probe_arg(a2)))
+
+#define SLOG_PROBE3(name, a1, a2, a3) \
+    __asm__ __volatile__(SLOG_PROBE_NOTE_(name, "-8@%0 -8@%1 -8@%2") \
+        :: "nor"(::slog::detail::probe_arg(a1)), "nor"(::slog::detail::probe_arg(a2)), \
+           "nor"(::slog::detail::probe_arg(a3)))
+
+#else
+
+#define SLOG_PROBE0(name) do {} while (0)
+#define SLOG_PROBE1(name, a1) do {} while (0)
+#define SLOG_PROBE2(name, a1, a2) do {} while (0)
+#define SLOG_PROBE3(name, a1, a2, a3) do {} while (0)
+
+#endif
+
+#endif // __SLOG_PROBES_H_
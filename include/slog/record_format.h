@@ -0,0 +1,63 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_RECORD_FORMAT_H_
+#define __SLOG_RECORD_FORMAT_H_
+
+#include <ctime>
+#include <cstddef>
+#include <slog/log_level.h>
+
+namespace slog {
+
+/**
+ * RecordFields holds the fields of a text log record in the layout
+ * written by the Logger:
+ *
+ *    [<date time>] [<pid>] [<level>] <message>
+ *
+ * The pointers refer to the parsed line, no data is copied.
+ */
+struct RecordFields {
+    std::time_t time{0};   // local time of the record, in seconds
+    long pid{0};
+    LogLevel::level_t level{LogLevel::Unknown};
+    const char *msg{nullptr};
+    size_t msg_len{0};
+};
+
+/**
+ * RecordParser parses the text log records, the counterpart of the
+ * Logger record layout for the tools reading the logs.
+ *
+ * The date time conversion is cached per hour, so a parser instance
+ * should be reused for the lines of the same file. It is not
+ * thread-safe, use one instance per thread.
+ */
+class RecordParser {
+public:
+    // Parse parses a single line of len bytes, without its line feed.
+    // Returns false if the line is not in the record layout, e.g. a
+    // continuation line of a multi-line message.
+    bool Parse(const char *line, size_t len, RecordFields& fields);
+
+    // ParseTime parses the date time field, as rendered by
+    // DateTimeDecorator, at the beginning of s.
+    bool ParseTime(const char *s, size_t len, std::time_t& t);
+
+    // ParseLevel returns the level of the given level field character.
+    static LogLevel::level_t ParseLevel(char c);
+
+private:
+    char hour_key_[14]{};      // date and hour of the cached conversion
+    std::time_t hour_time_{0}; // start of the cached hour
+}; // class RecordParser
+
+} // namespace slog
+
+#endif // __SLOG_RECORD_FORMAT_H_
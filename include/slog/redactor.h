@@ -0,0 +1,90 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_REDACTOR_H_
+#define __SLOG_REDACTOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace slog {
+
+/**
+ * RedactorOptions defines the secrets masked by a Redactor.
+ */
+struct RedactorOptions {
+    // Patterns to mask. A pattern ending with '*' masks the value that
+    // follows it, up to the next white space or one of ",;&\"'", e.g.
+    // "password=*" or "Authorization: Bearer *". Other patterns mask
+    // their own occurrences.
+    std::vector<std::string> patterns;
+
+    // Match the patterns ignoring the case of ASCII letters
+    bool ignore_case{true};
+
+    // Mask the card numbers, runs of 13 to 19 digits (optionally
+    // separated by single spaces or dashes) which pass the Luhn check.
+    // The last 4 digits are kept.
+    bool card_numbers{false};
+
+    // Character replacing the masked bytes
+    char mask{'*'};
+};
+
+/**
+ * Redactor masks the secrets in the rendered records, in place.
+ *
+ * The patterns are compiled once into an Aho-Corasick automaton over
+ * byte classes, so a record is scanned once whatever the number of
+ * patterns. The scan skips ahead 16 bytes at a time with SSE2 while
+ * there is no pair of bytes that could start a match.
+ *
+ * A Redactor is immutable once built and could be shared by targets
+ * and threads, see Target::SetRedactor().
+ */
+class Redactor {
+public:
+    // Redactor compiles the patterns, throws std::invalid_argument
+    // if a pattern is empty.
+    explicit Redactor(const RedactorOptions& options) noexcept(false);
+
+    // Redact masks the secrets in the len bytes of data. Returns the
+    // number of secrets masked.
+    size_t Redact(char *data, size_t len) const;
+
+    const RedactorOptions& Options() const {
+        return options_;
+    }
+
+private:
+    struct pattern_t {
+        size_t len;
+        bool value; // mask the value following the pattern
+    };
+
+    size_t scan_patterns(char *data, size_t len) const;
+    size_t scan_card_numbers(char *data, size_t len) const;
+    size_t next_candidate(const char *data, size_t pos, size_t len) const;
+
+    RedactorOptions options_;
+    std::vector<pattern_t> patterns_;
+    uint16_t classes_[256];        // byte to its class, 0 for the bytes of no pattern
+    size_t nclasses_{1};
+    std::vector<int32_t> delta_;   // transitions, state * nclasses_ + class
+    std::vector<int32_t> output_;  // pattern ending at each state, or -1
+    std::vector<int32_t> next_;    // next state on the suffix chain with an output, or -1
+    bool first_[256];              // bytes starting a pattern
+    std::vector<uint8_t> heads_;   // distinct first two bytes of the patterns, for
+                                   // the SIMD prefilter, case folded with 0x20
+}; // class Redactor
+
+} // namespace slog
+
+#endif // __SLOG_REDACTOR_H_
@@ -0,0 +1,71 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_ROUTER_H_
+#define __SLOG_ROUTER_H_
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <slog/log_level.h>
+#include <slog/target.h>
+
+namespace slog {
+
+/**
+ * Route sends the records of the loggers whose name starts with
+ * prefix, and which are of level or more severe, to the target,
+ * batched records included. The spans count as Info records.
+ * An empty prefix matches all the loggers.
+ */
+struct Route {
+    std::string prefix;
+    LogLevel::level_t level;
+    std::shared_ptr<Target> target;
+};
+
+/**
+ * Router holds the routes shared by all the loggers, in addition to
+ * their own targets:
+ *
+ *    // all the records of the "net.*" loggers also go to net.log
+ *    auto net = std::make_shared<FileTarget<std::mutex>>("logs/net.log", LogLevel::Trace);
+ *    Router::Instance().Add(Route{"net.", LogLevel::Trace, net});
+ *
+ * The routes are not evaluated per record: every logger compiles them
+ * into its routing table, which is rebuilt on the next log call after
+ * a change (see routing_epoch).
+ */
+class Router {
+public:
+    // Instance returns the process wide router
+    static Router& Instance();
+
+    // Add adds the route
+    void Add(Route route);
+
+    // Remove removes all the routes to the target
+    void Remove(const std::shared_ptr<Target>& target);
+
+    // Clear removes all the routes
+    void Clear();
+
+    // Match returns the routes matching the logger name
+    std::vector<Route> Match(const std::string& name) const;
+
+private:
+    Router() = default;
+
+    mutable std::mutex mutex_;
+    std::vector<Route> routes_;
+}; // class Router
+
+} // namespace slog
+
+#endif // __SLOG_ROUTER_H_
@@ -0,0 +1,217 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_SHARDED_FILE_TARGET_H_
+#define __SLOG_SHARDED_FILE_TARGET_H_
+
+#include <unistd.h>
+#include <ctime>
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <utility>
+#include <slog/target.h>
+#include <slog/utils.h>
+#include <slog/thread_context.h>
+#include <slog/file_exception.h>
+
+namespace slog {
+
+namespace sharding {
+
+// Every record in a shard file is prefixed with its wall clock time
+// in nanoseconds since the epoch, as a zero padded decimal number of
+// prefix_digits digits followed by a space. slog-merge uses it to
+// merge the shards back into one ordered stream.
+const size_t prefix_digits = 19;
+const size_t prefix_size = prefix_digits + 1;
+
+// timestamp returns the current wall clock time in nanoseconds.
+inline uint64_t timestamp() {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+}
+
+// render_prefix writes the record prefix of the given timestamp
+// into buf, which must hold at least prefix_size bytes.
+inline void render_prefix(char *buf, uint64_t ns) {
+    for (size_t i = prefix_digits; i > 0; i--) {
+        buf[i-1] = static_cast<char>('0' + ns % 10);
+        ns /= 10;
+    }
+    buf[prefix_digits] = ' ';
+}
+
+// parse_prefix parses the record prefix at the beginning of the line
+// of len bytes. Returns false if the line does not start with a prefix,
+// as for the continuation lines of a multi-line record.
+inline bool parse_prefix(const char *line, size_t len, uint64_t& ns) {
+    if (len < prefix_size || line[prefix_digits] != ' ') return false;
+    uint64_t v = 0;
+    for (size_t i = 0; i < prefix_digits; i++) {
+        if (line[i] < '0' || line[i] > '9') return false;
+        v = v * 10 + (line[i] - '0');
+    }
+    ns = v;
+    return true;
+}
+
+} // namespace sharding
+
+/**
+ * ShardedFileTarget logs into one segment file per writer thread,
+ * named "<file_name>.<tid>", so that writes need no cross-thread
+ * locking. Each record is prefixed with a high resolution timestamp
+ * (see sharding::render_prefix), the slog-merge tool merges the
+ * shards back into a single ordered log.
+ *
+ * A shard stays open until the target is destroyed, even if its
+ * thread exits earlier.
+ */
+class ShardedFileTarget : public Target {
+public:
+    explicit ShardedFileTarget(const std::string& file_name, LogLevel::level_t lvl = LogLevel::Debug) noexcept(false)
+        : Target(lvl), file_name_(file_name), id_(next_id()) {
+        if (utils::is_symlink(file_name_)) {
+            throw FileException{file_name_, "Log file cannot be a symbolic link", true};
+        }
+        if (!utils::ensure_directory_path(utils::dirname(file_name_))) {
+            throw FileException{file_name_, "Failed to create log directory"};
+        }
+    }
+
+    // Do not support copying/assigning objects
+    ShardedFileTarget(const ShardedFileTarget &) = delete;
+    ShardedFileTarget &operator=(const ShardedFileTarget &) = delete;
+
+    virtual ~ShardedFileTarget() {
+        std::lock_guard<std::mutex> lock(shards_mtx_);
+        for (auto &s : shards_) {
+            fclose(s.second);
+        }
+        shards_.clear();
+    }
+
+    const std::string& FileName() const {
+        return file_name_;
+    }
+
+    // Shards returns the paths of the shard files opened so far.
+    std::vector<std::string> Shards() {
+        std::lock_guard<std::mutex> lock(shards_mtx_);
+        std::vector<std::string> paths;
+        for (auto &s : shards_) {
+            paths.push_back(s.first);
+        }
+        return paths;
+    }
+
+    // CachedShards returns the number of shards cached by the calling
+    // thread, the entries of the destroyed targets are dropped when the
+    // thread opens a new shard.
+    static size_t CachedShards() {
+        return cache().size();
+    }
+
+protected:
+    bool log(const std::string& frmt, va_list args) override {
+        FILE *fp = shard();
+        if (!fp) return false;
+        char prefix[sharding::prefix_size];
+        sharding::render_prefix(prefix, sharding::timestamp());
+        fwrite(prefix, 1, sizeof(prefix), fp);
+        if (vfprintf(fp, frmt.c_str(), args) < 0) {
+            return false;
+        }
+        if (frmt.empty() || frmt[frmt.size()-1] != '\n') {
+            fwrite("\n", 1, 1, fp);
+        }
+        return true;
+    }
+
+    bool write(LogLevel::level_t, const char *msg, size_t len) override {
+        FILE *fp = shard();
+        if (!fp) return false;
+        char prefix[sharding::prefix_size];
+        sharding::render_prefix(prefix, sharding::timestamp());
+        fwrite(prefix, 1, sizeof(prefix), fp);
+        if (fwrite(msg, 1, len, fp) != len) {
+            return false;
+        }
+        if (len == 0 || msg[len-1] != '\n') {
+            fwrite("\n", 1, 1, fp);
+        }
+        return true;
+    }
+
+    void flush() override {
+        std::lock_guard<std::mutex> lock(shards_mtx_);
+        for (auto &s : shards_) {
+            ::fflush(s.second);
+        }
+    }
+
+private:
+    static uint64_t next_id() {
+        static std::atomic<uint64_t> id{0};
+        return ++id;
+    }
+
+    struct cache_entry_t {
+        uint64_t id;                     // of the target
+        FILE *fp;
+        std::weak_ptr<const char> alive; // expires with the target
+    };
+
+    static std::vector<cache_entry_t>& cache() {
+        static thread_local std::vector<cache_entry_t> entries;
+        return entries;
+    }
+
+    // shard returns the calling thread's shard of this target, opening
+    // it on first use. The lookup is served from a thread local cache,
+    // keyed by the unique target id rather than its address, so that
+    // a new target never picks up a stale entry of a destroyed one.
+    FILE *shard() {
+        auto &entries = cache();
+        for (auto &e : entries) {
+            if (e.id == id_) return e.fp;
+        }
+        // drop the entries of the destroyed targets
+        for (auto it = entries.begin(); it != entries.end(); ) {
+            it = it->alive.expired() ? entries.erase(it) : it + 1;
+        }
+
+        std::string path = file_name_ + "." +
+            std::to_string(static_cast<long>(ThreadContext::Current().Tid()));
+        if (utils::is_symlink(path)) return nullptr;
+        FILE *fp = fopen(path.c_str(), "ab");
+        if (!fp) return nullptr;
+        {
+            std::lock_guard<std::mutex> lock(shards_mtx_);
+            shards_.emplace_back(path, fp);
+        }
+        entries.push_back(cache_entry_t{id_, fp, alive_});
+        return fp;
+    }
+
+    std::string file_name_;
+    const uint64_t id_;
+    std::mutex shards_mtx_; // protects shards_, taken only when a thread opens its shard
+    std::vector<std::pair<std::string, FILE *> > shards_;
+    std::shared_ptr<const char> alive_{std::make_shared<const char>(0)};
+}; // class ShardedFileTarget
+
+} // namespace slog
+
+#endif // __SLOG_SHARDED_FILE_TARGET_H_
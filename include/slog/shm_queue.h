@@ -0,0 +1,175 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_SHM_QUEUE_H_
+#define __SLOG_SHM_QUEUE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <functional>
+#include <slog/log_level.h>
+#include <slog/target.h>
+
+namespace slog {
+
+/**
+ * ShmQueue is a bounded, lock-free, multi-producer single-consumer
+ * ring of fixed size record slots placed in a POSIX shared memory
+ * object (shm_open + mmap).
+ *
+ * Any number of processes (and threads) could open the same queue by
+ * name and push records into it. Exactly one collector per queue is
+ * expected to drain them (see ShmCollector) to the real targets.
+ *
+ * Slots are claimed by advancing a shared ticket counter, the slot is
+ * published by bumping its sequence number once the record is copied.
+ * A producer records its pid in the slot before it moves the ticket
+ * counter past it, so that a producer that dies between claiming and
+ * publishing a slot does not wedge the queue: the collector detects the
+ * dead owner and skips the slot, and the other producers take over a
+ * slot whose owner died before moving the counter. It also skips the slot of a producer stalled for longer than
+ * the stale timeout, but holds it until the producer commits late or
+ * exits, as the producer could still write into it; the producers
+ * drop their records once they wrap around to a held slot.
+ *
+ * Records longer than the slot size are truncated.
+ */
+class ShmQueue {
+public:
+    static const uint32_t DefaultSlots = 4096;
+    static const uint32_t DefaultSlotSize = 512;
+
+    // Opens the named shared memory queue, creates a new one with the
+    // given geometry if it does not exist yet. When the queue already
+    // exists its own geometry is used and slots/slot_size are ignored.
+    //
+    // Throws a FileException if the shared memory object could not be
+    // created or mapped.
+    explicit ShmQueue(const std::string& name, uint32_t slots = DefaultSlots,
+                      uint32_t slot_size = DefaultSlotSize) noexcept(false);
+    ~ShmQueue();
+
+    // Do not support copying/assigning objects
+    ShmQueue(const ShmQueue &) = delete;
+    ShmQueue &operator=(const ShmQueue &) = delete;
+
+    // Unlink removes the named queue from the system. Processes which
+    // still have it mapped could continue to use it.
+    static bool Unlink(const std::string& name);
+
+    const std::string& Name() const { return name_; }
+    uint32_t Capacity() const;
+    uint32_t SlotSize() const;
+
+    /**
+     * Producer interface
+    */
+
+    // Claim reserves the next free slot and returns its payload buffer
+    // of SlotSize() bytes, or nullptr if the queue is full. The claimed
+    // slot must be published with Commit() using the returned ticket.
+    char *Claim(uint64_t& ticket);
+
+    // Commit publishes the claimed slot with a record of len bytes.
+    // Returns false if the collector had already given up on the slot.
+    bool Commit(uint64_t ticket, LogLevel::level_t level, size_t len);
+
+    // Push copies the message into the next free slot.
+    // Returns false if the queue is full and the record is dropped.
+    bool Push(LogLevel::level_t level, const char *msg, size_t len);
+
+    /**
+     * Consumer interface, must be used by only one collector at a time.
+    */
+
+    using drain_fn_t = std::function<void(LogLevel::level_t, const char *, size_t)>;
+
+    // Drain passes at most max published records in order to fn,
+    // and returns the number of records drained.
+    size_t Drain(const drain_fn_t& fn, size_t max = SIZE_MAX);
+
+    // SetStaleTimeout sets how long the collector waits on a claimed
+    // but unpublished slot whose owner still looks alive, before it
+    // skips the slot.
+    void SetStaleTimeout(std::chrono::milliseconds timeout) {
+        stale_timeout_ = timeout;
+    }
+
+    // Dropped returns the number of records dropped as the queue was full.
+    uint64_t Dropped() const;
+
+    // Abandoned returns the number of slots skipped by the collector
+    // because their producers died (or stalled) before publishing.
+    uint64_t Abandoned() const;
+
+private:
+    struct header_t;
+    struct slot_t;
+
+    void unmap();
+    slot_t *slot_at(uint64_t ticket) const;
+    bool owner_gone(const slot_t *slot) const;
+    bool stalled(uint64_t ticket);
+
+    std::string name_;
+    int fd_{-1};
+    void *base_{nullptr};
+    size_t size_{0};
+    header_t *header_{nullptr};
+    size_t stride_{0};
+
+    // collector-side stall tracking
+    uint64_t stall_ticket_{UINT64_MAX};
+    std::chrono::steady_clock::time_point stall_since_;
+    std::chrono::milliseconds stale_timeout_{1000};
+}; // class ShmQueue
+
+/**
+ * ShmCollector drains a ShmQueue on a background thread and writes
+ * the records to the given targets.
+ */
+class ShmCollector {
+public:
+    ShmCollector(std::shared_ptr<ShmQueue> queue,
+                 std::vector<std::shared_ptr<Target> > targets,
+                 std::chrono::milliseconds poll_interval = std::chrono::milliseconds(1));
+    ~ShmCollector();
+
+    // Do not support copying/assigning objects
+    ShmCollector(const ShmCollector &) = delete;
+    ShmCollector &operator=(const ShmCollector &) = delete;
+
+    // Start launches the collector thread.
+    void Start();
+
+    // Stop drains the remaining records, flushes the targets and
+    // stops the collector thread.
+    void Stop();
+
+    // DrainOnce writes all currently published records to the targets
+    // on the calling thread. Must not be used while the thread runs.
+    size_t DrainOnce();
+
+private:
+    void run();
+
+    std::shared_ptr<ShmQueue> queue_;
+    std::vector<std::shared_ptr<Target> > targets_;
+    std::chrono::milliseconds poll_interval_;
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+}; // class ShmCollector
+
+} // namespace slog
+
+#endif // __SLOG_SHM_QUEUE_H_
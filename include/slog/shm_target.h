@@ -0,0 +1,77 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_SHM_TARGET_H_
+#define __SLOG_SHM_TARGET_H_
+
+#include <string>
+#include <memory>
+#include <cstdio>
+#include <cstring>
+#include <slog/target.h>
+#include <slog/shm_queue.h>
+
+namespace slog {
+
+/**
+ * ShmTarget writes the log records into a shared memory queue instead
+ * of a file, so that many processes could share the same log file
+ * without contending on it: a single collector (ShmCollector, or the
+ * slog-collector tool) drains the queue to the real targets.
+ *
+ * ShmTarget is lock-free and needs no mutex. Records are dropped, and
+ * Log()/Write() return false, when the queue is full.
+ *
+ * NOTE: Records written through Log() do not carry their level,
+ * so they are never filtered out by the collector targets.
+ */
+class ShmTarget: public Target {
+public:
+    explicit ShmTarget(std::shared_ptr<ShmQueue> queue, LogLevel::level_t lvl = LogLevel::Debug)
+        : Target(lvl), queue_(std::move(queue)) {}
+
+    explicit ShmTarget(const std::string& queue_name, LogLevel::level_t lvl = LogLevel::Debug) noexcept(false)
+        : ShmTarget(std::make_shared<ShmQueue>(queue_name), lvl) {}
+
+    // Do not support copying/assigning objects
+    ShmTarget(const ShmTarget &) = delete;
+    ShmTarget &operator=(const ShmTarget &) = delete;
+
+    const std::shared_ptr<ShmQueue>& Queue() const {
+        return queue_;
+    }
+
+protected:
+    bool log(const std::string& frmt, va_list args) override {
+        uint64_t ticket;
+        char *slot = queue_->Claim(ticket);
+        if (!slot) return false;
+        // format straight into the shared memory slot
+        auto res = vsnprintf(slot, queue_->SlotSize(), frmt.c_str(), args);
+        size_t len = res < 0 ? 0 : static_cast<size_t>(res);
+        if (len >= queue_->SlotSize()) {
+            // truncated, vsnprintf() used the last byte for '\0'
+            len = queue_->SlotSize() - 1;
+        }
+        return queue_->Commit(ticket, LogLevel::None, len);
+    }
+
+    bool write(LogLevel::level_t level, const char *msg, size_t len) override {
+        return queue_->Push(level, msg, len);
+    }
+
+    // records are visible to the collector as soon as they are committed
+    void flush() override {}
+
+private:
+    std::shared_ptr<ShmQueue> queue_;
+}; // class ShmTarget
+
+} // namespace slog
+
+#endif // __SLOG_SHM_TARGET_H_
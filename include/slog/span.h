@@ -0,0 +1,189 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_SPAN_H_
+#define __SLOG_SPAN_H_
+
+#include <sys/types.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace slog {
+
+/**
+ * SpanEvent is a completed span: a named, timed scope of a thread.
+ * Times are nanoseconds of the monotonic (steady) clock.
+ */
+struct SpanEvent {
+    const char *name; // must outlive the span, usually a string literal
+    int64_t start;
+    int64_t duration;
+    pid_t pid;
+    pid_t tid;
+};
+
+// monotonic_ns returns the current time of the monotonic clock
+inline int64_t monotonic_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * SpanCollector buffers the completed spans per thread and hands them
+ * over to its sink in bulk: when the buffer of a thread fills up, and
+ * on Drain().
+ *
+ * Recording a span does not lock, each thread writes into its own
+ * single-producer ring buffer. The rings are drained under a mutex.
+ */
+class SpanCollector {
+public:
+    using sink_t = std::function<void(const SpanEvent *events, size_t n)>;
+
+    // Number of spans buffered per thread, a power of two
+    static const size_t BufferSize = 512;
+
+    explicit SpanCollector(sink_t sink);
+
+    // Do not support copying/assigning objects
+    SpanCollector(const SpanCollector &) = delete;
+    SpanCollector &operator=(const SpanCollector &) = delete;
+
+    // Add records a completed span of the calling thread
+    void Add(const char *name, int64_t start, int64_t duration) {
+        buffer_t *b = local();
+        size_t head = b->head.load(std::memory_order_relaxed);
+        if (head - b->tail.load(std::memory_order_acquire) == BufferSize) {
+            drain_full(b);
+        }
+        SpanEvent &e = b->events[head & (BufferSize - 1)];
+        e.name = name;
+        e.start = start;
+        e.duration = duration;
+        e.pid = b->pid;
+        e.tid = b->tid;
+        b->head.store(head + 1, std::memory_order_release);
+    }
+
+    // Drain hands the spans buffered by all the threads to the sink
+    void Drain();
+
+    // CachedBuffers returns the number of collector buffers held by
+    // the calling thread, the buffers of the destroyed collectors are
+    // released when the thread uses a new collector.
+    static size_t CachedBuffers() {
+        return cache().size();
+    }
+
+private:
+    struct buffer_t {
+        SpanEvent events[BufferSize];
+        std::atomic<size_t> head{0}; // written by the owner thread
+        std::atomic<size_t> tail{0}; // written under the collector mutex
+        pid_t pid;
+        pid_t tid;
+    };
+
+    struct cache_entry_t {
+        uint64_t id;                     // of the collector
+        std::shared_ptr<buffer_t> buffer;
+        std::weak_ptr<const char> alive; // expires with the collector
+    };
+
+    static std::vector<cache_entry_t>& cache() {
+        static thread_local std::vector<cache_entry_t> entries;
+        return entries;
+    }
+
+    // local returns the calling thread's buffer of this collector. The
+    // lookup is served from a thread local cache, keyed by the unique
+    // collector id rather than its address.
+    buffer_t *local() {
+        auto &entries = cache();
+        for (auto &e : entries) {
+            if (e.id == id_) return e.buffer.get();
+        }
+        // release the buffers of the destroyed collectors
+        for (auto it = entries.begin(); it != entries.end(); ) {
+            it = it->alive.expired() ? entries.erase(it) : it + 1;
+        }
+        entries.push_back(cache_entry_t{id_, make_buffer(), alive_});
+        return entries.back().buffer.get();
+    }
+
+    std::shared_ptr<buffer_t> make_buffer();
+    void drain_full(buffer_t *b);
+    void drain(buffer_t *b);
+
+    sink_t sink_;
+    uint64_t id_;
+    std::mutex mutex_; // protects buffers_ and serializes the drains
+    std::vector<std::shared_ptr<buffer_t> > buffers_;
+    std::shared_ptr<const char> alive_{std::make_shared<const char>(0)};
+}; // class SpanCollector
+
+/**
+ * Span times the scope it lives in and reports it to the logger when
+ * it ends, use it through the SLOG_SPAN macro:
+ *
+ *    void handle(Request& r) {
+ *        SLOG_SPAN(log, "handle");
+ *        ...
+ *    }
+ */
+template <typename LoggerT>
+class Span {
+public:
+    Span(LoggerT& logger, const char *name)
+        : logger_(&logger), name_(name), start_(monotonic_ns()) {}
+
+    Span(Span&& other)
+        : logger_(other.logger_), name_(other.name_), start_(other.start_) {
+        other.logger_ = nullptr;
+    }
+
+    // Do not support copying/assigning objects
+    Span(const Span &) = delete;
+    Span &operator=(const Span &) = delete;
+
+    ~Span() {
+        if (logger_) logger_->end_span(name_, start_, monotonic_ns());
+    }
+
+private:
+    LoggerT *logger_;
+    const char *name_;
+    int64_t start_;
+}; // class Span
+
+template <typename LoggerT>
+Span<LoggerT> make_span(LoggerT& logger, const char *name) {
+    return Span<LoggerT>(logger, name);
+}
+
+} // namespace slog
+
+#define SLOG_CONCAT_(a, b) a##b
+#define SLOG_CONCAT(a, b) SLOG_CONCAT_(a, b)
+
+// SLOG_SPAN times the enclosing scope as a span of the logger.
+// Spans are compiled out when SLOG_DISABLE_SPANS is defined.
+#ifdef SLOG_DISABLE_SPANS
+#define SLOG_SPAN(logger, name) ((void)0)
+#else
+#define SLOG_SPAN(logger, name) \
+    auto SLOG_CONCAT(slog_span_, __LINE__) = ::slog::make_span(logger, name)
+#endif
+
+#endif // __SLOG_SPAN_H_
@@ -0,0 +1,123 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_SPILL_BUFFER_H_
+#define __SLOG_SPILL_BUFFER_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <slog/log_level.h>
+#include <slog/memory.h>
+
+namespace slog {
+
+/**
+ * SpillBuffer holds the records which could not be written to a file,
+ * up to a number of bytes, and replays them in order from a background
+ * thread, retrying with an exponential backoff (see FileOptions::spill).
+ *
+ * The replay function is called on the retry thread. It writes the
+ * records with Drain(), and returns false if the file could still not
+ * be written. While the buffer is Active() the new records of the file
+ * must be added to it, to keep them in order.
+ */
+class SpillBuffer {
+public:
+    // write_fn_t writes a spilled record, returns false on failure
+    using write_fn_t = std::function<bool(LogLevel::level_t, const char *, size_t)>;
+
+    SpillBuffer(size_t capacity, std::function<bool()> replay,
+                std::chrono::milliseconds min_backoff = std::chrono::milliseconds(10),
+                std::chrono::milliseconds max_backoff = std::chrono::milliseconds(1000),
+                MemoryResource *memory = nullptr);
+    ~SpillBuffer();
+
+    // Do not support copying/assigning objects
+    SpillBuffer(const SpillBuffer &) = delete;
+    SpillBuffer &operator=(const SpillBuffer &) = delete;
+
+    // Add appends a copy of the record and activates the buffer. Returns
+    // false if the record is dropped, as it does not fit into the capacity.
+    bool Add(LogLevel::level_t level, const char *msg, size_t len);
+
+    // Active returns if there are spilled records waiting to be replayed
+    bool Active() const {
+        return active_.load(std::memory_order_acquire);
+    }
+
+    // Drain writes the spilled records with write_fn, oldest first, until
+    // the buffer is empty or a write fails. The failed record is kept.
+    // Returns false on failure.
+    bool Drain(const write_fn_t& write_fn);
+
+    // Stop stops the retry thread, waiting for a running replay
+    void Stop();
+
+    // Spilled returns the number of records added, Replayed the number
+    // of records written by Drain(), and Dropped the number of records
+    // and DroppedBytes their bytes that did not fit.
+    uint64_t Spilled() const {
+        return spilled_.load(std::memory_order_relaxed);
+    }
+
+    uint64_t Replayed() const {
+        return replayed_.load(std::memory_order_relaxed);
+    }
+
+    uint64_t Dropped() const {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+    uint64_t DroppedBytes() const {
+        return dropped_bytes_.load(std::memory_order_relaxed);
+    }
+
+    // Retries returns the number of replays that failed
+    uint64_t Retries() const {
+        return retries_.load(std::memory_order_relaxed);
+    }
+
+    // Bytes returns the number of bytes of the spilled records
+    size_t Bytes() const;
+
+private:
+    struct record_t {
+        LogLevel::level_t level;
+        MemoryBuffer data;
+    };
+
+    void run();
+
+    size_t capacity_;
+    std::function<bool()> replay_;
+    std::chrono::milliseconds min_backoff_;
+    std::chrono::milliseconds max_backoff_;
+    MemoryResource *memory_;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<record_t> records_;
+    size_t bytes_{0};         // bytes of records_, and of the record being replayed
+    bool stop_{false};
+    std::atomic<bool> active_{false};
+    std::atomic<uint64_t> spilled_{0};
+    std::atomic<uint64_t> replayed_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> dropped_bytes_{0};
+    std::atomic<uint64_t> retries_{0};
+    std::thread thread_;
+}; // class SpillBuffer
+
+} // namespace slog
+
+#endif // __SLOG_SPILL_BUFFER_H_
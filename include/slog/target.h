@@ -12,10 +12,120 @@
 #include <cstdarg>
 #include <stdarg.h>
 #include <string>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <chrono>
+#include <sys/uio.h>
 #include <slog/log_level.h>
+#include <slog/flush_timer.h>
+#include <slog/redactor.h>
+#include <slog/memory.h>
+#include <slog/governor.h>
+#include <slog/probes.h>
+#include <memory>
 
 namespace slog {
 
+struct SpanEvent;
+
+// routing_epoch is incremented on every change which invalidates the
+// routing tables of the loggers: target levels, logger levels, targets
+// and routes. The loggers rebuild their table when it changes.
+extern std::atomic<uint64_t> routing_epoch;
+
+/**
+ * FlushPolicy defines when a target flushes its buffered records,
+ * in addition to the explicit Flush() calls. All the conditions
+ * are disabled by default.
+ */
+struct FlushPolicy {
+    // Flush after every record of this level or more severe,
+    // e.g. LogLevel::Error flushes after errors and critical records.
+    LogLevel::level_t level{LogLevel::None};
+
+    // Flush after every `every` records.
+    size_t every{0};
+
+    // Flush every `interval` from the background FlushTimer thread.
+    std::chrono::milliseconds interval{0};
+
+    // Make the records durable on the policy flushes, i.e. Sync()
+    // instead of Flush() the target.
+    bool sync{false};
+};
+
+/**
+ * RecordBatch is a group of rendered records, which are written
+ * to the targets as a whole (see Target::WriteBatch).
+ */
+class RecordBatch {
+public:
+    struct entry_t {
+        LogLevel::level_t level;
+        size_t offset; // offset of the record in Data()
+        size_t len;
+    };
+
+    // RecordBatch creates a batch allocating from the given resource
+    explicit RecordBatch(MemoryResource *memory = nullptr)
+        : data_(Allocator<char>(memory)), entries_(Allocator<entry_t>(memory)) {}
+
+    // Add appends a copy of the record to the batch. Returns false
+    // if the memory resource refused to grow the batch.
+    bool Add(LogLevel::level_t level, const char *msg, size_t len) {
+        size_t size = data_.size();
+        try {
+            data_.append(msg, len);
+            entries_.push_back(entry_t{level, size, len});
+        } catch (const std::bad_alloc&) {
+            data_.resize(size);
+            return false;
+        }
+        return true;
+    }
+
+    // Assign replaces the records with those of other up to max_level,
+    // e.g. the records a route accepts. Returns false if the memory
+    // resource refused to grow the batch.
+    bool Assign(const RecordBatch& other, LogLevel::level_t max_level = LogLevel::Trace) {
+        Clear();
+        for (auto &e : other.entries_) {
+            if (LogLevel{e.level} > LogLevel{max_level}) continue;
+            if (!Add(e.level, other.data_.data() + e.offset, e.len)) return false;
+        }
+        return true;
+    }
+
+    void Clear() {
+        data_.clear();
+        entries_.clear();
+    }
+
+    bool Empty() const {
+        return entries_.empty();
+    }
+
+    // Redact masks the secrets of every record of the batch in place
+    void Redact(const Redactor& redactor) {
+        for (auto &e : entries_) {
+            redactor.Redact(&data_[e.offset], e.len);
+        }
+    }
+
+    const std::vector<entry_t, Allocator<entry_t> >& Entries() const {
+        return entries_;
+    }
+
+    const char *Data() const {
+        return data_.data();
+    }
+
+private:
+    MemoryBuffer data_;
+    std::vector<entry_t, Allocator<entry_t> > entries_;
+}; // class RecordBatch
+
 /**
  * Target is the base class for implementing logging targets
  * 
@@ -24,12 +134,19 @@ namespace slog {
  *
  *  void log(const string& msg): write the message to target buffer.
  *  void flush():  flush target buffer.
+ *
+ * Targets could optionally override write() to consume the already
+ * rendered records handed over by the Logger, instead of formatting
+ * them again, write_iov() to write a record made of several parts, and
+ * write_batch() to write a group of records at once.
 */
 class Target {
 public:
     explicit Target(LogLevel lvl): level_(lvl) {}
     Target() = default;
-    virtual ~Target() = default;
+    virtual ~Target() {
+        cancel_flush_timer();
+    }
    
     // GetLogLevel returns the current log level used by this target
     const LogLevel& GetLogLevel() const  {
@@ -39,6 +156,8 @@ public:
     // SetLogLevel update the target log level
     void SetLogLevel(const LogLevel& level) {
         level_ = level;
+        if (governor_) governor_->SetLevel(level_.Get());
+        routing_epoch.fetch_add(1, std::memory_order_release);
     }
 
     // ShouldLog returns if the messages with the given log level
@@ -48,20 +167,142 @@ public:
     }
 
     bool Log(LogLevel::level_t level, const std::string& fmt, ...) {
+        SLOG_PROBE3(target_enter, this, level, 0);
         if (!this->ShouldLog(level)) {
             // do nothing if specified log level is not enabled by this target
             return true;
         }
+        SLOG_PROBE3(target_accept, this, level, 0);
 
         va_list args;
         va_start(args, fmt);
-        auto res = this->log(fmt, args);
+        auto res = governed(level, [&]() { return this->log(fmt, args); });
         va_end(args);
+        apply_flush_policy(level);
+        return res;
+    }
+
+    // Write logs an already rendered message of len bytes. Unlike Log(),
+    // the message is not treated as a format string.
+    bool Write(LogLevel::level_t level, const char *msg, size_t len) {
+        SLOG_PROBE3(target_enter, this, level, len);
+        if (!this->ShouldLog(level)) {
+            return true;
+        }
+        SLOG_PROBE3(target_accept, this, level, len);
+        auto res = governed(level, [&]() { return this->write(level, msg, len); });
+        apply_flush_policy(level);
+        return res;
+    }
+
+    // WriteIov logs an already rendered message made of iovcnt parts,
+    // e.g. a record followed by a payload (see BasicLogger::LogPayload).
+    bool WriteIov(LogLevel::level_t level, const struct iovec *iov, int iovcnt) {
+        SLOG_PROBE3(target_enter, this, level, iov_bytes(iov, iovcnt));
+        if (!this->ShouldLog(level)) {
+            return true;
+        }
+        SLOG_PROBE3(target_accept, this, level, iov_bytes(iov, iovcnt));
+        auto res = governed(level, [&]() { return this->write_iov(level, iov, iovcnt); });
+        apply_flush_policy(level);
+        return res;
+    }
+
+    // WriteBatch writes the records of the batch that should be logged,
+    // targets that support it write them as one contiguous group.
+    bool WriteBatch(const RecordBatch& batch) {
+        // the flush policy applies once, for the most severe record
+        LogLevel::level_t severest = LogLevel::Max;
+        for (auto &e : batch.Entries()) {
+            SLOG_PROBE3(target_enter, this, e.level, e.len);
+            if (!this->ShouldLog(e.level)) continue;
+            SLOG_PROBE3(target_accept, this, e.level, e.len);
+            if (governor_ && !governor_->Admits(e.level)) {
+                governor_->Shed(e.level);
+            } else if (e.level < severest) {
+                severest = e.level;
+            }
+        }
+        if (severest == LogLevel::Max) {
+            return true;
+        }
+        auto res = governed(severest, [&]() { return this->write_batch(batch); });
+        apply_flush_policy(severest);
         return res;
     }
 
+    // WriteSpans writes completed spans (see SLOG_SPAN), targets
+    // which do not support spans ignore them.
+    bool WriteSpans(const SpanEvent *events, size_t n) {
+        return this->write_spans(events, n);
+    }
+
     void Flush() {
+        SLOG_PROBE1(flush_begin, this);
         this->flush();
+        SLOG_PROBE1(flush_end, this);
+    }
+
+    // Sync flushes the target and makes the records written so far
+    // durable, for targets that support it. Returns false on failure.
+    bool Sync() {
+        return this->sync();
+    }
+
+    // SetFlushPolicy updates the target flush policy
+    void SetFlushPolicy(const FlushPolicy& policy) {
+        flush_level_.store(policy.level, std::memory_order_relaxed);
+        flush_every_.store(policy.every, std::memory_order_relaxed);
+        flush_sync_.store(policy.sync, std::memory_order_relaxed);
+        flush_interval_.store(policy.interval.count(), std::memory_order_relaxed);
+        if (policy.interval.count() > 0) {
+            FlushTimer::Instance().Register(this, policy.interval);
+        } else {
+            FlushTimer::Instance().Unregister(this);
+        }
+    }
+
+    // GetFlushPolicy returns a copy of the target flush policy, which
+    // could be updated while logging from other threads.
+    FlushPolicy GetFlushPolicy() const {
+        FlushPolicy policy;
+        policy.level = flush_level_.load(std::memory_order_relaxed);
+        policy.every = flush_every_.load(std::memory_order_relaxed);
+        policy.sync = flush_sync_.load(std::memory_order_relaxed);
+        policy.interval = std::chrono::milliseconds(flush_interval_.load(std::memory_order_relaxed));
+        return policy;
+    }
+
+    // SetRedactor makes the logger mask the secrets in the records before
+    // they reach this target, a null redactor disables the masking.
+    // Targets sharing a redactor are served with a single pass.
+    void SetRedactor(std::shared_ptr<const Redactor> redactor) {
+        redactor_ = std::move(redactor);
+        routing_epoch.fetch_add(1, std::memory_order_release);
+    }
+
+    const std::shared_ptr<const Redactor>& GetRedactor() const {
+        return redactor_;
+    }
+
+    // SetGovernor makes the target shed its least severe records while
+    // writing to it is slow, a null governor disables the shedding.
+    // It should be set before logging to the target.
+    void SetGovernor(std::shared_ptr<Governor> governor) {
+        governor_ = std::move(governor);
+        if (governor_) governor_->SetLevel(level_.Get());
+    }
+
+    const std::shared_ptr<Governor>& GetGovernor() const {
+        return governor_;
+    }
+
+    // Memory returns the memory resource of the target buffers,
+    // nullptr for the default one. The loggers drop their least
+    // severe records while it is a MemoryAccount under pressure.
+    virtual const std::shared_ptr<MemoryResource>& Memory() const {
+        static const std::shared_ptr<MemoryResource> none;
+        return none;
     }
 
 protected:
@@ -74,11 +315,144 @@ protected:
      * flush the target stream
     */
     virtual void flush() = 0;
+    /**
+     * make the records written so far durable. The default
+     * implementation only flushes the target stream.
+    */
+    virtual bool sync() {
+        this->flush();
+        return true;
+    }
+    /**
+     * write the rendered message to the target stream.
+     * The default implementation passes the message through log(),
+     * targets are encouraged to override it with a cheaper path.
+    */
+    virtual bool write(LogLevel::level_t level, const char *msg, size_t len) {
+        (void)level;
+        return log_args("%.*s", static_cast<int>(len), msg);
+    }
+    /**
+     * write the message made of the given parts. The default implementation
+     * joins the parts and passes them to write(), targets that could write
+     * the parts from where they are (e.g. with writev()) should override it.
+    */
+    virtual bool write_iov(LogLevel::level_t level, const struct iovec *iov, int iovcnt) {
+        static thread_local std::string joined;
+        joined.clear();
+        for (int i = 0; i < iovcnt; i++) {
+            joined.append(static_cast<const char *>(iov[i].iov_base), iov[i].iov_len);
+        }
+        return this->write(level, joined.data(), joined.size());
+    }
+    /**
+     * write the completed spans, ignored by default.
+    */
+    virtual bool write_spans(const SpanEvent *, size_t) {
+        return true;
+    }
+    /**
+     * write the records of the batch that should be logged. The default
+     * implementation writes them one by one with write().
+    */
+    virtual bool write_batch(const RecordBatch& batch) {
+        bool res = true;
+        for (auto &e : batch.Entries()) {
+            if (!this->admits(e.level)) continue;
+            res = this->write(e.level, batch.Data() + e.offset, e.len) && res;
+        }
+        return res;
+    }
 
     // Target specific log level.
     // This allows say, to log all warnings to one target, say stdout
     // and all traces to other target(file) etc.,.
     LogLevel level_{LogLevel::None};
+
+    // admits returns if the records of the given level are written,
+    // i.e. enabled by the target level and not shed by the governor.
+    bool admits(LogLevel::level_t level) const {
+        return level <= level_.Get() && (!governor_ || governor_->Admits(level));
+    }
+
+    // governor returns the target governor, nullptr if there is none.
+    // Targets with a lock report the time spent waiting for it.
+    Governor *governor() const {
+        return governor_.get();
+    }
+
+    // cancel_flush_timer stops the periodic flushes of the target.
+    // Targets which release their stream before the Target destructor
+    // runs must call it first, so that the timer never flushes a
+    // target that is half way destroyed.
+    void cancel_flush_timer() {
+        if (flush_interval_.exchange(0, std::memory_order_relaxed) > 0) {
+            FlushTimer::Instance().Unregister(this);
+        }
+    }
+
+private:
+    void apply_flush_policy(LogLevel::level_t level) {
+        auto flush_level = flush_level_.load(std::memory_order_relaxed);
+        auto every = flush_every_.load(std::memory_order_relaxed);
+        if ((flush_level != LogLevel::None && level != LogLevel::None && level <= flush_level) ||
+            (every && (flush_count_.fetch_add(1, std::memory_order_relaxed) + 1) % every == 0)) {
+            if (flush_sync_.load(std::memory_order_relaxed)) {
+                this->sync();
+            } else {
+                this->flush();
+            }
+        }
+    }
+
+    // governed writes a record of the given level with write_fn, unless
+    // the governor sheds it, and reports the write latency to it.
+    template<typename WriteFn>
+    bool governed(LogLevel::level_t level, WriteFn write_fn) {
+        Governor *g = governor_.get();
+        if (!g) {
+            return write_fn();
+        }
+        if (!g->Admits(level)) {
+            g->Shed(level);
+            return true;
+        }
+        auto start = std::chrono::steady_clock::now();
+        auto res = write_fn();
+        g->Record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+        if (g->ReportPending()) {
+            std::string report;
+            if (g->TakeReport(report)) {
+                this->write(LogLevel::Warning, report.data(), report.size());
+            }
+        }
+        return res;
+    }
+
+    // iov_bytes returns the size of the message made of the parts
+    static size_t iov_bytes(const struct iovec *iov, int iovcnt) {
+        size_t n = 0;
+        for (int i = 0; i < iovcnt; i++) n += iov[i].iov_len;
+        return n;
+    }
+
+    bool log_args(const char *frmt, ...) {
+        va_list args;
+        va_start(args, frmt);
+        auto res = this->log(frmt, args);
+        va_end(args);
+        return res;
+    }
+
+    // the FlushPolicy fields, set by SetFlushPolicy() while logging
+    std::atomic<LogLevel::level_t> flush_level_{LogLevel::None};
+    std::atomic<size_t> flush_every_{0};
+    std::atomic<bool> flush_sync_{false};
+    std::atomic<int64_t> flush_interval_{0}; // milliseconds
+    std::shared_ptr<const Redactor> redactor_;
+    std::shared_ptr<Governor> governor_;
+    std::atomic<size_t> flush_count_{0}; // records counted for FlushPolicy::every
 }; // class target
 
 } // namespace slog
@@ -0,0 +1,131 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_THREAD_CONTEXT_H_
+#define __SLOG_THREAD_CONTEXT_H_
+
+#include <sys/types.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <utility>
+
+namespace slog {
+
+/**
+ * ThreadContext holds the per-thread attributes used while rendering
+ * the log records: the cached process and thread ids, a small
+ * sequential thread number, an optional thread name and the mapped
+ * diagnostic context (MDC), key-value pairs like the request or user
+ * id that are attached to every record of the thread.
+ *
+ * All the attributes are computed when they change, reading them is
+ * a plain load. The ids are refreshed in the child process after a
+ * fork() (see pthread_atfork(3)).
+ *
+ * The context of a thread must only be accessed by the thread itself.
+ */
+class ThreadContext {
+public:
+    // Current returns the calling thread's context
+    static ThreadContext& Current();
+
+    // Do not support copying/assigning objects
+    ThreadContext(const ThreadContext &) = delete;
+    ThreadContext &operator=(const ThreadContext &) = delete;
+
+    // Pid returns the process id
+    pid_t Pid() const {
+        return pid_;
+    }
+
+    // Tid returns the kernel thread id
+    pid_t Tid() const {
+        return tid_;
+    }
+
+    // Number returns the sequential number of the thread in the
+    // process, starting from 1 in the order the contexts are created.
+    uint32_t Number() const {
+        return number_;
+    }
+
+    // ThreadId returns the std::thread::id of the thread as string
+    const std::string& ThreadId() const {
+        return thread_id_;
+    }
+
+    // Name returns the name of the thread, empty unless it is set
+    const std::string& Name() const {
+        return name_;
+    }
+
+    // SetName sets the thread name, it is also set as the name of the
+    // kernel thread, truncated to 15 characters.
+    void SetName(const std::string& name);
+
+    // Put adds the key-value pair to the mapped diagnostic context,
+    // replacing the existing value of the key.
+    void Put(const std::string& key, const std::string& value);
+
+    // Get looks up the value of the key in the mapped diagnostic context
+    bool Get(const std::string& key, std::string& value) const;
+
+    // Remove deletes the key from the mapped diagnostic context
+    void Remove(const std::string& key);
+
+    // Clear deletes all the keys from the mapped diagnostic context
+    void Clear();
+
+    // Mdc returns the mapped diagnostic context rendered as
+    // "key=value key2=value2", empty if there are no keys.
+    const std::string& Mdc() const {
+        return mdc_;
+    }
+
+private:
+    ThreadContext();
+    void refresh();
+    void render();
+    static void on_fork_child();
+
+    pid_t pid_;
+    pid_t tid_;
+    uint32_t number_;
+    std::string thread_id_;
+    std::string name_;
+    std::vector<std::pair<std::string, std::string> > entries_;
+    std::string mdc_; // rendered entries_
+}; // class ThreadContext
+
+/**
+ * MdcScope puts a key-value pair to the calling thread's mapped
+ * diagnostic context for the lifetime of the object, the previous
+ * value of the key is restored on destruction:
+ *
+ *    slog::MdcScope request{"request", id};
+ *    log.Info("processing");   // ... [I] request=42 processing
+ */
+class MdcScope {
+public:
+    MdcScope(const std::string& key, const std::string& value);
+    ~MdcScope();
+
+    // Do not support copying/assigning objects
+    MdcScope(const MdcScope &) = delete;
+    MdcScope &operator=(const MdcScope &) = delete;
+
+private:
+    std::string key_;
+    std::string previous_;
+    bool had_previous_;
+}; // class MdcScope
+
+} // namespace slog
+
+#endif // __SLOG_THREAD_CONTEXT_H_
@@ -0,0 +1,148 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_TRACE_TARGET_H_
+#define __SLOG_TRACE_TARGET_H_
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <slog/target.h>
+#include <slog/span.h>
+#include <slog/thread_context.h>
+#include <slog/utils.h>
+#include <slog/file_exception.h>
+
+namespace slog {
+
+/**
+ * ChromeTraceTarget writes the spans to a file in the Chrome trace
+ * event format (a JSON array of "complete" events), which could be
+ * opened with Perfetto (https://ui.perfetto.dev) or chrome://tracing.
+ * The log records are written as instant events, so that they show
+ * up on the timeline along with the spans.
+ *
+ * The JSON array is closed when the target is destroyed, the viewers
+ * also accept the files of processes that did not exit cleanly.
+ */
+class ChromeTraceTarget: public Target {
+public:
+    explicit ChromeTraceTarget(const std::string& file_name, LogLevel::level_t lvl = LogLevel::Info) noexcept(false)
+        : Target(lvl) {
+        if (utils::is_symlink(file_name)) {
+            throw FileException{file_name, "Trace file cannot be a symbolic link", true};
+        }
+        if (!utils::ensure_directory_path(utils::dirname(file_name))) {
+            throw FileException{file_name, "Failed to create trace directory"};
+        }
+        fp_ = fopen(file_name.c_str(), "wb");
+        if (!fp_) {
+            throw FileException{file_name, "Failed to open trace file"};
+        }
+        fputs("[\n", fp_);
+    }
+
+    // Do not support copying/assigning objects
+    ChromeTraceTarget(const ChromeTraceTarget &) = delete;
+    ChromeTraceTarget &operator=(const ChromeTraceTarget &) = delete;
+
+    virtual ~ChromeTraceTarget() {
+        cancel_flush_timer();
+        fputs("\n]\n", fp_);
+        fclose(fp_);
+    }
+
+protected:
+    bool log(const std::string& frmt, va_list args) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!utils::vformat(buffer_, frmt.c_str(), args)) {
+            return false;
+        }
+        return instant_event(buffer_.data(), buffer_.size());
+    }
+
+    bool write(LogLevel::level_t, const char *msg, size_t len) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return instant_event(msg, len);
+    }
+
+    bool write_spans(const SpanEvent *events, size_t n) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t i = 0; i < n; i++) {
+            const SpanEvent &e = events[i];
+            separate();
+            json_.assign("{\"name\":\"");
+            escape(e.name, strlen(e.name));
+            json_ += "\",\"cat\":\"span\",\"ph\":\"X\"";
+            fputs(json_.c_str(), fp_);
+            fprintf(fp_, ",\"ts\":%" PRId64 ".%03d,\"dur\":%" PRId64 ".%03d,\"pid\":%d,\"tid\":%d}",
+                e.start / 1000, static_cast<int>(e.start % 1000),
+                e.duration / 1000, static_cast<int>(e.duration % 1000),
+                static_cast<int>(e.pid), static_cast<int>(e.tid));
+        }
+        return !ferror(fp_);
+    }
+
+    void flush() override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        fflush(fp_);
+    }
+
+private:
+    // instant_event writes a log record as an instant event of the
+    // calling thread. Must be called with the mutex held.
+    bool instant_event(const char *msg, size_t len) {
+        if (len && msg[len-1] == '\n') len--;
+        int64_t now = monotonic_ns();
+        separate();
+        json_.assign("{\"name\":\"");
+        escape(msg, len);
+        json_ += "\",\"cat\":\"log\",\"ph\":\"i\",\"s\":\"t\"";
+        fputs(json_.c_str(), fp_);
+        fprintf(fp_, ",\"ts\":%" PRId64 ".%03d,\"pid\":%d,\"tid\":%d}",
+            now / 1000, static_cast<int>(now % 1000),
+            static_cast<int>(ThreadContext::Current().Pid()),
+            static_cast<int>(ThreadContext::Current().Tid()));
+        return !ferror(fp_);
+    }
+
+    void separate() {
+        if (!first_) fputs(",\n", fp_);
+        first_ = false;
+    }
+
+    // escape appends the JSON string escaped text to json_
+    void escape(const char *text, size_t len) {
+        static const char hex[] = "0123456789abcdef";
+        for (size_t i = 0; i < len; i++) {
+            unsigned char c = static_cast<unsigned char>(text[i]);
+            if (c == '"' || c == '\\') {
+                json_ += '\\';
+                json_ += static_cast<char>(c);
+            } else if (c < 0x20) {
+                json_ += "\\u00";
+                json_ += hex[c >> 4];
+                json_ += hex[c & 0xf];
+            } else {
+                json_ += static_cast<char>(c);
+            }
+        }
+    }
+
+    std::mutex mutex_;
+    FILE *fp_{nullptr};
+    bool first_{true};
+    std::string buffer_; // rendering buffer of log()
+    std::string json_;   // rendering buffer of the events
+}; // class ChromeTraceTarget
+
+} // namespace slog
+
+#endif // __SLOG_TRACE_TARGET_H_
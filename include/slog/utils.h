@@ -10,6 +10,8 @@
 #define __SLOG_UTILS_H_
 
 #include <string>
+#include <cstdarg>
+#include <sys/uio.h>
 
 namespace slog {
 namespace utils {
@@ -60,6 +62,30 @@ bool create_directory_path(const std::string& dir);
 // It raises an exception if the directory path holds a symlink
 bool ensure_directory_path(const std::string& dir);
 
+// vformat renders the printf-style format string with the given
+// arguments into out, replacing its contents. The existing capacity
+// of out is reused, so a long-lived buffer does not allocate once it
+// has grown to the typical message size.
+// Returns false if the format string could not be rendered.
+bool vformat(std::string& out, const char *frmt, va_list args);
+
+// format is the variadic form of vformat().
+bool format(std::string& out, const char *frmt, ...);
+
+// vappend renders the printf-style format string with the given
+// arguments at the end of out, keeping its current contents.
+// Returns false if the format string could not be rendered, out
+// is left as it was.
+bool vappend(std::string& out, const char *frmt, va_list args);
+
+// append is the variadic form of vappend().
+bool append(std::string& out, const char *frmt, ...);
+
+// writev_all writes all the buffers of the vector to the file
+// descriptor, resuming after partial writes and interrupts. The
+// iov array is modified. Returns false on failure.
+bool writev_all(int fd, struct iovec *iov, int iovcnt);
+
 } // namespace utils
 } // namespace slog
 
@@ -0,0 +1,285 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#include <cstring>
+#include <vector>
+#include <slog/compression.h>
+
+using namespace std;
+
+namespace slog {
+namespace lz {
+
+namespace {
+
+const size_t min_match = 4;
+const size_t max_offset = 65535;
+// the last bytes of a block are always emitted as literals,
+// so that the match finder never reads past the input.
+const size_t last_literals = 5;
+const unsigned hash_bits = 12;
+
+inline uint32_t read32(const char *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint32_t hash(uint32_t seq) {
+    return (seq * 2654435761u) >> (32 - hash_bits);
+}
+
+inline void put_u32(string& out, uint32_t v) {
+    char b[4] = {static_cast<char>(v), static_cast<char>(v >> 8),
+                 static_cast<char>(v >> 16), static_cast<char>(v >> 24)};
+    out.append(b, 4);
+}
+
+inline uint32_t get_u32(const char *p) {
+    const unsigned char *u = reinterpret_cast<const unsigned char *>(p);
+    return u[0] | (u[1] << 8) | (u[2] << 16) | (static_cast<uint32_t>(u[3]) << 24);
+}
+
+inline void put_length(string& out, size_t len) {
+    for (; len >= 255; len -= 255) {
+        out.push_back(static_cast<char>(255));
+    }
+    out.push_back(static_cast<char>(len));
+}
+
+void put_sequence(string& out, const char *lit, size_t lit_len, size_t offset, size_t match_len) {
+    size_t ml = match_len ? match_len - min_match : 0;
+    unsigned char token = static_cast<unsigned char>(
+        ((lit_len < 15 ? lit_len : 15) << 4) | (ml < 15 ? ml : 15));
+    out.push_back(static_cast<char>(token));
+    if (lit_len >= 15) put_length(out, lit_len - 15);
+    out.append(lit, lit_len);
+    if (!match_len) return;
+    out.push_back(static_cast<char>(offset));
+    out.push_back(static_cast<char>(offset >> 8));
+    if (ml >= 15) put_length(out, ml - 15);
+}
+
+// get_length reads the continuation bytes of a length field.
+inline bool get_length(const char *&ip, const char *end, size_t& len) {
+    unsigned char b;
+    do {
+        if (ip >= end) return false;
+        b = static_cast<unsigned char>(*ip++);
+        len += b;
+    } while (b == 255);
+    return true;
+}
+
+} // namespace
+
+size_t Compress(const char *src, size_t n, string& out) {
+    size_t start = out.size();
+    uint32_t table[1 << hash_bits] = {}; // positions + 1, 0 is empty
+
+    size_t ip = 0, anchor = 0, misses = 0;
+    while (n >= last_literals + min_match && ip <= n - last_literals - min_match) {
+        uint32_t seq = read32(src + ip);
+        uint32_t h = hash(seq);
+        size_t ref = table[h];
+        table[h] = static_cast<uint32_t>(ip + 1);
+        if (!ref || ip - (ref - 1) > max_offset || read32(src + ref - 1) != seq) {
+            // skip faster through data that does not compress
+            ip += 1 + (misses++ >> 6);
+            continue;
+        }
+        ref--;
+        size_t len = min_match;
+        while (ip + len < n - last_literals && src[ref + len] == src[ip + len]) {
+            len++;
+        }
+        put_sequence(out, src + anchor, ip - anchor, ip - ref, len);
+        ip += len;
+        anchor = ip;
+        misses = 0;
+    }
+    put_sequence(out, src + anchor, n - anchor, 0, 0);
+    return out.size() - start;
+}
+
+bool Decompress(const char *src, size_t n, size_t raw_size, string& out) {
+    const char *ip = src, *end = src + n;
+    size_t base = out.size();
+    out.reserve(base + raw_size);
+
+    while (ip < end) {
+        unsigned char token = static_cast<unsigned char>(*ip++);
+        size_t lit_len = token >> 4;
+        if (lit_len == 15 && !get_length(ip, end, lit_len)) return false;
+        if (static_cast<size_t>(end - ip) < lit_len || out.size() - base + lit_len > raw_size) {
+            return false;
+        }
+        out.append(ip, lit_len);
+        ip += lit_len;
+        if (ip == end) break; // last sequence
+
+        if (end - ip < 2) return false;
+        size_t offset = static_cast<unsigned char>(ip[0]) | (static_cast<unsigned char>(ip[1]) << 8);
+        ip += 2;
+        size_t match_len = token & 0xf;
+        if (match_len == 15 && !get_length(ip, end, match_len)) return false;
+        match_len += min_match;
+        size_t produced = out.size() - base;
+        if (offset == 0 || offset > produced || produced + match_len > raw_size) {
+            return false;
+        }
+        // matches could overlap with their own output
+        size_t from = out.size() - offset;
+        for (size_t i = 0; i < match_len; i++) {
+            out.push_back(out[from + i]);
+        }
+    }
+    return out.size() - base == raw_size;
+}
+
+uint32_t checksum(const char *data, size_t n) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < n; i++) {
+        h = (h ^ static_cast<unsigned char>(data[i])) * 16777619u;
+    }
+    return h;
+}
+
+void EncodeFrame(const char *raw, size_t n, string& out) {
+    size_t header = out.size();
+    out.resize(header + frame_header_size);
+    size_t data_size = Compress(raw, n, out);
+    uint32_t flags = 0;
+    if (data_size >= n) {
+        // does not compress, store the block as-is
+        out.resize(header + frame_header_size);
+        out.append(raw, n);
+        data_size = n;
+        flags |= frame_stored;
+    }
+    string h;
+    put_u32(h, frame_magic);
+    put_u32(h, flags);
+    put_u32(h, static_cast<uint32_t>(n));
+    put_u32(h, static_cast<uint32_t>(data_size));
+    put_u32(h, checksum(raw, n));
+    out.replace(header, frame_header_size, h);
+}
+
+frame_status_t DecodeFrame(const char *src, size_t n, string& out, size_t& consumed) {
+    if (n < frame_header_size) return frame_incomplete;
+    if (get_u32(src) != frame_magic) return frame_corrupt;
+    uint32_t flags = get_u32(src + 4);
+    uint32_t raw_size = get_u32(src + 8);
+    uint32_t data_size = get_u32(src + 12);
+    uint32_t sum = get_u32(src + 16);
+    if (n - frame_header_size < data_size) return frame_incomplete;
+
+    const char *data = src + frame_header_size;
+    size_t base = out.size();
+    if (flags & frame_stored) {
+        if (data_size != raw_size) return frame_corrupt;
+        out.append(data, data_size);
+    } else if (!Decompress(data, data_size, raw_size, out)) {
+        out.resize(base);
+        return frame_corrupt;
+    }
+    if (checksum(out.data() + base, raw_size) != sum) {
+        out.resize(base);
+        return frame_corrupt;
+    }
+    consumed = frame_header_size + data_size;
+    return frame_ok;
+}
+
+} // namespace lz
+
+BlockWriter::BlockWriter(FILE *fp, size_t block_size, MemoryResource *memory)
+    : fp_(fp), block_size_(block_size), memory_(memory), current_(Allocator<char>(memory)) {
+    try {
+        current_.reserve(block_size_);
+    } catch (const bad_alloc&) {
+        // grows with the records, as far as the budget allows
+    }
+    thread_ = thread(&BlockWriter::run, this);
+}
+
+BlockWriter::~BlockWriter() {
+    Flush();
+    {
+        lock_guard<mutex> lock(mutex_);
+        stop_ = true;
+    }
+    work_cv_.notify_one();
+    thread_.join();
+}
+
+// seal hands the current block over to the writer thread,
+// must be called with the mutex held.
+void BlockWriter::seal() {
+    if (current_.empty()) return;
+    pending_.push_back(move(current_));
+    current_ = MemoryBuffer(Allocator<char>(memory_));
+    try {
+        current_.reserve(block_size_);
+    } catch (const bad_alloc&) {
+        // grows with the records, as far as the budget allows
+    }
+    work_cv_.notify_one();
+}
+
+bool BlockWriter::Append(const char *data, size_t len) {
+    unique_lock<mutex> lock(mutex_);
+    size_t size = current_.size();
+    try {
+        current_.append(data, len);
+        if (len == 0 || data[len-1] != '\n') {
+            current_.push_back('\n');
+        }
+    } catch (const bad_alloc&) {
+        current_.resize(size);
+        return false;
+    }
+    if (current_.size() >= block_size_) {
+        // apply back pressure if the writer thread falls behind
+        done_cv_.wait(lock, [this]() { return pending_.size() < MaxPendingBlocks; });
+        seal();
+    }
+    return true;
+}
+
+void BlockWriter::Flush() {
+    unique_lock<mutex> lock(mutex_);
+    seal();
+    done_cv_.wait(lock, [this]() { return pending_.empty() && !busy_; });
+    ::fflush(fp_);
+}
+
+void BlockWriter::run() {
+    string frame;
+    unique_lock<mutex> lock(mutex_);
+    for (;;) {
+        work_cv_.wait(lock, [this]() { return stop_ || !pending_.empty(); });
+        if (pending_.empty()) break;
+
+        MemoryBuffer block = move(pending_.front());
+        pending_.pop_front();
+        busy_ = true;
+        lock.unlock();
+
+        frame.clear();
+        lz::EncodeFrame(block.data(), block.size(), frame);
+        fwrite(frame.data(), 1, frame.size(), fp_);
+
+        lock.lock();
+        busy_ = false;
+        done_cv_.notify_all();
+    }
+}
+
+} // namespace slog
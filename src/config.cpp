@@ -0,0 +1,519 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cstring>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <slog/config.h>
+#include <slog/console_target.h>
+#include <slog/file_target.h>
+#include <slog/sharded_file_target.h>
+#include <slog/shm_target.h>
+#include <slog/utils.h>
+
+using namespace std;
+
+namespace slog {
+
+struct Config::graph_t {
+    struct target_t {
+        string signature; // the configuration the target was built from
+        shared_ptr<Target> target;
+    };
+    map<string, target_t> targets;
+    map<string, shared_ptr<logger_t> > loggers;
+    shared_ptr<logger_t> fallback;
+};
+
+namespace {
+
+struct section_t {
+    string kind;  // "target" or "logger"
+    string name;
+    map<string, string> keys;
+    int line;
+};
+
+string trim(const string& s) {
+    auto begin = s.find_first_not_of(" \t\r\n");
+    if (begin == string::npos) return "";
+    auto end = s.find_last_not_of(" \t\r\n");
+    return s.substr(begin, end - begin + 1);
+}
+
+vector<section_t> parse(const string& file, const string& text) {
+    vector<section_t> sections;
+    istringstream in(text);
+    string line;
+    int lineno = 0;
+    while (getline(in, line)) {
+        lineno++;
+        line = trim(line);
+        if (line.empty() || line[0] == '#' || line[0] == ';') continue;
+        if (line[0] == '[') {
+            auto dot = line.find('.');
+            if (line.back() != ']' || dot == string::npos) {
+                throw ConfigException{file, "line " + to_string(lineno) + ": invalid section " + line};
+            }
+            section_t s;
+            s.kind = trim(line.substr(1, dot - 1));
+            s.name = trim(line.substr(dot + 1, line.size() - dot - 2));
+            s.line = lineno;
+            if ((s.kind != "target" && s.kind != "logger") || s.name.empty()) {
+                throw ConfigException{file, "line " + to_string(lineno) + ": invalid section " + line};
+            }
+            for (auto &other : sections) {
+                if (other.kind == s.kind && other.name == s.name) {
+                    throw ConfigException{file, "line " + to_string(lineno) + ": duplicate section " + line};
+                }
+            }
+            sections.push_back(s);
+            continue;
+        }
+        auto eq = line.find('=');
+        if (eq == string::npos || sections.empty()) {
+            throw ConfigException{file, "line " + to_string(lineno) + ": expected key = value"};
+        }
+        sections.back().keys[trim(line.substr(0, eq))] = trim(line.substr(eq + 1));
+    }
+    return sections;
+}
+
+// options reads the keys of a section, reporting the invalid values
+// and the keys that are not used.
+class options {
+public:
+    options(const string& file, const section_t& s): file_(file), section_(s) {}
+
+    bool has(const string& key) const {
+        return section_.keys.count(key) != 0;
+    }
+
+    string get(const string& key, const string& def = "") {
+        used_.insert(key);
+        auto it = section_.keys.find(key);
+        return it == section_.keys.end() ? def : it->second;
+    }
+
+    size_t number(const string& key, size_t def) {
+        string v = get(key);
+        if (v.empty()) return def;
+        char *end = nullptr;
+        unsigned long long n = strtoull(v.c_str(), &end, 10);
+        if (*end != '\0' || v[0] == '-') fail("invalid number " + key + " = " + v);
+        return static_cast<size_t>(n);
+    }
+
+    bool boolean(const string& key, bool def) {
+        string v = get(key);
+        if (v.empty()) return def;
+        if (v == "true" || v == "yes" || v == "1") return true;
+        if (v == "false" || v == "no" || v == "0") return false;
+        fail("invalid boolean " + key + " = " + v);
+        return def;
+    }
+
+    LogLevel::level_t level(const string& key, LogLevel::level_t def) {
+        string v = get(key);
+        if (v.empty()) return def;
+        LogLevel l{v};
+        if (l.Get() == LogLevel::None && v != "none") fail("invalid level " + key + " = " + v);
+        return l.Get();
+    }
+
+    void check_unused() const {
+        for (auto &kv : section_.keys) {
+            if (!used_.count(kv.first)) fail("unknown key " + kv.first);
+        }
+    }
+
+    [[noreturn]] void fail(const string& msg) const {
+        throw ConfigException{file_, "[" + section_.kind + "." + section_.name + "] (line " +
+            to_string(section_.line) + "): " + msg};
+    }
+
+private:
+    const string& file_;
+    const section_t& section_;
+    set<string> used_;
+};
+
+string signature(const section_t& s) {
+    string sig;
+    for (auto &kv : s.keys) {
+        sig += kv.first + "=" + kv.second + "\n";
+    }
+    return sig;
+}
+
+vector<string> split_list(const string& list) {
+    vector<string> items;
+    istringstream in(list);
+    string item;
+    while (getline(in, item, ',')) {
+        item = trim(item);
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+shared_ptr<Target> make_target(options& opts) {
+    string type = opts.get("type", "file");
+    auto level = opts.level("level", LogLevel::Debug);
+    shared_ptr<Target> target;
+    try {
+        if (type == "file") {
+            string path = opts.get("path");
+            if (path.empty()) opts.fail("missing path");
+            FileOptions fo;
+            fo.index_interval = opts.number("index_interval", 0);
+            fo.compress_block = opts.number("compress_block", 0);
+            fo.framed = opts.boolean("framed", false);
+            fo.escape = opts.boolean("escape", false);
+            fo.spill = opts.number("spill", 0);
+            fo.spill_timeout = chrono::milliseconds(opts.number("spill_timeout_ms", fo.spill_timeout.count()));
+            if (opts.has("memory_budget")) {
+                fo.memory = make_shared<MemoryAccount>(opts.number("memory_budget", 0));
+            }
+            target = make_shared<FileTarget<mutex> >(path, level, fo);
+        } else if (type == "sharded") {
+            string path = opts.get("path");
+            if (path.empty()) opts.fail("missing path");
+            target = make_shared<ShardedFileTarget>(path, level);
+        } else if (type == "shm") {
+            string path = opts.get("path");
+            if (path.empty()) opts.fail("missing path");
+            target = make_shared<ShmTarget>(path, level);
+        } else if (type == "console") {
+            ConsoleOptions co;
+            string stream = opts.get("stream", "stdout");
+            if (stream != "stdout" && stream != "stderr") opts.fail("invalid stream " + stream);
+            string color = opts.get("color", "auto");
+            if (color == "always") {
+                co.color = ConsoleOptions::color_always;
+            } else if (color == "never") {
+                co.color = ConsoleOptions::color_never;
+            } else if (color != "auto") {
+                opts.fail("invalid color " + color);
+            }
+            co.buffer_size = opts.number("buffer_size", co.buffer_size);
+            co.flush_interval = chrono::milliseconds(
+                opts.number("flush_interval_ms", co.flush_interval.count()));
+            target = make_shared<ConsoleTarget<mutex> >(
+                stream == "stdout" ? STDOUT_FILENO : STDERR_FILENO, level, co);
+        } else if (type == "stdout") {
+            target = make_shared<StdoutTarget<mutex> >(level);
+        } else if (type == "stderr") {
+            target = make_shared<StderrTarget<mutex> >(level);
+        } else {
+            opts.fail("invalid type " + type);
+        }
+    } catch (ConfigException &) {
+        throw;
+    } catch (std::exception &e) {
+        opts.fail(e.what());
+    }
+
+    if (opts.has("redact") || opts.has("redact_cards")) {
+        RedactorOptions ro;
+        ro.patterns = split_list(opts.get("redact"));
+        ro.card_numbers = opts.boolean("redact_cards", false);
+        try {
+            target->SetRedactor(make_shared<Redactor>(ro));
+        } catch (std::exception &e) {
+            opts.fail(e.what());
+        }
+    }
+
+    bool throttle = opts.has("throttle_latency_us") || opts.has("throttle_lock_wait_us");
+    GovernorOptions go;
+    go.latency = chrono::microseconds(opts.number("throttle_latency_us", go.latency.count()));
+    go.lock_wait = chrono::microseconds(opts.number("throttle_lock_wait_us", go.lock_wait.count()));
+    go.recovery = chrono::milliseconds(opts.number("throttle_recovery_ms", go.recovery.count()));
+    go.floor = opts.level("throttle_floor", go.floor);
+    if (throttle) {
+        target->SetGovernor(make_shared<Governor>(go));
+    }
+
+    if (type != "console" || opts.has("flush_level") || opts.has("flush_every") || opts.has("sync")) {
+        FlushPolicy policy = target->GetFlushPolicy();
+        policy.level = opts.level("flush_level", policy.level);
+        policy.every = opts.number("flush_every", policy.every);
+        policy.interval = chrono::milliseconds(opts.number("flush_interval_ms", policy.interval.count()));
+        policy.sync = opts.boolean("sync", policy.sync);
+        target->SetFlushPolicy(policy);
+    }
+    return target;
+}
+
+string read_file(const string& path) {
+    ifstream in(path, ifstream::in | ifstream::binary);
+    if (!in) {
+        throw ConfigException{path, "failed to read the configuration"};
+    }
+    ostringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+} // namespace
+
+Config::Config(const string& path): path_(path) {
+    atomic_store(&graph_, build(read_file(path_)));
+}
+
+Config::~Config() {
+    Unwatch();
+}
+
+shared_ptr<Config::graph_t> Config::build(const string& text) const {
+    auto sections = parse(path_, text);
+    auto previous = atomic_load(&graph_);
+    auto graph = make_shared<graph_t>();
+
+    for (auto &s : sections) {
+        if (s.kind != "target") continue;
+        string sig = signature(s);
+        if (previous) {
+            // keep the targets with unchanged configuration
+            auto it = previous->targets.find(s.name);
+            if (it != previous->targets.end() && it->second.signature == sig) {
+                graph->targets[s.name] = it->second;
+                continue;
+            }
+        }
+        options opts{path_, s};
+        auto target = make_target(opts);
+        opts.check_unused();
+        graph->targets[s.name] = graph_t::target_t{sig, target};
+    }
+
+    for (auto &s : sections) {
+        if (s.kind != "logger") continue;
+        options opts{path_, s};
+        auto level = opts.level("level", DefaultLogLevel);
+        vector<shared_ptr<Target> > targets;
+        for (auto &name : split_list(opts.get("targets"))) {
+            auto it = graph->targets.find(name);
+            if (it == graph->targets.end()) opts.fail("unknown target " + name);
+            targets.push_back(it->second.target);
+        }
+        auto logger = make_shared<logger_t>(s.name, level, targets.begin(), targets.end());
+        if (opts.has("pattern")) {
+            logger->SetPattern(RuntimePattern{opts.get("pattern")});
+        }
+        logger->SetPayloadLimit(opts.number("payload_limit", DefaultPayloadLimit));
+        auto degrade_level = opts.level("degrade_level", LogLevel::Debug);
+        if (opts.has("memory_budget")) {
+            logger->SetMemoryAccount(make_shared<MemoryAccount>(opts.number("memory_budget", 0)), degrade_level);
+        }
+        opts.check_unused();
+        graph->loggers[s.name] = logger;
+    }
+
+    auto it = graph->loggers.find("default");
+    graph->fallback = it != graph->loggers.end() ? it->second : make_shared<logger_t>("default");
+    return graph;
+}
+
+shared_ptr<Config::logger_t> Config::Logger(const string& name) const {
+    auto graph = atomic_load(&graph_);
+    auto it = graph->loggers.find(name);
+    return it != graph->loggers.end() ? it->second : graph->fallback;
+}
+
+ConfiguredLogger Config::Get(const string& name) const {
+    return ConfiguredLogger{*this, name};
+}
+
+bool Config::Reload() {
+    vector<shared_ptr<graph_t> > retired;
+    uint64_t generation;
+    {
+        lock_guard<mutex> lock(mutex_);
+        try {
+            auto graph = build(read_file(path_));
+            retired_.push_back(atomic_exchange(&graph_, graph));
+            generation = generation_.fetch_add(1) + 1;
+            error_.clear();
+        } catch (ConfigException &e) {
+            error_ = e.what();
+            return false;
+        }
+        retired.swap(retired_);
+    }
+    // the replaced graphs are released here, not by the logging threads
+    if (!quiesce(generation)) {
+        lock_guard<mutex> lock(mutex_);
+        retired_.insert(retired_.end(), retired.begin(), retired.end());
+    }
+    return true;
+}
+
+bool Config::quiesce(uint64_t generation) const {
+    vector<shared_ptr<reader_t> > readers;
+    {
+        lock_guard<mutex> lock(readers_mutex_);
+        // drop the readers of the exited threads
+        readers_.erase(remove_if(readers_.begin(), readers_.end(), [](const shared_ptr<reader_t>& r) {
+            return r.use_count() == 1;
+        }), readers_.end());
+        readers = readers_;
+    }
+    bool quiet = true;
+    for (auto &r : readers) {
+        if (r->owner == this_thread::get_id()) {
+            if (r->depth.load() != 0) quiet = false;
+            continue;
+        }
+        // a thread that pinned an older generation may still use the old
+        // graph, the newer ones use the new graph
+        while (r->depth.load() != 0 && r->generation.load() < generation) {
+            this_thread::sleep_for(chrono::microseconds(100));
+        }
+    }
+    return quiet;
+}
+
+shared_ptr<Config::reader_t> Config::reader() const {
+    auto r = make_shared<reader_t>(this_thread::get_id());
+    lock_guard<mutex> lock(readers_mutex_);
+    readers_.push_back(r);
+    return r;
+}
+
+string Config::LastError() const {
+    lock_guard<mutex> lock(mutex_);
+    return error_;
+}
+
+void Config::Watch() {
+    if (watcher_.joinable()) return;
+    // watch the directory, editors often replace the file by renaming
+    string dir = utils::dirname(path_);
+    inotify_fd_ = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+    stop_fd_ = eventfd(0, EFD_CLOEXEC);
+    if (inotify_fd_ < 0 || stop_fd_ < 0 ||
+        inotify_add_watch(inotify_fd_, dir.empty() ? "." : dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        string error = strerror(errno);
+        if (inotify_fd_ >= 0) ::close(inotify_fd_);
+        if (stop_fd_ >= 0) ::close(stop_fd_);
+        inotify_fd_ = stop_fd_ = -1;
+        throw ConfigException{path_, "failed to watch: " + error};
+    }
+    watcher_ = thread(&Config::watch, this);
+}
+
+void Config::Unwatch() {
+    if (!watcher_.joinable()) return;
+    uint64_t one = 1;
+    if (::write(stop_fd_, &one, sizeof(one)) < 0) {
+        // the eventfd counter could not overflow with a single write
+    }
+    watcher_.join();
+    ::close(stop_fd_);
+    ::close(inotify_fd_);
+    inotify_fd_ = stop_fd_ = -1;
+}
+
+void Config::watch() {
+    string dir = utils::dirname(path_);
+    string base = dir.empty() ? path_ : path_.substr(dir.size() + 1);
+    alignas(struct inotify_event) char buf[4096];
+    for (;;) {
+        struct pollfd fds[2] = {{stop_fd_, POLLIN, 0}, {inotify_fd_, POLLIN, 0}};
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[0].revents) break;
+
+        bool changed = false;
+        ssize_t len;
+        while ((len = ::read(inotify_fd_, buf, sizeof(buf))) > 0) {
+            for (char *p = buf; p < buf + len; ) {
+                auto *event = reinterpret_cast<struct inotify_event *>(p);
+                if (event->len && base == event->name) changed = true;
+                p += sizeof(struct inotify_event) + event->len;
+            }
+        }
+        if (changed) Reload();
+    }
+}
+
+uint64_t Config::key(const string& name) const {
+    static atomic<uint64_t> next_key{1};
+    lock_guard<mutex> lock(mutex_);
+    auto it = keys_.find(name);
+    if (it == keys_.end()) {
+        it = keys_.emplace(name, next_key++).first;
+    }
+    return it->second;
+}
+
+ConfiguredLogger::ConfiguredLogger(const Config& config, const string& name)
+    : config_(&config), name_(name), key_(config.key(name)) {}
+
+ConfiguredLogger::pin_t ConfiguredLogger::current() const {
+    struct entry_t {
+        uint64_t key;
+        uint64_t generation;
+        Config::logger_t *logger;   // owned by the graph of the generation
+        const Config *config;
+        weak_ptr<const char> alive; // of the Config
+        shared_ptr<Config::reader_t> reader; // of the thread, per Config
+    };
+    static thread_local vector<entry_t> cache;
+
+    entry_t *entry = nullptr;
+    for (auto &e : cache) {
+        if (e.key == key_) {
+            entry = &e;
+            break;
+        }
+    }
+    if (!entry) {
+        // drop the loggers of the destroyed configurations
+        cache.erase(remove_if(cache.begin(), cache.end(), [](const entry_t& e) {
+            return e.alive.expired();
+        }), cache.end());
+        shared_ptr<Config::reader_t> reader;
+        for (auto &e : cache) {
+            if (e.config == config_) reader = e.reader;
+        }
+        if (!reader) reader = config_->reader();
+        cache.push_back(entry_t{key_, 0, nullptr, config_, config_->alive_, reader});
+        entry = &cache.back();
+    }
+
+    // pin the generation before reading the graph, Reload() releases the
+    // graphs it replaced once the readers moved past them
+    auto &r = *entry->reader;
+    uint32_t depth = r.depth.load(memory_order_relaxed);
+    uint64_t generation;
+    if (depth == 0) {
+        r.depth.store(1);
+        generation = config_->generation_.load();
+        r.generation.store(generation);
+    } else {
+        r.depth.store(depth + 1, memory_order_relaxed);
+        generation = r.generation.load(memory_order_relaxed);
+    }
+    if (!entry->logger || entry->generation != generation) {
+        entry->logger = config_->Logger(name_).get();
+        entry->generation = generation;
+    }
+    return pin_t{&r, entry->logger};
+}
+
+} // namespace slog
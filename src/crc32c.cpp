@@ -0,0 +1,103 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#include <cstring>
+#include <slog/crc32c.h>
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#endif
+
+namespace slog {
+
+namespace {
+
+// reflected Castagnoli polynomial
+const uint32_t poly = 0x82f63b78;
+
+// tables_t holds the slicing-by-8 lookup tables
+struct tables_t {
+    uint32_t t[8][256];
+
+    tables_t() {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t crc = i;
+            for (int k = 0; k < 8; k++) {
+                crc = (crc >> 1) ^ (poly & (0u - (crc & 1)));
+            }
+            t[0][i] = crc;
+        }
+        for (uint32_t i = 0; i < 256; i++) {
+            for (int k = 1; k < 8; k++) {
+                t[k][i] = (t[k-1][i] >> 8) ^ t[0][t[k-1][i] & 0xff];
+            }
+        }
+    }
+};
+
+const tables_t& tables() {
+    static const tables_t tables;
+    return tables;
+}
+
+// software computes the raw (not inverted) CRC, 8 bytes at a time
+uint32_t software(uint32_t crc, const unsigned char *p, size_t n) {
+    const uint32_t (&t)[8][256] = tables().t;
+    for (; n >= 8; n -= 8, p += 8) {
+        uint32_t lo, hi;
+        memcpy(&lo, p, 4);
+        memcpy(&hi, p + 4, 4);
+        lo ^= crc; // little endian
+        crc = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^ t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24] ^
+              t[3][hi & 0xff] ^ t[2][(hi >> 8) & 0xff] ^ t[1][(hi >> 16) & 0xff] ^ t[0][hi >> 24];
+    }
+    for (; n; n--, p++) {
+        crc = (crc >> 8) ^ t[0][(crc ^ *p) & 0xff];
+    }
+    return crc;
+}
+
+#if defined(__x86_64__)
+__attribute__((target("sse4.2")))
+uint32_t hardware(uint32_t crc, const unsigned char *p, size_t n) {
+    uint64_t crc64 = crc;
+    for (; n >= 8; n -= 8, p += 8) {
+        uint64_t v;
+        memcpy(&v, p, 8);
+        crc64 = _mm_crc32_u64(crc64, v);
+    }
+    crc = static_cast<uint32_t>(crc64);
+    for (; n; n--, p++) {
+        crc = _mm_crc32_u8(crc, *p);
+    }
+    return crc;
+}
+#endif
+
+using crc_fn_t = uint32_t (*)(uint32_t, const unsigned char *, size_t);
+
+crc_fn_t select() {
+#if defined(__x86_64__)
+    if (__builtin_cpu_supports("sse4.2")) {
+        return hardware;
+    }
+#endif
+    return software;
+}
+
+} // namespace
+
+uint32_t crc32c(uint32_t crc, const void *data, size_t n) {
+    static const crc_fn_t fn = select();
+    return ~fn(~crc, static_cast<const unsigned char *>(data), n);
+}
+
+uint32_t crc32c_software(uint32_t crc, const void *data, size_t n) {
+    return ~software(~crc, static_cast<const unsigned char *>(data), n);
+}
+
+} // namespace slog
@@ -0,0 +1,131 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#include <cstdint>
+#include <cstring>
+#include <slog/escape.h>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace slog {
+
+namespace {
+
+bool is_control(unsigned char c) {
+    return (c < 0x20 && c != '\t') || c == 0x7f;
+}
+
+size_t software(const unsigned char *p, size_t n) {
+    const uint64_t ones = 0x0101010101010101ull;
+    const uint64_t highs = 0x8080808080808080ull;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t v;
+        memcpy(&v, p + i, 8);
+        // a high bit for the bytes below 0x20 or equal to 0x7f, and
+        // maybe some others, checked one by one
+        uint64_t del = v ^ (ones * 0x7f);
+        if (((v - ones * 0x20) & ~v & highs) | ((del - ones) & ~del & highs)) {
+            for (size_t k = i; k < i + 8; k++) {
+                if (is_control(p[k])) return k;
+            }
+        }
+    }
+    for (; i < n; i++) {
+        if (is_control(p[i])) return i;
+    }
+    return n;
+}
+
+#if defined(__x86_64__)
+// sse2 is the baseline of x86-64, available on every CPU
+size_t sse2(const unsigned char *p, size_t n) {
+    const __m128i limit = _mm_set1_epi8(0x1f);
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i del = _mm_set1_epi8(0x7f);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+        // x <= 0x1f, unsigned
+        __m128i ctl = _mm_cmpeq_epi8(_mm_min_epu8(x, limit), x);
+        ctl = _mm_andnot_si128(_mm_cmpeq_epi8(x, tab), ctl);
+        ctl = _mm_or_si128(ctl, _mm_cmpeq_epi8(x, del));
+        int mask = _mm_movemask_epi8(ctl);
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    return i + software(p + i, n - i);
+}
+
+__attribute__((target("avx2")))
+size_t avx2(const unsigned char *p, size_t n) {
+    const __m256i limit = _mm256_set1_epi8(0x1f);
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i del = _mm256_set1_epi8(0x7f);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i));
+        __m256i ctl = _mm256_cmpeq_epi8(_mm256_min_epu8(x, limit), x);
+        ctl = _mm256_andnot_si256(_mm256_cmpeq_epi8(x, tab), ctl);
+        ctl = _mm256_or_si256(ctl, _mm256_cmpeq_epi8(x, del));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(ctl));
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    // the compiler does not clear the upper halves before the call
+    // to the legacy SSE code, which would stall on the transition
+    _mm256_zeroupper();
+    return i + sse2(p + i, n - i);
+}
+#endif
+
+using find_fn_t = size_t (*)(const unsigned char *, size_t);
+
+find_fn_t select() {
+#if defined(__x86_64__)
+    if (__builtin_cpu_supports("avx2")) {
+        return avx2;
+    }
+    return sse2;
+#else
+    return software;
+#endif
+}
+
+} // namespace
+
+size_t find_control(const char *data, size_t n) {
+    static const find_fn_t fn = select();
+    return fn(reinterpret_cast<const unsigned char *>(data), n);
+}
+
+size_t find_control_software(const char *data, size_t n) {
+    return software(reinterpret_cast<const unsigned char *>(data), n);
+}
+
+void escape_control(const char *data, size_t n, std::string& out) {
+    static const char hex[] = "0123456789abcdef";
+    out.reserve(out.size() + n + 16);
+    while (n) {
+        size_t clean = find_control(data, n);
+        out.append(data, clean);
+        if (clean == n) break;
+        unsigned char c = static_cast<unsigned char>(data[clean]);
+        if (c == '\n') {
+            out.append("\\n", 2);
+        } else if (c == '\r') {
+            out.append("\\r", 2);
+        } else {
+            char esc[4] = {'\\', 'x', hex[c >> 4], hex[c & 0xf]};
+            out.append(esc, 4);
+        }
+        data += clean + 1;
+        n -= clean + 1;
+    }
+}
+
+} // namespace slog
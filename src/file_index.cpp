@@ -0,0 +1,97 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#include <ctime>
+#include <cstring>
+#include <algorithm>
+#include <slog/file_index.h>
+#include <slog/file_exception.h>
+#include <slog/utils.h>
+
+using namespace std;
+
+namespace slog {
+
+namespace {
+
+const char index_magic[8] = {'S', 'L', 'G', 'I', 'D', 'X', '1', '\0'};
+
+inline int64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000ll + ts.tv_nsec;
+}
+
+} // namespace
+
+bool FileIndex::Load(const string& log_file) {
+    entries_.clear();
+    FILE *fp = fopen(Path(log_file).c_str(), "rb");
+    if (!fp) return false;
+
+    char magic[sizeof(index_magic)];
+    if (fread(magic, 1, sizeof(magic), fp) != sizeof(magic) ||
+        memcmp(magic, index_magic, sizeof(magic)) != 0) {
+        fclose(fp);
+        return false;
+    }
+    entry_t e;
+    while (fread(&e, sizeof(e), 1, fp) == 1) {
+        entries_.push_back(e);
+    }
+    fclose(fp);
+    return true;
+}
+
+uint64_t FileIndex::Begin(int64_t time) const {
+    // records following the last entry written before the
+    // given time could still be later than the time.
+    auto it = lower_bound(entries_.begin(), entries_.end(), time,
+        [](const entry_t& e, int64_t t) { return e.time < t; });
+    if (it == entries_.begin()) return 0;
+    return (--it)->offset;
+}
+
+uint64_t FileIndex::End(int64_t time) const {
+    auto it = upper_bound(entries_.begin(), entries_.end(), time,
+        [](int64_t t, const entry_t& e) { return t < e.time; });
+    return it == entries_.end() ? UINT64_MAX : it->offset;
+}
+
+FileIndexWriter::~FileIndexWriter() {
+    if (fp_) {
+        fclose(fp_);
+        fp_ = nullptr;
+    }
+}
+
+void FileIndexWriter::Open(const string& log_file, uint64_t offset, size_t interval) {
+    string path = FileIndex::Path(log_file);
+    if (utils::is_symlink(path)) {
+        throw FileException{path, "Index file cannot be a symbolic link", true};
+    }
+    fp_ = fopen(path.c_str(), "ab");
+    if (!fp_) {
+        throw FileException{path, "Failed to open index file"};
+    }
+    fseek(fp_, 0, SEEK_END);
+    if (ftell(fp_) == 0) {
+        fwrite(index_magic, 1, sizeof(index_magic), fp_);
+    }
+    interval_ = interval;
+    offset_ = offset;
+    next_ = offset;
+}
+
+void FileIndexWriter::add_entry() {
+    FileIndex::entry_t e{now_ns(), offset_};
+    fwrite(&e, sizeof(e), 1, fp_);
+    next_ = offset_ + interval_;
+}
+
+} // namespace slog
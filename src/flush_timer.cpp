@@ -0,0 +1,101 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#include <algorithm>
+#include <slog/flush_timer.h>
+#include <slog/target.h>
+
+using namespace std;
+
+namespace slog {
+
+FlushTimer& FlushTimer::Instance() {
+    // never destroyed, so that targets that outlive the static
+    // destructors could still unregister themselves safely.
+    static FlushTimer *timer = new FlushTimer();
+    return *timer;
+}
+
+void FlushTimer::Register(Target *target, chrono::milliseconds interval) {
+    lock_guard<mutex> lock(mutex_);
+    auto due = chrono::steady_clock::now() + interval;
+    auto it = find_if(entries_.begin(), entries_.end(),
+        [target](const entry_t& e) { return e.target == target; });
+    if (it != entries_.end()) {
+        it->interval = interval;
+        it->due = due;
+    } else {
+        entries_.push_back(entry_t{target, interval, due});
+    }
+    if (!started_) {
+        // the thread is started once, and kept joinable for Stop()
+        started_ = true;
+        thread_ = thread(&FlushTimer::run, this, generation_);
+    }
+    cv_.notify_all();
+}
+
+void FlushTimer::Unregister(Target *target) {
+    unique_lock<mutex> lock(mutex_);
+    entries_.erase(remove_if(entries_.begin(), entries_.end(),
+        [target](const entry_t& e) { return e.target == target; }), entries_.end());
+    // wait for an ongoing flush of the target, unless it unregisters
+    // itself while being flushed
+    if (this_thread::get_id() != thread_.get_id()) {
+        flushed_cv_.wait(lock, [this, target]() { return flushing_ != target; });
+    }
+}
+
+void FlushTimer::Stop() {
+    thread t;
+    {
+        lock_guard<mutex> lock(mutex_);
+        if (!started_) return;
+        started_ = false;
+        generation_++;
+        t = move(thread_);
+    }
+    cv_.notify_all();
+    t.join();
+}
+
+void FlushTimer::run(uint64_t generation) {
+    unique_lock<mutex> lock(mutex_);
+    while (generation == generation_) {
+        auto now = chrono::steady_clock::now();
+        auto due = find_if(entries_.begin(), entries_.end(),
+            [now](const entry_t& e) { return e.due <= now; });
+        if (due != entries_.end()) {
+            // flushed without the lock, so that a slow disk does not block
+            // the registrations; Unregister() waits for the flush instead.
+            Target *target = due->target;
+            flushing_ = target;
+            due->due = now + due->interval;
+            lock.unlock();
+            if (target->GetFlushPolicy().sync) {
+                target->Sync();
+            } else {
+                target->Flush();
+            }
+            lock.lock();
+            flushing_ = nullptr;
+            flushed_cv_.notify_all();
+            continue;
+        }
+        if (entries_.empty()) {
+            cv_.wait(lock);
+            continue;
+        }
+        auto next = min_element(entries_.begin(), entries_.end(),
+            [](const entry_t& a, const entry_t& b) { return a.due < b.due; })->due;
+        // woken up early when the entries change
+        cv_.wait_until(lock, next);
+    }
+}
+
+} // namespace slog
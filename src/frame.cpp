@@ -0,0 +1,253 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <slog/frame.h>
+#include <slog/crc32c.h>
+#include <slog/file_exception.h>
+
+using namespace std;
+
+namespace slog {
+
+namespace {
+
+// size of the blocks read while scanning
+const size_t block_size = 64 * 1024;
+
+void put_u32(char *p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = static_cast<char>(v >> (8 * i));
+}
+
+void put_u64(char *p, uint64_t v) {
+    for (int i = 0; i < 8; i++) p[i] = static_cast<char>(v >> (8 * i));
+}
+
+uint32_t get_u32(const char *p) {
+    uint32_t v = 0;
+    for (int i = 3; i >= 0; i--) v = (v << 8) | static_cast<unsigned char>(p[i]);
+    return v;
+}
+
+uint64_t get_u64(const char *p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--) v = (v << 8) | static_cast<unsigned char>(p[i]);
+    return v;
+}
+
+// checksum returns the CRC of the header fields and the payload
+uint32_t checksum(const char *header, const char *payload, size_t len) {
+    return crc32c(crc32c(0, header + 4, 16), payload, len);
+}
+
+bool read_at(int fd, char *buf, size_t len, uint64_t offset) {
+    while (len) {
+        ssize_t n = pread(fd, buf, len, offset);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        buf += n;
+        len -= n;
+        offset += n;
+    }
+    return true;
+}
+
+// frame_at checks if there is a valid frame at offset of the file
+// of the given size, and returns its end and sequence number.
+bool frame_at(int fd, uint64_t offset, uint64_t size, uint64_t& end, uint64_t& seq) {
+    char header[FrameHeaderSize];
+    if (offset + FrameHeaderSize > size || !read_at(fd, header, sizeof(header), offset) ||
+        memcmp(header, FrameMagic, sizeof(FrameMagic)) != 0) {
+        return false;
+    }
+    uint32_t len = get_u32(header + 4);
+    if (len > MaxFrameSize || offset + FrameHeaderSize + len > size) {
+        return false;
+    }
+    uint32_t crc = crc32c(0, header + 4, 16);
+    vector<char> buf(len < block_size ? len : block_size);
+    for (uint64_t pos = offset + FrameHeaderSize, left = len; left; ) {
+        size_t n = left < buf.size() ? left : buf.size();
+        if (!read_at(fd, buf.data(), n, pos)) return false;
+        crc = crc32c(crc, buf.data(), n);
+        pos += n;
+        left -= n;
+    }
+    if (crc != get_u32(header + 20)) {
+        return false;
+    }
+    end = offset + FrameHeaderSize + len;
+    seq = get_u64(header + 8);
+    return true;
+}
+
+} // namespace
+
+void encode_frame_header(char *out, uint64_t seq, LogLevel::level_t level,
+                         const struct iovec *parts, int nparts) {
+    size_t len = 0;
+    for (int i = 0; i < nparts; i++) {
+        len += parts[i].iov_len;
+    }
+    memcpy(out, FrameMagic, sizeof(FrameMagic));
+    put_u32(out + 4, static_cast<uint32_t>(len));
+    put_u64(out + 8, seq);
+    out[16] = static_cast<char>(level);
+    out[17] = out[18] = out[19] = 0;
+    uint32_t crc = crc32c(0, out + 4, 16);
+    for (int i = 0; i < nparts; i++) {
+        crc = crc32c(crc, parts[i].iov_base, parts[i].iov_len);
+    }
+    put_u32(out + 20, crc);
+}
+
+FrameRecovery recover_frames(const string& path, bool truncate) {
+    FrameRecovery r;
+    int fd = open(path.c_str(), truncate ? O_RDWR : O_RDONLY);
+    if (fd < 0) {
+        if (errno == ENOENT) return r;
+        throw FileException{path, "Failed to open log file"};
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        throw FileException{path, "Failed to open log file"};
+    }
+    r.size = st.st_size;
+    if (r.size == 0) {
+        close(fd);
+        return r;
+    }
+    char head[sizeof(FrameMagic)];
+    size_t head_len = r.size < sizeof(head) ? r.size : sizeof(head);
+    if (!read_at(fd, head, head_len, 0) || memcmp(head, FrameMagic, head_len) != 0) {
+        close(fd);
+        throw FileException{path, "Not a framed log file"};
+    }
+    if (head_len < sizeof(head)) {
+        // the first frame was torn within its magic
+        if (truncate && ftruncate(fd, 0) != 0) {
+            close(fd);
+            throw FileException{path, "Failed to truncate the damaged log file tail"};
+        }
+        close(fd);
+        return r;
+    }
+
+    // look for the last frame start with a valid checksum, a block at a
+    // time from the end. The blocks overlap by the magic size, so that
+    // the magics across the block boundaries are found too.
+    vector<char> buf(block_size + sizeof(FrameMagic));
+    bool found = false;
+    for (uint64_t hi = r.size; hi > 0 && !found; ) {
+        uint64_t lo = hi > block_size ? hi - block_size : 0;
+        uint64_t end = hi + sizeof(FrameMagic) - 1 < r.size ? hi + sizeof(FrameMagic) - 1 : r.size;
+        if (!read_at(fd, buf.data(), end - lo, lo)) {
+            close(fd);
+            throw FileException{path, "Failed to read log file"};
+        }
+        for (uint64_t p = hi; p-- > lo; ) {
+            if (p + sizeof(FrameMagic) > end || memcmp(&buf[p - lo], FrameMagic, sizeof(FrameMagic)) != 0) continue;
+            if (frame_at(fd, p, r.size, r.valid_end, r.last_seq)) {
+                found = true;
+                break;
+            }
+        }
+        hi = lo;
+    }
+
+    if (truncate && r.valid_end < r.size && ftruncate(fd, r.valid_end) != 0) {
+        close(fd);
+        throw FileException{path, "Failed to truncate the damaged log file tail"};
+    }
+    close(fd);
+    return r;
+}
+
+FrameReader::FrameReader(const string& path, uint64_t offset)
+    : buf_(block_size), offset_(offset) {
+    fd_ = open(path.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        throw FileException{path, "Failed to open log file"};
+    }
+}
+
+FrameReader::FrameReader(int fd, uint64_t offset)
+    : fd_(fd), buf_(block_size), offset_(offset) {}
+
+FrameReader::~FrameReader() {
+    close(fd_);
+}
+
+// fill makes sure that at least n unread bytes are buffered, returns
+// false if the file does not have that much data (yet).
+bool FrameReader::fill(size_t n) {
+    if (end_ - begin_ >= n) return true;
+    memmove(buf_.data(), buf_.data() + begin_, end_ - begin_);
+    end_ -= begin_;
+    begin_ = 0;
+    if (buf_.size() < n) buf_.resize(n);
+    while (end_ < n) {
+        ssize_t r = pread(fd_, buf_.data() + end_, buf_.size() - end_, offset_ + end_);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) return false;
+        end_ += r;
+    }
+    return true;
+}
+
+bool FrameReader::Next(Frame& frame) {
+    for (;;) {
+        if (!fill(FrameHeaderSize)) return false;
+        const char *h = buf_.data() + begin_;
+        bool complete = true;
+        if (memcmp(h, FrameMagic, sizeof(FrameMagic)) == 0) {
+            uint32_t len = get_u32(h + 4);
+            if (len <= MaxFrameSize) {
+                complete = fill(FrameHeaderSize + len);
+                h = buf_.data() + begin_;
+                if (complete && checksum(h, h + FrameHeaderSize, len) == get_u32(h + 20)) {
+                    frame.offset = offset_;
+                    frame.seq = get_u64(h + 8);
+                    frame.level = static_cast<LogLevel::level_t>(h[16]);
+                    frame.data = h + FrameHeaderSize;
+                    frame.len = len;
+                    begin_ += FrameHeaderSize + len;
+                    offset_ += FrameHeaderSize + len;
+                    return true;
+                }
+            }
+        }
+
+        // look for the next frame
+        const char *next = nullptr;
+        for (const char *p = h + 1; p + sizeof(FrameMagic) <= buf_.data() + end_; p++) {
+            p = static_cast<const char *>(memchr(p, FrameMagic[0], buf_.data() + end_ - p));
+            if (!p || p + sizeof(FrameMagic) > buf_.data() + end_) break;
+            if (memcmp(p, FrameMagic, sizeof(FrameMagic)) == 0) {
+                next = p;
+                break;
+            }
+        }
+        if (!complete && !next) {
+            // most likely a frame still being written
+            return false;
+        }
+        // keep the bytes which could be the start of the next magic
+        size_t skip = next ? next - h : (end_ - begin_ > sizeof(FrameMagic) ? end_ - begin_ - sizeof(FrameMagic) + 1 : 1);
+        begin_ += skip;
+        offset_ += skip;
+        skipped_ += skip;
+    }
+}
+
+} // namespace slog
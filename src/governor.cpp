@@ -0,0 +1,149 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#include <cstdio>
+#include <slog/governor.h>
+
+using namespace std;
+
+namespace slog {
+
+namespace {
+
+int64_t now_ns() {
+    return chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+template<typename Duration>
+int64_t to_ns(Duration d) {
+    return chrono::duration_cast<chrono::nanoseconds>(d).count();
+}
+
+} // namespace
+
+Governor::Governor(const GovernorOptions& options): options_(options) {
+    for (int l = 0; l < LogLevel::Max; l++) {
+        shed_[l].store(0, memory_order_relaxed);
+        shed_before_[l] = 0;
+    }
+}
+
+void Governor::Record(int64_t latency_ns) {
+    latency_ns_.fetch_add(latency_ns, memory_order_relaxed);
+    samples_.fetch_add(1, memory_order_relaxed);
+    int64_t now = now_ns();
+    if (now >= next_evaluation_.load(memory_order_relaxed)) {
+        evaluate(now);
+    }
+}
+
+void Governor::Shed(LogLevel::level_t level) {
+    if (level > LogLevel::None && level < LogLevel::Max) {
+        shed_[level].fetch_add(1, memory_order_relaxed);
+    }
+    // a target which gets only shed records recovers too
+    int64_t now = now_ns();
+    if (now >= next_evaluation_.load(memory_order_relaxed)) {
+        evaluate(now);
+    }
+}
+
+void Governor::SetLevel(LogLevel::level_t level) {
+    lock_guard<mutex> lock(mutex_);
+    level_ = level;
+    // while shedding, the admitted level only gets more severe
+    if (!episode_start_ || admitted_.load(memory_order_relaxed) > level) {
+        admitted_.store(level, memory_order_relaxed);
+    }
+}
+
+bool Governor::TakeReport(string& report) {
+    lock_guard<mutex> lock(mutex_);
+    if (!report_pending_.load(memory_order_relaxed)) return false;
+    report.swap(report_);
+    report_.clear();
+    report_pending_.store(false, memory_order_relaxed);
+    return true;
+}
+
+void Governor::report(const string& text) {
+    report_ = text;
+    report_pending_.store(true, memory_order_relaxed);
+}
+
+// evaluate averages the samples of the period that ended, and sheds or
+// restores a level. Concurrent callers leave it to the first one.
+void Governor::evaluate(int64_t now) {
+    unique_lock<mutex> lock(mutex_, try_to_lock);
+    if (!lock.owns_lock() || now < next_evaluation_.load(memory_order_relaxed)) return;
+    next_evaluation_.store(now + to_ns(options_.interval), memory_order_relaxed);
+
+    uint64_t n = samples_.exchange(0, memory_order_relaxed);
+    int64_t latency = latency_ns_.exchange(0, memory_order_relaxed);
+    int64_t wait = lock_wait_ns_.exchange(0, memory_order_relaxed);
+    if (n) {
+        latency /= static_cast<int64_t>(n);
+        wait /= static_cast<int64_t>(n);
+    } else {
+        // no writes, nothing to wait for
+        latency = wait = 0;
+    }
+    int64_t latency_limit = to_ns(options_.latency);
+    int64_t wait_limit = to_ns(options_.lock_wait);
+    LogLevel::level_t admitted = admitted_.load(memory_order_relaxed);
+    char text[256];
+
+    if (latency > latency_limit || wait > wait_limit) {
+        healthy_since_ = 0;
+        if (latency > peak_latency_ns_) peak_latency_ns_ = latency;
+        if (admitted < options_.floor || admitted <= LogLevel::None) return;
+        if (!episode_start_) {
+            episode_start_ = now;
+            peak_latency_ns_ = latency;
+            for (int l = 0; l < LogLevel::Max; l++) {
+                shed_before_[l] = shed_[l].load(memory_order_relaxed);
+            }
+            episodes_.fetch_add(1, memory_order_relaxed);
+            snprintf(text, sizeof(text), "slog: write latency %.3f ms, lock wait %.3f ms, shedding %s records",
+                     latency / 1e6, wait / 1e6, LogLevel(admitted).ToString().c_str());
+            report(text);
+        }
+        admitted_.store(static_cast<LogLevel::level_t>(admitted - 1), memory_order_relaxed);
+        return;
+    }
+
+    // hysteresis: recovering needs well below the thresholds
+    if (!episode_start_ || latency >= latency_limit / 2 || wait >= wait_limit / 2) {
+        healthy_since_ = 0;
+        return;
+    }
+    if (!healthy_since_) healthy_since_ = now;
+    if (now - healthy_since_ < to_ns(options_.recovery)) return;
+    healthy_since_ = now;
+    if (admitted < level_) {
+        admitted = static_cast<LogLevel::level_t>(admitted + 1);
+        admitted_.store(admitted, memory_order_relaxed);
+    }
+    if (admitted < level_) return;
+
+    // recovered, summarize what was shed
+    string shed;
+    for (int l = LogLevel::Trace; l > LogLevel::None; l--) {
+        uint64_t count = shed_[l].load(memory_order_relaxed) - shed_before_[l];
+        if (!count) continue;
+        if (!shed.empty()) shed += ", ";
+        shed += to_string(count) + " " + LogLevel(l).ToString();
+    }
+    snprintf(text, sizeof(text), "slog: write pressure over after %.3f s (peak latency %.3f ms), shed %s records",
+             (now - episode_start_) / 1e9, peak_latency_ns_ / 1e6, shed.empty() ? "no" : shed.c_str());
+    report(text);
+    episode_start_ = 0;
+}
+
+} // namespace slog
@@ -0,0 +1,288 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <slog/log_reader.h>
+#include <slog/file_exception.h>
+#include <slog/utils.h>
+
+using namespace std;
+
+namespace slog {
+
+namespace {
+
+// size of the chunks the text files are read in
+const size_t chunk_size = 64 * 1024;
+
+} // namespace
+
+bool ReaderCheckpoint::Load(const string& path) {
+    FILE *fp = fopen(path.c_str(), "r");
+    if (!fp) return false;
+    unsigned long long inode, offset;
+    bool ok = fscanf(fp, "%llu %llu", &inode, &offset) == 2;
+    fclose(fp);
+    if (ok) {
+        this->inode = inode;
+        this->offset = offset;
+    }
+    return ok;
+}
+
+bool ReaderCheckpoint::Save(const string& path) const {
+    string tmp = path + ".tmp";
+    FILE *fp = fopen(tmp.c_str(), "w");
+    if (!fp) return false;
+    bool ok = fprintf(fp, "%llu %llu\n", static_cast<unsigned long long>(inode),
+                      static_cast<unsigned long long>(offset)) > 0;
+    ok = fclose(fp) == 0 && ok;
+    return ok && rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+LogReader::LogReader(const string& path, const ReaderCheckpoint& checkpoint)
+    : path_(path), dir_(utils::dirname(path)), checkpoint_(checkpoint) {
+    base_ = dir_.empty() ? path_ : path_.substr(dir_.size() + 1);
+    // watch the directory, to notice the files created by the rotations
+    inotify_fd_ = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+    if (inotify_fd_ >= 0 && inotify_add_watch(inotify_fd_, dir_.empty() ? "." : dir_.c_str(),
+            IN_MODIFY | IN_CREATE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE | IN_CLOSE_WRITE) < 0) {
+        // Wait() falls back to sleeping
+        ::close(inotify_fd_);
+        inotify_fd_ = -1;
+    }
+    open();
+}
+
+LogReader::~LogReader() {
+    close();
+    if (inotify_fd_ >= 0) ::close(inotify_fd_);
+}
+
+bool LogReader::open() {
+    int fd = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        if (errno == ENOENT) return false;
+        throw FileException{path_, "Failed to open log file"};
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw FileException{path_, "Failed to open log file"};
+    }
+    fd_ = fd;
+    inode_ = st.st_ino;
+    offset_ = 0;
+    if (checkpoint_.inode == inode_ && checkpoint_.offset <= static_cast<uint64_t>(st.st_size)) {
+        offset_ = checkpoint_.offset;
+    }
+    // the checkpoint applies to the first file opened only
+    checkpoint_ = ReaderCheckpoint{};
+    begin_ = end_ = 0;
+    format_ = format_unknown;
+    return true;
+}
+
+void LogReader::close() {
+    if (frames_) {
+        // the frame reader owns the descriptor
+        frames_.reset();
+    } else if (fd_ >= 0) {
+        ::close(fd_);
+    }
+    fd_ = -1;
+}
+
+bool LogReader::detect() {
+    // the text records start with '[', framed files with the magic
+    if (!fill(1)) return false;
+    if (buf_[begin_] == FrameMagic[0]) {
+        if (!fill(sizeof(FrameMagic))) return false;
+        if (memcmp(&buf_[begin_], FrameMagic, sizeof(FrameMagic)) == 0) {
+            format_ = format_framed;
+            frames_.reset(new FrameReader(fd_, offset_));
+            return true;
+        }
+    }
+    format_ = format_text;
+    return true;
+}
+
+bool LogReader::fill(size_t n) {
+    if (end_ - begin_ >= n) return true;
+    if (begin_) {
+        memmove(buf_.data(), buf_.data() + begin_, end_ - begin_);
+        end_ -= begin_;
+        begin_ = 0;
+    }
+    if (buf_.size() < n || buf_.size() < chunk_size) {
+        buf_.resize(n < chunk_size ? chunk_size : n);
+    }
+    while (end_ < n) {
+        if (end_ == buf_.size()) buf_.resize(buf_.size() * 2);
+        ssize_t r = pread(fd_, buf_.data() + end_, buf_.size() - end_, offset_ + end_);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) return false;
+        end_ += r;
+    }
+    return true;
+}
+
+bool LogReader::line_end(size_t from, size_t& end) {
+    for (;;) {
+        const char *p = end_ - begin_ > from ? static_cast<const char *>(
+            memchr(buf_.data() + begin_ + from, '\n', end_ - begin_ - from)) : nullptr;
+        if (p) {
+            end = p - buf_.data() - begin_;
+            return true;
+        }
+        // the buffer is compacted, keep the positions relative
+        from = end_ - begin_;
+        if (!fill(from + 1)) return false;
+    }
+}
+
+bool LogReader::read_text(LogRecord& record) {
+    size_t end; // line feed ending the record, relative to begin_
+    if (!line_end(0, end)) return false;
+    RecordFields f;
+    // the lines that are not in the record layout continue a record,
+    // unless there is none to continue
+    bool single = !parser_.Parse(buf_.data() + begin_, end, f);
+    while (!single) {
+        size_t next = end + 1;
+        if (!fill(next + 1)) {
+            // all written so far, the record is complete
+            break;
+        }
+        size_t next_end;
+        if (!line_end(next, next_end)) {
+            // a partial line, which completes the record only if
+            // it is the beginning of the next record
+            if (parser_.Parse(buf_.data() + begin_ + next, end_ - begin_ - next, f)) break;
+            return false;
+        }
+        if (parser_.Parse(buf_.data() + begin_ + next, next_end - next, f)) break;
+        // a continuation line
+        end = next_end;
+    }
+
+    const char *data = buf_.data() + begin_;
+    const char *nl = static_cast<const char *>(memchr(data, '\n', end + 1));
+    record = LogRecord{};
+    record.offset = offset_;
+    record.data = data;
+    record.len = end;
+    if (parser_.Parse(data, nl - data, record.fields)) {
+        record.fields.msg_len = data + end - record.fields.msg;
+    } else {
+        record.fields.msg = data;
+        record.fields.msg_len = end;
+    }
+    begin_ += end + 1;
+    offset_ += end + 1;
+    return true;
+}
+
+bool LogReader::Next(LogRecord& record) {
+    for (;;) {
+        if (fd_ >= 0) {
+            if (format_ == format_unknown && !detect()) {
+                if (!reopen()) return false;
+                continue;
+            }
+            if (format_ == format_framed) {
+                Frame f;
+                if (frames_->Next(f)) {
+                    record = LogRecord{};
+                    record.offset = f.offset;
+                    record.data = f.data;
+                    record.len = f.len && f.data[f.len-1] == '\n' ? f.len - 1 : f.len;
+                    record.fields.level = f.level;
+                    record.fields.msg = record.data;
+                    record.fields.msg_len = record.len;
+                    record.seq = f.seq;
+                    return true;
+                }
+            } else if (read_text(record)) {
+                return true;
+            }
+        }
+        if (!reopen()) return false;
+    }
+}
+
+// reopen checks if the file at the path was rotated or truncated, and
+// switches to it. Returns false if the current file is still to be read.
+bool LogReader::reopen() {
+    struct stat st;
+    if (stat(path_.c_str(), &st) != 0) {
+        // rotated, the new file is not created yet
+        return false;
+    }
+    if (fd_ < 0) {
+        return open();
+    }
+    uint64_t read = frames_ ? frames_->Offset() : offset_ + (end_ - begin_);
+    if (static_cast<uint64_t>(st.st_ino) != inode_) {
+        // what is left of the old file could not be completed any more
+        struct stat old;
+        if (fstat(fd_, &old) == 0 && static_cast<uint64_t>(old.st_size) > Checkpoint().offset) {
+            skipped_ += old.st_size - Checkpoint().offset;
+        }
+        close();
+        rotations_++;
+        return open();
+    }
+    if (static_cast<uint64_t>(st.st_size) < read) {
+        close();
+        truncations_++;
+        return open();
+    }
+    return false;
+}
+
+bool LogReader::Wait(int timeout_ms) {
+    if (inotify_fd_ < 0) {
+        poll(nullptr, 0, timeout_ms);
+        return true;
+    }
+    struct pollfd pfd = {inotify_fd_, POLLIN, 0};
+    int r;
+    while ((r = poll(&pfd, 1, timeout_ms)) < 0 && errno == EINTR) {}
+    if (r <= 0) return false;
+
+    bool changed = false;
+    alignas(struct inotify_event) char buf[4096];
+    ssize_t len;
+    while ((len = ::read(inotify_fd_, buf, sizeof(buf))) > 0) {
+        for (char *p = buf; p < buf + len; ) {
+            auto *event = reinterpret_cast<struct inotify_event *>(p);
+            if (event->len && base_ == event->name) changed = true;
+            p += sizeof(struct inotify_event) + event->len;
+        }
+    }
+    return changed;
+}
+
+ReaderCheckpoint LogReader::Checkpoint() const {
+    ReaderCheckpoint c;
+    if (fd_ < 0) return checkpoint_;
+    c.inode = inode_;
+    c.offset = frames_ ? frames_->Offset() : offset_;
+    return c;
+}
+
+} // namespace slog
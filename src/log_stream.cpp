@@ -0,0 +1,65 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#include <slog/log_stream.h>
+
+using namespace std;
+
+namespace slog {
+namespace detail {
+
+StringBuf::int_type StringBuf::overflow(int_type c) {
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+        out_ += traits_type::to_char_type(c);
+    }
+    return traits_type::not_eof(c);
+}
+
+streamsize StringBuf::xsputn(const char *s, streamsize n) {
+    out_.append(s, static_cast<size_t>(n));
+    return n;
+}
+
+StreamState::StreamState(): flags(os.flags()) {}
+
+namespace {
+
+StreamState& thread_stream() {
+    static thread_local StreamState state;
+    return state;
+}
+
+} // namespace
+
+StreamState *acquire_stream() {
+    StreamState *s = &thread_stream();
+    if (s->busy) {
+        // a record streamed while rendering another one
+        s = new StreamState;
+    } else {
+        s->text.clear();
+        s->os.clear();
+        s->os.flags(s->flags);
+        s->os.width(0);
+        s->os.precision(6);
+        s->os.fill(' ');
+    }
+    s->busy = true;
+    return s;
+}
+
+void release_stream(StreamState *s) {
+    if (s == &thread_stream()) {
+        s->busy = false;
+    } else {
+        delete s;
+    }
+}
+
+} // namespace detail
+} // namespace slog
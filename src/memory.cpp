@@ -0,0 +1,65 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#include <slog/memory.h>
+
+using namespace std;
+
+namespace slog {
+
+namespace {
+
+class NewDeleteResource: public MemoryResource {
+protected:
+    // operator new aligns for any type up to max_align_t
+    void *allocate(size_t bytes, size_t) override {
+        return ::operator new(bytes);
+    }
+
+    void deallocate(void *p, size_t, size_t) override {
+        ::operator delete(p);
+    }
+};
+
+} // namespace
+
+MemoryResource *DefaultMemoryResource() {
+    // never destroyed, buffers with static storage may outlive it
+    static MemoryResource *resource = new NewDeleteResource();
+    return resource;
+}
+
+MemoryAccount::MemoryAccount(size_t budget, shared_ptr<MemoryResource> upstream)
+    : budget_(budget), pressure_limit_(budget - budget / 4), upstream_(move(upstream)),
+      resource_(upstream_ ? upstream_.get() : DefaultMemoryResource()) {}
+
+void *MemoryAccount::allocate(size_t bytes, size_t align) {
+    size_t current = current_.fetch_add(bytes, memory_order_relaxed) + bytes;
+    if (budget_ && current > budget_) {
+        current_.fetch_sub(bytes, memory_order_relaxed);
+        refused_.fetch_add(1, memory_order_relaxed);
+        throw bad_alloc();
+    }
+    void *p;
+    try {
+        p = resource_->Allocate(bytes, align);
+    } catch (...) {
+        current_.fetch_sub(bytes, memory_order_relaxed);
+        throw;
+    }
+    size_t peak = peak_.load(memory_order_relaxed);
+    while (current > peak && !peak_.compare_exchange_weak(peak, current, memory_order_relaxed)) {}
+    return p;
+}
+
+void MemoryAccount::deallocate(void *p, size_t bytes, size_t align) {
+    resource_->Deallocate(p, bytes, align);
+    current_.fetch_sub(bytes, memory_order_relaxed);
+}
+
+} // namespace slog
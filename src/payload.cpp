@@ -0,0 +1,108 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#include <cstring>
+#include <slog/payload.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+namespace slog {
+
+namespace {
+
+const char hex_digits[] = "0123456789abcdef";
+
+// Column of the hex digits of the i-th byte of a line
+inline size_t hex_column(size_t i) {
+    return 10 + i * 3 + (i >= 8);
+}
+
+// line_prefix writes the line offset and blanks the rest of the line
+void line_prefix(char *line, size_t offset) {
+    for (int i = 7; i >= 0; i--, offset >>= 4) {
+        line[i] = hex_digits[offset & 0xf];
+    }
+    memset(line + 8, ' ', 52);
+    line[60] = '|';
+}
+
+#ifdef __SSE2__
+// full_line converts a line of 16 bytes, the hex digits of both the
+// nibbles of all the bytes are computed at once.
+void full_line(char *line, const unsigned char *p) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    const __m128i mask = _mm_set1_epi8(0x0f);
+    const __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), mask);
+    const __m128i lo = _mm_and_si128(v, mask);
+
+    // nibble n to its digit: '0' + n, plus 'a' - '0' - 10 for n > 9
+    const __m128i nine = _mm_set1_epi8(9);
+    const __m128i zero = _mm_set1_epi8('0');
+    const __m128i alpha = _mm_set1_epi8('a' - '0' - 10);
+    const __m128i hd = _mm_add_epi8(_mm_add_epi8(hi, zero), _mm_and_si128(_mm_cmpgt_epi8(hi, nine), alpha));
+    const __m128i ld = _mm_add_epi8(_mm_add_epi8(lo, zero), _mm_and_si128(_mm_cmpgt_epi8(lo, nine), alpha));
+
+    alignas(16) char digits[32];
+    _mm_store_si128(reinterpret_cast<__m128i *>(digits), _mm_unpacklo_epi8(hd, ld));
+    _mm_store_si128(reinterpret_cast<__m128i *>(digits + 16), _mm_unpackhi_epi8(hd, ld));
+    for (size_t i = 0; i < 16; i++) {
+        memcpy(line + hex_column(i), digits + i * 2, 2);
+    }
+
+    // printable ASCII is 0x20 - 0x7e, the bytes >= 0x80 are negative
+    // in the signed compare and so are not printable either
+    const __m128i printable = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(0x1f)),
+                                            _mm_cmplt_epi8(v, _mm_set1_epi8(0x7f)));
+    const __m128i text = _mm_or_si128(_mm_and_si128(printable, v),
+                                      _mm_andnot_si128(printable, _mm_set1_epi8('.')));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(line + 61), text);
+}
+#endif
+
+// partial_line converts a line of n <= 16 bytes
+void partial_line(char *line, const unsigned char *p, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        line[hex_column(i)] = hex_digits[p[i] >> 4];
+        line[hex_column(i) + 1] = hex_digits[p[i] & 0xf];
+        line[61 + i] = (p[i] >= 0x20 && p[i] < 0x7f) ? static_cast<char>(p[i]) : '.';
+    }
+}
+
+} // namespace
+
+void hexdump(string& out, const void *data, size_t size) {
+    const unsigned char *p = static_cast<const unsigned char *>(data);
+    size_t lines = (size + 15) / 16;
+    size_t base = out.size();
+    out.resize(base + lines * HexdumpLineSize);
+    char *line = &out[base];
+
+    for (size_t offset = 0; offset < size; offset += 16) {
+        size_t n = size - offset < 16 ? size - offset : 16;
+        line_prefix(line, offset);
+#ifdef __SSE2__
+        if (n == 16) {
+            full_line(line, p + offset);
+        } else {
+            partial_line(line, p + offset, n);
+        }
+#else
+        partial_line(line, p + offset, n);
+#endif
+        line[61 + n] = '|';
+        line[62 + n] = '\n';
+        line += 63 + n;
+    }
+    // the last line is shorter if it is not full
+    out.resize(line - out.data());
+}
+
+} // namespace slog
@@ -0,0 +1,109 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#include <cstring>
+#include <cstdlib>
+#include <slog/record_format.h>
+
+namespace slog {
+
+namespace {
+
+// length of the date time field, "Thu Nov  2 12:38:19 2023"
+const size_t datetime_len = 24;
+
+inline bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+inline int two_digits(const char *s) {
+    return (s[0] == ' ' ? 0 : (s[0] - '0') * 10) + (s[1] - '0');
+}
+
+int month_index(const char *s) {
+    static const char months[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+    for (int m = 0; m < 12; m++) {
+        if (memcmp(months + m * 3, s, 3) == 0) return m;
+    }
+    return -1;
+}
+
+} // namespace
+
+LogLevel::level_t RecordParser::ParseLevel(char c) {
+    switch (c) {
+    case 'C': return LogLevel::Critical;
+    case 'E': return LogLevel::Error;
+    case 'W': return LogLevel::Warning;
+    case 'I': return LogLevel::Info;
+    case 'D': return LogLevel::Debug;
+    case 'T': return LogLevel::Trace;
+    default: return LogLevel::Unknown;
+    }
+}
+
+bool RecordParser::ParseTime(const char *s, size_t len, std::time_t& t) {
+    if (len < datetime_len || s[3] != ' ' || s[7] != ' ' || s[13] != ':' || s[16] != ':' ||
+        !is_digit(s[9]) || !is_digit(s[11]) || !is_digit(s[12]) || !is_digit(s[14]) ||
+        !is_digit(s[15]) || !is_digit(s[17]) || !is_digit(s[18]) || !is_digit(s[20])) {
+        return false;
+    }
+
+    // month, day, hour and year identify the cached hour
+    char key[sizeof(hour_key_)] = {};
+    memcpy(key, s + 4, 6);
+    memcpy(key + 6, s + 11, 2);
+    memcpy(key + 8, s + 20, 4);
+    if (memcmp(key, hour_key_, sizeof(key)) != 0) {
+        // mktime() is expensive, convert only once per hour
+        struct tm tm{};
+        tm.tm_mon = month_index(s + 4);
+        if (tm.tm_mon < 0) return false;
+        tm.tm_mday = two_digits(s + 8);
+        tm.tm_hour = two_digits(s + 11);
+        tm.tm_year = atoi(s + 20) - 1900;
+        tm.tm_isdst = -1;
+        hour_time_ = mktime(&tm);
+        memcpy(hour_key_, key, sizeof(key));
+    }
+    t = hour_time_ + two_digits(s + 14) * 60 + two_digits(s + 17);
+    return true;
+}
+
+bool RecordParser::Parse(const char *line, size_t len, RecordFields& fields) {
+    const char *end = line + len;
+    // [<date time>]
+    if (len < datetime_len + 2 || line[0] != '[' || line[datetime_len + 1] != ']') {
+        return false;
+    }
+    if (!ParseTime(line + 1, datetime_len, fields.time)) {
+        return false;
+    }
+    // [<pid>]
+    const char *p = line + datetime_len + 2;
+    if (end - p < 3 || p[0] != ' ' || p[1] != '[') return false;
+    p += 2;
+    long pid = 0;
+    for (; p < end && is_digit(*p); p++) {
+        pid = pid * 10 + (*p - '0');
+    }
+    if (p == end || *p != ']') return false;
+    fields.pid = pid;
+    // [<level>]
+    p++;
+    if (end - p < 4 || p[0] != ' ' || p[1] != '[' || p[3] != ']') return false;
+    fields.level = ParseLevel(p[2]);
+    p += 4;
+    // message
+    if (p < end && *p == ' ') p++;
+    fields.msg = p;
+    fields.msg_len = end - p;
+    return true;
+}
+
+} // namespace slog
@@ -0,0 +1,291 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#include <cstring>
+#include <queue>
+#include <stdexcept>
+#include <slog/redactor.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+namespace slog {
+
+namespace {
+
+inline bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+inline bool is_alpha(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+inline unsigned char lower(unsigned char c) {
+    return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+inline unsigned char upper(unsigned char c) {
+    return (c >= 'a' && c <= 'z') ? c - ('a' - 'A') : c;
+}
+
+// is_delimiter returns if the character ends a masked value
+inline bool is_delimiter(char c) {
+    switch (c) {
+    case ' ': case '\t': case '\r': case '\n':
+    case ',': case ';': case '&': case '"': case '\'':
+        return true;
+    default:
+        return false;
+    }
+}
+
+// next_digit returns the position of the first digit from pos
+size_t next_digit(const char *data, size_t pos, size_t len) {
+#ifdef __SSE2__
+    const __m128i below = _mm_set1_epi8('0' - 1);
+    const __m128i above = _mm_set1_epi8('9' + 1);
+    for (; pos + 16 <= len; pos += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos));
+        int m = _mm_movemask_epi8(_mm_and_si128(_mm_cmpgt_epi8(v, below), _mm_cmplt_epi8(v, above)));
+        if (m) return pos + __builtin_ctz(m);
+    }
+#endif
+    while (pos < len && !is_digit(data[pos])) pos++;
+    return pos;
+}
+
+// luhn validates the check digit of the digits in [begin, end)
+bool luhn(const char *begin, const char *end) {
+    int sum = 0;
+    bool twice = false;
+    for (const char *p = end; p-- != begin; ) {
+        if (!is_digit(*p)) continue;
+        int d = *p - '0';
+        if (twice) {
+            d *= 2;
+            if (d > 9) d -= 9;
+        }
+        sum += d;
+        twice = !twice;
+    }
+    return sum % 10 == 0;
+}
+
+} // namespace
+
+Redactor::Redactor(const RedactorOptions& options): options_(options) {
+    memset(classes_, 0, sizeof(classes_));
+    memset(first_, 0, sizeof(first_));
+    auto fold = [this](unsigned char c) {
+        return options_.ignore_case ? lower(c) : c;
+    };
+
+    // keys without the trailing '*', and the byte classes
+    vector<string> keys;
+    for (auto &p : options_.patterns) {
+        bool value = !p.empty() && p[p.size()-1] == '*';
+        string key = value ? p.substr(0, p.size() - 1) : p;
+        if (key.empty()) {
+            throw invalid_argument("empty redaction pattern");
+        }
+        for (unsigned char c : key) {
+            c = fold(c);
+            if (!classes_[c]) classes_[c] = static_cast<uint16_t>(nclasses_++);
+            if (options_.ignore_case) classes_[upper(c)] = classes_[c];
+        }
+        patterns_.push_back(pattern_t{key.size(), value});
+        keys.push_back(key);
+    }
+
+    // the trie of the keys
+    vector<vector<int32_t> > go(1, vector<int32_t>(nclasses_, -1));
+    output_.assign(1, -1);
+    for (size_t i = 0; i < keys.size(); i++) {
+        int32_t s = 0;
+        for (unsigned char c : keys[i]) {
+            uint16_t cl = classes_[c];
+            if (go[s][cl] < 0) {
+                go[s][cl] = static_cast<int32_t>(go.size());
+                go.emplace_back(nclasses_, -1);
+                output_.push_back(-1);
+            }
+            s = go[s][cl];
+        }
+        if (output_[s] < 0) output_[s] = static_cast<int32_t>(i);
+        unsigned char c = keys[i][0];
+        first_[c] = true;
+        if (options_.ignore_case) {
+            first_[lower(c)] = first_[upper(c)] = true;
+        }
+    }
+
+    // complete the transitions with the failure links, breadth first
+    vector<int32_t> fail(go.size(), 0);
+    next_.assign(go.size(), -1);
+    queue<int32_t> q;
+    for (size_t cl = 0; cl < nclasses_; cl++) {
+        if (go[0][cl] < 0) {
+            go[0][cl] = 0;
+        } else {
+            q.push(go[0][cl]);
+        }
+    }
+    while (!q.empty()) {
+        int32_t s = q.front();
+        q.pop();
+        for (size_t cl = 0; cl < nclasses_; cl++) {
+            int32_t t = go[s][cl];
+            if (t < 0) {
+                go[s][cl] = go[fail[s]][cl];
+                continue;
+            }
+            fail[t] = go[fail[s]][cl];
+            next_[t] = output_[fail[t]] >= 0 ? fail[t] : next_[fail[t]];
+            q.push(t);
+        }
+    }
+
+    delta_.reserve(go.size() * nclasses_);
+    for (auto &row : go) {
+        delta_.insert(delta_.end(), row.begin(), row.end());
+    }
+    // the prefilter needs the first two bytes of all the patterns
+    uint8_t fold_bits = options_.ignore_case ? 0x20 : 0;
+    for (auto &key : keys) {
+        if (key.size() < 2) {
+            heads_.clear();
+            break;
+        }
+        uint8_t a = static_cast<uint8_t>(key[0]) | fold_bits;
+        uint8_t b = static_cast<uint8_t>(key[1]) | fold_bits;
+        bool found = false;
+        for (size_t i = 0; i < heads_.size(); i += 2) {
+            found = found || (heads_[i] == a && heads_[i+1] == b);
+        }
+        if (!found) {
+            heads_.push_back(a);
+            heads_.push_back(b);
+        }
+    }
+}
+
+size_t Redactor::Redact(char *data, size_t len) const {
+    size_t masked = 0;
+    if (!patterns_.empty()) {
+        masked += scan_patterns(data, len);
+    }
+    if (options_.card_numbers) {
+        masked += scan_card_numbers(data, len);
+    }
+    return masked;
+}
+
+// next_candidate returns the position of the first byte from pos which
+// could start a match, the automaton stays in its root state until then.
+// The SIMD prefilter compares the byte pairs of 16 positions at once
+// with the first two bytes of the patterns. Folding the case with 0x20
+// folds some punctuation too, which only adds false candidates.
+size_t Redactor::next_candidate(const char *data, size_t pos, size_t len) const {
+#ifdef __SSE2__
+    size_t n = heads_.size() / 2;
+    if (n && n <= 16) {
+        const __m128i fold = _mm_set1_epi8(options_.ignore_case ? 0x20 : 0);
+        __m128i first[16], second[16];
+        for (size_t i = 0; i < n; i++) {
+            first[i] = _mm_set1_epi8(static_cast<char>(heads_[2*i]));
+            second[i] = _mm_set1_epi8(static_cast<char>(heads_[2*i+1]));
+        }
+        for (; pos + 17 <= len; pos += 16) {
+            __m128i v0 = _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos)), fold);
+            __m128i v1 = _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos + 1)), fold);
+            __m128i hits = _mm_setzero_si128();
+            for (size_t i = 0; i < n; i++) {
+                hits = _mm_or_si128(hits, _mm_and_si128(_mm_cmpeq_epi8(v0, first[i]), _mm_cmpeq_epi8(v1, second[i])));
+            }
+            int m = _mm_movemask_epi8(hits);
+            if (m) return pos + __builtin_ctz(m);
+        }
+    }
+#endif
+    while (pos < len && !first_[static_cast<unsigned char>(data[pos])]) pos++;
+    return pos;
+}
+
+size_t Redactor::scan_patterns(char *data, size_t len) const {
+    size_t masked = 0;
+    int32_t s = 0;
+    for (size_t pos = 0; pos < len; pos++) {
+        if (s == 0) {
+            pos = next_candidate(data, pos, len);
+            if (pos == len) break;
+        }
+        s = delta_[s * nclasses_ + classes_[static_cast<unsigned char>(data[pos])]];
+        // all the patterns ending here, the longest first
+        for (int32_t o = output_[s] >= 0 ? s : next_[s]; o >= 0; o = next_[o]) {
+            const pattern_t &p = patterns_[output_[o]];
+            if (p.value) {
+                size_t end = pos + 1;
+                while (end < len && !is_delimiter(data[end])) {
+                    data[end++] = options_.mask;
+                }
+                if (end > pos + 1) masked++;
+                // continue after the value
+                pos = end - 1;
+                s = 0;
+                break;
+            }
+            memset(data + pos + 1 - p.len, options_.mask, p.len);
+            masked++;
+        }
+    }
+    return masked;
+}
+
+size_t Redactor::scan_card_numbers(char *data, size_t len) const {
+    size_t masked = 0;
+    size_t pos = 0;
+    while ((pos = next_digit(data, pos, len)) < len) {
+        // a run of digits, the groups separated by a space or a dash
+        // must have 4 to 6 digits, but the last one
+        size_t start = pos, end = pos, digits = 0, group = 0;
+        bool valid = true;
+        for (size_t i = pos; i < len; i++) {
+            if (is_digit(data[i])) {
+                digits++;
+                group++;
+                end = i + 1;
+            } else if ((data[i] == ' ' || data[i] == '-') && i + 1 < len && is_digit(data[i+1])) {
+                if (group < 4 || group > 6) valid = false;
+                group = 0;
+            } else {
+                break;
+            }
+        }
+        pos = end;
+        if (!valid || digits < 13 || digits > 19 ||
+            (start > 0 && (is_alpha(data[start-1]) || is_digit(data[start-1]))) ||
+            (end < len && is_alpha(data[end])) || !luhn(data + start, data + end)) {
+            continue;
+        }
+        // keep the last 4 digits
+        size_t keep = digits - 4;
+        for (size_t i = start; keep; i++) {
+            if (is_digit(data[i])) {
+                data[i] = options_.mask;
+                keep--;
+            }
+        }
+        masked++;
+    }
+    return masked;
+}
+
+} // namespace slog
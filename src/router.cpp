@@ -0,0 +1,58 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#include <slog/router.h>
+
+using namespace std;
+
+namespace slog {
+
+atomic<uint64_t> routing_epoch{1};
+
+Router& Router::Instance() {
+    // never destroyed, loggers with static storage may still use it
+    static Router *router = new Router();
+    return *router;
+}
+
+void Router::Add(Route route) {
+    lock_guard<mutex> lock(mutex_);
+    routes_.push_back(move(route));
+    routing_epoch.fetch_add(1, memory_order_release);
+}
+
+void Router::Remove(const shared_ptr<Target>& target) {
+    lock_guard<mutex> lock(mutex_);
+    for (auto it = routes_.begin(); it != routes_.end(); ) {
+        if (it->target == target) {
+            it = routes_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    routing_epoch.fetch_add(1, memory_order_release);
+}
+
+void Router::Clear() {
+    lock_guard<mutex> lock(mutex_);
+    routes_.clear();
+    routing_epoch.fetch_add(1, memory_order_release);
+}
+
+vector<Route> Router::Match(const string& name) const {
+    lock_guard<mutex> lock(mutex_);
+    vector<Route> matched;
+    for (auto &r : routes_) {
+        if (name.compare(0, r.prefix.size(), r.prefix) == 0) {
+            matched.push_back(r);
+        }
+    }
+    return matched;
+}
+
+} // namespace slog
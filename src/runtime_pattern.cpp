@@ -0,0 +1,185 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#include <atomic>
+#include <ctime>
+#include <slog/runtime_pattern.h>
+
+using namespace std;
+
+namespace slog {
+
+const char *const RuntimePattern::DefaultPatternString = "[%c] [%p] [%L] %v";
+
+namespace {
+
+using op_t = RuntimePattern::op_t;
+
+void op_literal(string& out, const pattern::Record&, const op_t& op) {
+    out.append(op.text);
+}
+
+// op_time renders the strftime() format of the op, the result is
+// cached per thread until the second changes.
+void op_time(string& out, const pattern::Record& r, const op_t& op) {
+    struct entry_t {
+        uint64_t id;
+        time_t sec;
+        size_t len;
+        char text[256];
+    };
+    static thread_local entry_t cache[4];
+    entry_t &e = cache[op.id & 3];
+    time_t t = chrono::system_clock::to_time_t(r.time);
+    if (e.id != op.id || e.sec != t) {
+        tm tm;
+        localtime_r(&t, &tm);
+        e.len = strftime(e.text, sizeof(e.text), op.text.c_str(), &tm);
+        e.id = op.id;
+        e.sec = t;
+    }
+    out.append(e.text, e.len);
+}
+
+// op_fraction renders the fraction of second in the given precision,
+// a template for the divisions by a constant
+template <typename Precision>
+void op_fraction(string& out, const pattern::Record& r, const op_t& op) {
+    auto since = r.time.time_since_epoch();
+    auto fraction = chrono::duration_cast<Precision>(since - chrono::duration_cast<chrono::seconds>(since));
+    pattern::detail::append_uint(out, static_cast<uint64_t>(fraction.count()),
+                                 pattern::detail::fraction_digits(Precision::period::den));
+    out.append(op.text);
+}
+
+void op_pid(string& out, const pattern::Record&, const op_t& op) {
+    pattern::detail::append_uint(out, static_cast<uint64_t>(ThreadContext::Current().Pid()));
+    out.append(op.text);
+}
+
+void op_tid(string& out, const pattern::Record&, const op_t& op) {
+    pattern::detail::append_uint(out, static_cast<uint64_t>(ThreadContext::Current().Tid()));
+    out.append(op.text);
+}
+
+void op_thread_number(string& out, const pattern::Record&, const op_t& op) {
+    pattern::detail::append_uint(out, ThreadContext::Current().Number());
+    out.append(op.text);
+}
+
+void op_thread_name(string& out, const pattern::Record&, const op_t& op) {
+    const ThreadContext& context = ThreadContext::Current();
+    if (context.Name().empty()) {
+        pattern::detail::append_uint(out, context.Number());
+    } else {
+        out.append(context.Name());
+    }
+    out.append(op.text);
+}
+
+void op_mdc(string& out, const pattern::Record&, const op_t& op) {
+    out.append(ThreadContext::Current().Mdc());
+    out.append(op.text);
+}
+
+void op_level_name(string& out, const pattern::Record& r, const op_t& op) {
+    static const char *const names[LogLevel::Max] = {
+        "none", "critical", "error", "warning", "info", "debug", "trace"
+    };
+    out.append((r.level >= LogLevel::None && r.level < LogLevel::Max) ? names[r.level] : "unknown");
+    out.append(op.text);
+}
+
+void op_level_char(string& out, const pattern::Record& r, const op_t& op) {
+    out += LogLevel(r.level).ToChar();
+    out.append(op.text);
+}
+
+void op_name(string& out, const pattern::Record& r, const op_t& op) {
+    out.append(r.name);
+    out.append(op.text);
+}
+
+} // namespace
+
+RuntimePattern::RuntimePattern(const string& pattern): pattern_(pattern) {
+    compile();
+}
+
+void RuntimePattern::compile() {
+    static atomic<uint64_t> next_id{1};
+    string literal, time_format;
+
+    auto flush = [&]() {
+        if (!time_format.empty()) {
+            ops_.push_back(op_t{op_time, time_format, next_id++});
+            time_format.clear();
+        }
+        if (!literal.empty()) {
+            // rendered by the preceding op, saving a call per literal
+            if (ops_.empty()) {
+                ops_.push_back(op_t{op_literal, literal, 0});
+            } else {
+                ops_.back().text += literal;
+            }
+            literal.clear();
+        }
+    };
+    auto add_literal = [&](char c) {
+        // literals following a strftime() conversion are rendered with it
+        if (time_format.empty()) {
+            literal += c;
+        } else {
+            time_format += c;
+            if (c == '%') time_format += '%';
+        }
+    };
+    auto add_op = [&](void (*fn)(string&, const pattern::Record&, const op_t&)) {
+        flush();
+        ops_.push_back(op_t{fn, string(), 0});
+    };
+
+    for (size_t i = 0; i < pattern_.size(); i++) {
+        char c = pattern_[i];
+        if (c != '%' || i + 1 == pattern_.size()) {
+            add_literal(c);
+            continue;
+        }
+        c = pattern_[++i];
+        switch (c) {
+        case '%': add_literal('%'); break;
+        case 'v': add_op(nullptr); break;
+        case 'n': add_op(op_name); break;
+        case 'l': add_op(op_level_name); break;
+        case 'L': add_op(op_level_char); break;
+        case 'p': add_op(op_pid); break;
+        case 't': add_op(op_tid); break;
+        case 'i': add_op(op_thread_number); break;
+        case 'N': add_op(op_thread_name); break;
+        case 'K': add_op(op_mdc); break;
+        case 'e': add_op(op_fraction<chrono::milliseconds>); break;
+        case 'f': add_op(op_fraction<chrono::microseconds>); break;
+        case 'F': add_op(op_fraction<chrono::nanoseconds>); break;
+        default:
+            // a strftime() conversion, merged with the preceding literals
+            for (char l : literal) {
+                time_format += l;
+                if (l == '%') time_format += '%';
+            }
+            literal.clear();
+            time_format += '%';
+            time_format += c;
+            if ((c == 'E' || c == 'O') && i + 1 < pattern_.size()) {
+                time_format += pattern_[++i];
+            }
+        }
+    }
+    flush();
+}
+
+} // namespace slog
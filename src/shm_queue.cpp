@@ -0,0 +1,422 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <cerrno>
+#include <cstring>
+#include <cstddef>
+#include <slog/shm_queue.h>
+#include <slog/file_exception.h>
+#include <slog/thread_context.h>
+
+using namespace std;
+
+namespace slog {
+
+namespace {
+
+const uint32_t shm_magic = 0x534c4751; // "SLGQ"
+const uint32_t shm_version = 1;
+const size_t cache_line = 64;
+
+// flags of the slot sequence numbers, the tickets never reach them
+const uint64_t abandoned_bit = uint64_t(1) << 63;
+const uint64_t committing_bit = uint64_t(1) << 62;
+const uint64_t seq_flags = abandoned_bit | committing_bit;
+
+// failed attempts to take a slot from its owner in Claim(), before
+// checking if the owner died before moving the head past it
+const int claim_spins = 1024;
+
+inline size_t align_up(size_t n, size_t a) {
+    return (n + a - 1) & ~(a - 1);
+}
+
+inline uint32_t round_pow2(uint32_t n) {
+    uint32_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+inline string shm_path(const string& name) {
+    return (!name.empty() && name[0] == '/') ? name : "/" + name;
+}
+
+// process_gone reports if the process exited
+inline bool process_gone(pid_t pid) {
+    return pid > 0 && ::kill(pid, 0) != 0 && errno == ESRCH;
+}
+
+} // namespace
+
+// Layout of the queue header at the beginning of the shared memory.
+// Only lock-free atomics are placed in the shared memory so that
+// they are address-free and work across processes.
+struct ShmQueue::header_t {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slot_count;  // always a power of two
+    uint32_t slot_size;   // payload bytes per slot
+    atomic<uint32_t> ready;
+    alignas(cache_line) atomic<uint64_t> head; // next ticket to claim
+    alignas(cache_line) atomic<uint64_t> tail; // next ticket to consume
+    atomic<uint64_t> dropped;
+    atomic<uint64_t> abandoned;
+};
+
+// Record slot, followed by slot_size bytes of payload.
+// The slot of ticket t is free when seq == t, claimed when the head
+// has moved past t while seq is still t (its owner is recorded before
+// the head moves, so that a claimed slot always has one), being committed by its owner
+// when seq == t|committing_bit, and published when seq == t+1.
+// A slot that the collector gave up on while its owner is alive is
+// held with seq == t|abandoned_bit, until the owner commits it late or
+// exits, as the owner could still write into it.
+struct ShmQueue::slot_t {
+    atomic<uint64_t> seq;
+    atomic<int32_t> owner; // pid of the producer that claimed the slot
+    uint32_t level;
+    uint32_t length;
+    char data[1];
+};
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "ShmQueue needs lock-free 64-bit atomics");
+
+ShmQueue::ShmQueue(const string& name, uint32_t slots, uint32_t slot_size)
+    : name_(shm_path(name)) {
+    bool creator = true;
+    fd_ = shm_open(name_.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd_ < 0 && errno == EEXIST) {
+        creator = false;
+        fd_ = shm_open(name_.c_str(), O_RDWR, 0600);
+    }
+    if (fd_ < 0) {
+        throw FileException{name_, "Failed to open shared memory queue"};
+    }
+
+    size_t header_size = align_up(sizeof(header_t), cache_line);
+    if (creator) {
+        slots = round_pow2(slots ? slots : DefaultSlots);
+        slot_size = slot_size ? slot_size : DefaultSlotSize;
+        stride_ = align_up(offsetof(slot_t, data) + slot_size, cache_line);
+        size_ = header_size + stride_ * slots;
+        if (ftruncate(fd_, size_) != 0) {
+            ::close(fd_);
+            shm_unlink(name_.c_str());
+            throw FileException{name_, "Failed to size shared memory queue"};
+        }
+    } else {
+        // wait for the creator to finish sizing the queue
+        struct stat info;
+        for (int i = 0; ; i++) {
+            if (fstat(fd_, &info) != 0 || i == 1000) {
+                ::close(fd_);
+                throw FileException{name_, "Shared memory queue is not initialized"};
+            }
+            if (static_cast<size_t>(info.st_size) >= header_size) break;
+            this_thread::sleep_for(chrono::milliseconds(1));
+        }
+        size_ = info.st_size;
+    }
+
+    base_ = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (base_ == MAP_FAILED) {
+        base_ = nullptr;
+        ::close(fd_);
+        throw FileException{name_, "Failed to map shared memory queue"};
+    }
+    header_ = static_cast<header_t *>(base_);
+
+    if (creator) {
+        header_->magic = shm_magic;
+        header_->version = shm_version;
+        header_->slot_count = slots;
+        header_->slot_size = slot_size;
+        header_->head.store(0, memory_order_relaxed);
+        header_->tail.store(0, memory_order_relaxed);
+        header_->dropped.store(0, memory_order_relaxed);
+        header_->abandoned.store(0, memory_order_relaxed);
+        for (uint64_t i = 0; i < slots; i++) {
+            slot_t *slot = reinterpret_cast<slot_t *>(
+                static_cast<char *>(base_) + header_size + stride_ * i);
+            slot->seq.store(i, memory_order_relaxed);
+            slot->owner.store(0, memory_order_relaxed);
+        }
+        header_->ready.store(1, memory_order_release);
+        return;
+    }
+
+    for (int i = 0; header_->ready.load(memory_order_acquire) != 1; i++) {
+        if (i == 1000) {
+            unmap();
+            throw FileException{name_, "Shared memory queue is not initialized"};
+        }
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    if (header_->magic != shm_magic || header_->version != shm_version) {
+        unmap();
+        throw FileException{name_, "Not a slog shared memory queue"};
+    }
+    stride_ = align_up(offsetof(slot_t, data) + header_->slot_size, cache_line);
+    if (header_size + stride_ * header_->slot_count > size_) {
+        unmap();
+        throw FileException{name_, "Shared memory queue is truncated"};
+    }
+}
+
+ShmQueue::~ShmQueue() {
+    unmap();
+}
+
+void ShmQueue::unmap() {
+    if (base_) {
+        munmap(base_, size_);
+        base_ = nullptr;
+        header_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+bool ShmQueue::Unlink(const string& name) {
+    return shm_unlink(shm_path(name).c_str()) == 0;
+}
+
+uint32_t ShmQueue::Capacity() const {
+    return header_->slot_count;
+}
+
+uint32_t ShmQueue::SlotSize() const {
+    return header_->slot_size;
+}
+
+uint64_t ShmQueue::Dropped() const {
+    return header_->dropped.load(memory_order_relaxed);
+}
+
+uint64_t ShmQueue::Abandoned() const {
+    return header_->abandoned.load(memory_order_relaxed);
+}
+
+ShmQueue::slot_t *ShmQueue::slot_at(uint64_t ticket) const {
+    size_t index = ticket & (header_->slot_count - 1);
+    return reinterpret_cast<slot_t *>(static_cast<char *>(base_) +
+        align_up(sizeof(header_t), cache_line) + stride_ * index);
+}
+
+char *ShmQueue::Claim(uint64_t& ticket) {
+    const uint64_t slots = header_->slot_count;
+    const int32_t self = static_cast<int32_t>(ThreadContext::Current().Pid());
+    uint64_t pos = header_->head.load(memory_order_relaxed);
+    for (int spins = 0; ; ) {
+        slot_t *slot = slot_at(pos);
+        uint64_t seq = slot->seq.load(memory_order_acquire);
+        int64_t diff = static_cast<int64_t>(seq - pos);
+        if (seq & seq_flags) {
+            if ((seq & ~seq_flags) == pos - slots) {
+                // the slot of the previous lap is being committed, or
+                // held for a stalled producer: queue is full
+                header_->dropped.fetch_add(1, memory_order_relaxed);
+                return nullptr;
+            }
+            // the slot of this lap is being committed, the head moved on
+            pos = header_->head.load(memory_order_relaxed);
+        } else if (diff == 0) {
+            // own the slot first, then move the head past it
+            int32_t owner = 0;
+            if (slot->owner.compare_exchange_strong(owner, self, memory_order_acq_rel, memory_order_relaxed)) {
+                uint64_t expected = pos;
+                if (header_->head.compare_exchange_strong(expected, pos + 1, memory_order_acq_rel,
+                                                          memory_order_relaxed)) {
+                    ticket = pos;
+                    return slot->data;
+                }
+                // the slot was claimed and released for the next lap meanwhile
+                slot->owner.store(0, memory_order_release);
+                pos = expected;
+            } else {
+                uint64_t head = header_->head.load(memory_order_acquire);
+                if (head != pos) {
+                    // claimed by its owner meanwhile
+                    pos = head;
+                } else if (++spins == claim_spins) {
+                    spins = 0;
+                    if (!process_gone(owner)) {
+                        // the owner is slow to move the head: queue is busy
+                        header_->dropped.fetch_add(1, memory_order_relaxed);
+                        return nullptr;
+                    }
+                    // the owner died before moving the head past the slot
+                    slot->owner.compare_exchange_strong(owner, 0, memory_order_acq_rel, memory_order_relaxed);
+                }
+            }
+        } else if (diff < 0) {
+            // the collector has not yet consumed this slot: queue is full
+            header_->dropped.fetch_add(1, memory_order_relaxed);
+            return nullptr;
+        } else {
+            pos = header_->head.load(memory_order_relaxed);
+        }
+    }
+}
+
+bool ShmQueue::Commit(uint64_t ticket, LogLevel::level_t level, size_t len) {
+    slot_t *slot = slot_at(ticket);
+    // take the slot for the commit, unless the collector gave up on it
+    // as we were stalled for too long, in which case the record is lost
+    uint64_t expected = ticket;
+    if (!slot->seq.compare_exchange_strong(expected, ticket | committing_bit,
+            memory_order_acquire, memory_order_acquire)) {
+        if (expected == (ticket | abandoned_bit)) {
+            // the slot was held for us, hand it over to the next lap
+            slot->owner.store(0, memory_order_relaxed);
+            slot->seq.compare_exchange_strong(expected, ticket + header_->slot_count,
+                memory_order_release, memory_order_relaxed);
+        }
+        return false;
+    }
+    slot->level = static_cast<uint32_t>(level);
+    slot->length = static_cast<uint32_t>(len < header_->slot_size ? len : header_->slot_size);
+    slot->seq.store(ticket + 1, memory_order_release);
+    return true;
+}
+
+bool ShmQueue::Push(LogLevel::level_t level, const char *msg, size_t len) {
+    uint64_t ticket;
+    char *data = Claim(ticket);
+    if (!data) return false;
+    if (len > header_->slot_size) len = header_->slot_size;
+    memcpy(data, msg, len);
+    return Commit(ticket, level, len);
+}
+
+// owner_gone reports if the producer that claimed the slot exited
+bool ShmQueue::owner_gone(const slot_t *slot) const {
+    return process_gone(slot->owner.load(memory_order_acquire));
+}
+
+// stalled reports if the slot of the given ticket has been waited
+// on for longer than the stale timeout.
+bool ShmQueue::stalled(uint64_t ticket) {
+    auto now = chrono::steady_clock::now();
+    if (stall_ticket_ != ticket) {
+        stall_ticket_ = ticket;
+        stall_since_ = now;
+    }
+    return now - stall_since_ >= stale_timeout_;
+}
+
+size_t ShmQueue::Drain(const drain_fn_t& fn, size_t max) {
+    size_t count = 0;
+    const uint64_t slots = header_->slot_count;
+    uint64_t tail = header_->tail.load(memory_order_relaxed);
+
+    while (count < max) {
+        slot_t *slot = slot_at(tail);
+        uint64_t seq = slot->seq.load(memory_order_acquire);
+        if (seq == tail + 1) {
+            fn(static_cast<LogLevel::level_t>(slot->level), slot->data, slot->length);
+            count++;
+            // release the slot for the next lap
+            slot->owner.store(0, memory_order_relaxed);
+            slot->seq.store(tail + slots, memory_order_release);
+            header_->tail.store(++tail, memory_order_release);
+        } else if (seq == ((tail - slots) | abandoned_bit)) {
+            // abandoned on the previous lap, the stalled producer frees
+            // it on its late commit, or it is freed once the producer exits
+            if (!owner_gone(slot)) break;
+            slot->owner.store(0, memory_order_relaxed);
+            slot->seq.compare_exchange_strong(seq, tail, memory_order_acq_rel, memory_order_acquire);
+        } else if (header_->head.load(memory_order_acquire) <= tail) {
+            // queue is empty
+            break;
+        } else if (owner_gone(slot)) {
+            // the producer exited before publishing: free the slot for
+            // the next lap, unless it published it meanwhile
+            slot->owner.store(0, memory_order_relaxed);
+            if (!slot->seq.compare_exchange_strong(seq, tail + slots,
+                    memory_order_acq_rel, memory_order_acquire)) {
+                continue;
+            }
+            header_->abandoned.fetch_add(1, memory_order_relaxed);
+            header_->tail.store(++tail, memory_order_release);
+        } else if (seq == tail && stalled(tail)) {
+            // the producer is stuck: skip the slot, but hold it as it
+            // could still write into it (see Commit())
+            if (!slot->seq.compare_exchange_strong(seq, tail | abandoned_bit,
+                    memory_order_acq_rel, memory_order_acquire)) {
+                continue;
+            }
+            header_->abandoned.fetch_add(1, memory_order_relaxed);
+            header_->tail.store(++tail, memory_order_release);
+        } else {
+            // slot is claimed but not yet published
+            break;
+        }
+    }
+    return count;
+}
+
+ShmCollector::ShmCollector(shared_ptr<ShmQueue> queue,
+                           vector<shared_ptr<Target> > targets,
+                           chrono::milliseconds poll_interval)
+    : queue_(move(queue)), targets_(move(targets)), poll_interval_(poll_interval) {}
+
+ShmCollector::~ShmCollector() {
+    Stop();
+}
+
+void ShmCollector::Start() {
+    if (running_.exchange(true)) return;
+    thread_ = thread(&ShmCollector::run, this);
+}
+
+void ShmCollector::Stop() {
+    if (!running_.exchange(false)) return;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    DrainOnce();
+    for (auto &t : targets_) {
+        t->Flush();
+    }
+}
+
+size_t ShmCollector::DrainOnce() {
+    return queue_->Drain([this](LogLevel::level_t level, const char *msg, size_t len) {
+        for (auto &t : targets_) {
+            t->Write(level, msg, len);
+        }
+    });
+}
+
+void ShmCollector::run() {
+    bool dirty = false;
+    while (running_.load(memory_order_relaxed)) {
+        if (DrainOnce() != 0) {
+            dirty = true;
+            continue;
+        }
+        // idle: push out whatever was written so far and back off
+        if (dirty) {
+            for (auto &t : targets_) {
+                t->Flush();
+            }
+            dirty = false;
+        }
+        this_thread::sleep_for(poll_interval_);
+    }
+}
+
+} // namespace slog
@@ -0,0 +1,63 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#include <slog/span.h>
+#include <slog/thread_context.h>
+
+using namespace std;
+
+namespace slog {
+
+SpanCollector::SpanCollector(sink_t sink): sink_(move(sink)) {
+    static atomic<uint64_t> next_id{1};
+    id_ = next_id++;
+}
+
+shared_ptr<SpanCollector::buffer_t> SpanCollector::make_buffer() {
+    auto b = make_shared<buffer_t>();
+    b->pid = ThreadContext::Current().Pid();
+    b->tid = ThreadContext::Current().Tid();
+    lock_guard<mutex> lock(mutex_);
+    buffers_.push_back(b);
+    return b;
+}
+
+void SpanCollector::drain_full(buffer_t *b) {
+    lock_guard<mutex> lock(mutex_);
+    drain(b);
+}
+
+// drain hands the spans of the buffer to the sink, must be called
+// with the mutex held.
+void SpanCollector::drain(buffer_t *b) {
+    size_t head = b->head.load(memory_order_acquire);
+    size_t tail = b->tail.load(memory_order_relaxed);
+    while (tail != head) {
+        // the spans up to the end of the ring are contiguous
+        size_t index = tail & (BufferSize - 1);
+        size_t n = min(head - tail, BufferSize - index);
+        if (sink_) sink_(b->events + index, n);
+        tail += n;
+    }
+    b->tail.store(tail, memory_order_release);
+}
+
+void SpanCollector::Drain() {
+    lock_guard<mutex> lock(mutex_);
+    for (auto it = buffers_.begin(); it != buffers_.end(); ) {
+        drain(it->get());
+        // forget the buffers of the exited threads
+        if (it->use_count() == 1) {
+            it = buffers_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+} // namespace slog
@@ -0,0 +1,109 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#include <slog/spill_buffer.h>
+
+using namespace std;
+
+namespace slog {
+
+SpillBuffer::SpillBuffer(size_t capacity, function<bool()> replay, chrono::milliseconds min_backoff,
+                         chrono::milliseconds max_backoff, MemoryResource *memory)
+    : capacity_(capacity), replay_(move(replay)), min_backoff_(min_backoff),
+      max_backoff_(max_backoff < min_backoff ? min_backoff : max_backoff), memory_(memory) {
+    thread_ = thread(&SpillBuffer::run, this);
+}
+
+SpillBuffer::~SpillBuffer() {
+    Stop();
+}
+
+void SpillBuffer::Stop() {
+    {
+        lock_guard<mutex> lock(mutex_);
+        if (stop_) return;
+        stop_ = true;
+    }
+    cv_.notify_one();
+    thread_.join();
+}
+
+bool SpillBuffer::Add(LogLevel::level_t level, const char *msg, size_t len) {
+    lock_guard<mutex> lock(mutex_);
+    if (bytes_ + len > capacity_) {
+        dropped_.fetch_add(1, memory_order_relaxed);
+        dropped_bytes_.fetch_add(len, memory_order_relaxed);
+        return false;
+    }
+    try {
+        records_.push_back(record_t{level, MemoryBuffer(msg, len, Allocator<char>(memory_))});
+    } catch (const bad_alloc&) {
+        dropped_.fetch_add(1, memory_order_relaxed);
+        dropped_bytes_.fetch_add(len, memory_order_relaxed);
+        return false;
+    }
+    bytes_ += len;
+    spilled_.fetch_add(1, memory_order_relaxed);
+    if (!active_.load(memory_order_relaxed)) {
+        active_.store(true, memory_order_release);
+        cv_.notify_one();
+    }
+    return true;
+}
+
+bool SpillBuffer::Drain(const write_fn_t& write_fn) {
+    for (;;) {
+        record_t r{LogLevel::None, MemoryBuffer(Allocator<char>(memory_))};
+        {
+            lock_guard<mutex> lock(mutex_);
+            if (records_.empty()) return true;
+            r = move(records_.front());
+            records_.pop_front();
+        }
+        // written outside of the lock, the records keep on being added
+        bool ok = write_fn(r.level, r.data.data(), r.data.size());
+        lock_guard<mutex> lock(mutex_);
+        if (!ok) {
+            records_.push_front(move(r));
+            return false;
+        }
+        bytes_ -= r.data.size();
+        replayed_.fetch_add(1, memory_order_relaxed);
+    }
+}
+
+size_t SpillBuffer::Bytes() const {
+    lock_guard<mutex> lock(mutex_);
+    return bytes_;
+}
+
+void SpillBuffer::run() {
+    auto backoff = min_backoff_;
+    unique_lock<mutex> lock(mutex_);
+    for (;;) {
+        cv_.wait(lock, [this]() { return stop_ || active_.load(memory_order_relaxed); });
+        // give the file some time to recover before every replay
+        cv_.wait_for(lock, backoff, [this]() { return stop_; });
+        if (stop_) break;
+
+        lock.unlock();
+        bool ok = replay_();
+        lock.lock();
+        if (!ok) {
+            retries_.fetch_add(1, memory_order_relaxed);
+            backoff = min(backoff * 2, max_backoff_);
+            continue;
+        }
+        backoff = min_backoff_;
+        if (records_.empty()) {
+            active_.store(false, memory_order_release);
+        }
+    }
+}
+
+} // namespace slog
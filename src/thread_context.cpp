@@ -0,0 +1,120 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#include <sys/syscall.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <atomic>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <slog/thread_context.h>
+
+using namespace std;
+
+namespace slog {
+
+namespace {
+atomic<uint32_t> next_number{1};
+}
+
+ThreadContext& ThreadContext::Current() {
+    static thread_local ThreadContext context;
+    return context;
+}
+
+ThreadContext::ThreadContext(): number_(next_number++) {
+    static once_flag registered;
+    call_once(registered, []() {
+        pthread_atfork(nullptr, nullptr, &ThreadContext::on_fork_child);
+    });
+    ostringstream oss;
+    oss << this_thread::get_id();
+    thread_id_ = oss.str();
+    refresh();
+}
+
+void ThreadContext::refresh() {
+    pid_ = ::getpid();
+    tid_ = static_cast<pid_t>(::syscall(SYS_gettid));
+}
+
+// on_fork_child runs in the only thread of the child process, the
+// one which called fork(), so only its context needs a refresh.
+void ThreadContext::on_fork_child() {
+    Current().refresh();
+}
+
+void ThreadContext::SetName(const string& name) {
+    name_ = name;
+    pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+}
+
+void ThreadContext::Put(const string& key, const string& value) {
+    for (auto &e : entries_) {
+        if (e.first == key) {
+            e.second = value;
+            render();
+            return;
+        }
+    }
+    entries_.emplace_back(key, value);
+    render();
+}
+
+bool ThreadContext::Get(const string& key, string& value) const {
+    for (auto &e : entries_) {
+        if (e.first == key) {
+            value = e.second;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadContext::Remove(const string& key) {
+    for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+        if (it->first == key) {
+            entries_.erase(it);
+            render();
+            return;
+        }
+    }
+}
+
+void ThreadContext::Clear() {
+    entries_.clear();
+    mdc_.clear();
+}
+
+void ThreadContext::render() {
+    mdc_.clear();
+    for (auto &e : entries_) {
+        if (!mdc_.empty()) mdc_ += ' ';
+        mdc_ += e.first;
+        mdc_ += '=';
+        mdc_ += e.second;
+    }
+}
+
+MdcScope::MdcScope(const string& key, const string& value): key_(key) {
+    auto &context = ThreadContext::Current();
+    had_previous_ = context.Get(key, previous_);
+    context.Put(key, value);
+}
+
+MdcScope::~MdcScope() {
+    auto &context = ThreadContext::Current();
+    if (had_previous_) {
+        context.Put(key_, previous_);
+    } else {
+        context.Remove(key_);
+    }
+}
+
+} // namespace slog
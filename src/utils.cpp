@@ -7,6 +7,10 @@
  * https://opensource.org/license/MIT/
  */
 #include <sys/stat.h>
+#include <unistd.h>
+#include <climits>
+#include <cerrno>
+#include <cstdio>
 #include <slog/utils.h>
 
 using namespace std;
@@ -90,5 +94,71 @@ bool ensure_directory_path(const string& dir) {
     return create_directory_path(dir);
 }
 
+// vformat renders the printf-style format string with the given
+// arguments into out, replacing its contents.
+bool vformat(string& out, const char *frmt, va_list args) {
+    out.clear();
+    return vappend(out, frmt, args);
+}
+
+bool format(string& out, const char *frmt, ...) {
+    va_list args;
+    va_start(args, frmt);
+    auto res = vformat(out, frmt, args);
+    va_end(args);
+    return res;
+}
+
+// vappend renders the printf-style format string with the given
+// arguments at the end of out.
+bool vappend(string& out, const char *frmt, va_list args) {
+    size_t base = out.size();
+    va_list copy;
+    va_copy(copy, args);
+    // first try to render into the remaining capacity of the buffer
+    out.resize(out.capacity());
+    auto res = vsnprintf(&out[base], out.size() - base + 1, frmt, copy);
+    va_end(copy);
+    if (res < 0) {
+        out.resize(base);
+        return false;
+    }
+    if (base + res > out.size()) {
+        out.resize(base + res);
+        vsnprintf(&out[base], res + 1, frmt, args);
+    }
+    out.resize(base + res);
+    return true;
+}
+
+bool append(string& out, const char *frmt, ...) {
+    va_list args;
+    va_start(args, frmt);
+    auto res = vappend(out, frmt, args);
+    va_end(args);
+    return res;
+}
+
+bool writev_all(int fd, struct iovec *iov, int iovcnt) {
+    while (iovcnt > 0) {
+        ssize_t n = ::writev(fd, iov, iovcnt < IOV_MAX ? iovcnt : IOV_MAX);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        // skip the buffers written, and the written part of the next one
+        while (iovcnt > 0 && static_cast<size_t>(n) >= iov->iov_len) {
+            n -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0) {
+            iov->iov_base = static_cast<char *>(iov->iov_base) + n;
+            iov->iov_len -= n;
+        }
+    }
+    return true;
+}
+
 } // namespace utils
 } // namespace slog
@@ -0,0 +1,137 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_COMPRESSION_TEST_H_
+#define __SLOG_COMPRESSION_TEST_H_
+
+#include <random>
+#include <sstream>
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <slog/compression.h>
+#include <slog/file_target.h>
+#include "test_utils.h"
+
+using namespace slog;
+
+/**
+ * CompressionTest
+ *
+ * Group of tests to validate the slog::lz block compression
+ * and the compressed FileTarget
+*/
+class CompressionTest: public CppUnit::TestCase
+{
+    CPPUNIT_TEST_SUITE(CompressionTest);
+    CPPUNIT_TEST(testRoundTrip);
+    CPPUNIT_TEST(testFrames);
+    CPPUNIT_TEST(testCompressedFileTarget);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    CompressionTest() = default;
+    ~CompressionTest() = default;
+    void setUp() {
+        cleanupTestdata();
+    }
+    void tearDown() {
+        cleanupTestdata();
+    }
+
+protected:
+    void testRoundTrip() {
+        std::mt19937 rng(42);
+        std::string random(10000, '\0');
+        for (auto &c : random) c = static_cast<char>(rng());
+
+        std::vector<std::string> inputs{"", "a", "abcd", std::string(1000, 'x'), random, logLines(500)};
+        for (auto &in : inputs) {
+            std::string packed, unpacked;
+            lz::Compress(in.data(), in.size(), packed);
+            CPPUNIT_ASSERT_MESSAGE("decompress", lz::Decompress(packed.data(), packed.size(), in.size(), unpacked));
+            CPPUNIT_ASSERT(unpacked == in);
+        }
+
+        std::string logs = logLines(500), packed;
+        lz::Compress(logs.data(), logs.size(), packed);
+        CPPUNIT_ASSERT_MESSAGE("log lines should compress well", packed.size() * 3 < logs.size());
+    }
+
+    void testFrames() {
+        std::string a = logLines(100), b = logLines(50), stream;
+        lz::EncodeFrame(a.data(), a.size(), stream);
+        size_t first = stream.size();
+        lz::EncodeFrame(b.data(), b.size(), stream);
+
+        std::string out;
+        size_t consumed = 0;
+        CPPUNIT_ASSERT(lz::DecodeFrame(stream.data(), stream.size(), out, consumed) == lz::frame_ok);
+        CPPUNIT_ASSERT_EQUAL(consumed, first);
+        CPPUNIT_ASSERT(out == a);
+
+        // a torn frame is incomplete
+        out.clear();
+        CPPUNIT_ASSERT(lz::DecodeFrame(stream.data() + first, stream.size() - first - 1, out, consumed)
+            == lz::frame_incomplete);
+
+        // a damaged frame is detected, the next one still decodes
+        std::string damaged = stream;
+        damaged[first / 2] ^= 0x55;
+        CPPUNIT_ASSERT(lz::DecodeFrame(damaged.data(), damaged.size(), out, consumed) == lz::frame_corrupt);
+        out.clear();
+        CPPUNIT_ASSERT(lz::DecodeFrame(damaged.data() + first, damaged.size() - first, out, consumed)
+            == lz::frame_ok);
+        CPPUNIT_ASSERT(out == b);
+    }
+
+    void testCompressedFileTarget() {
+        FileOptions opts;
+        opts.compress_block = 4096;
+        std::string expected;
+        {
+            FileTarget<std::mutex> t{test_file_, LogLevel::Info, opts};
+            for (int i = 0; i < 1000; i++) {
+                std::string msg = "[Thu Nov  2 12:38:19 2023] [508754] [I] request " + std::to_string(i);
+                t.Write(LogLevel::Info, msg.data(), msg.size());
+                expected += msg + "\n";
+                if (i == 500) t.Flush();
+            }
+            t.Log(LogLevel::Info, "formatted %d", 7);
+            expected += "formatted 7\n";
+        }
+
+        std::ifstream fs(test_file_, std::ifstream::in | std::ifstream::binary);
+        std::stringstream ss;
+        ss << fs.rdbuf();
+        std::string file = ss.str(), out;
+        CPPUNIT_ASSERT_MESSAGE("file should be compressed", file.size() * 3 < expected.size());
+        size_t pos = 0, consumed = 0, frames = 0;
+        while (pos < file.size()) {
+            CPPUNIT_ASSERT(lz::DecodeFrame(file.data() + pos, file.size() - pos, out, consumed) == lz::frame_ok);
+            pos += consumed;
+            frames++;
+        }
+        CPPUNIT_ASSERT(frames > 1);
+        CPPUNIT_ASSERT(out == expected);
+    }
+
+private:
+    static std::string logLines(int n) {
+        std::string s;
+        for (int i = 0; i < n; i++) {
+            s += "[Thu Nov  2 12:38:19 2023] [508754] [I] processed request id=" +
+                 std::to_string(i * 7919) + " in " + std::to_string(i % 13) + "ms\n";
+        }
+        return s;
+    }
+
+    std::string test_file_{TEST_FILE("test-logs.txt")}; // file name used for testing
+}; // class CompressionTest
+
+#endif // __SLOG_COMPRESSION_TEST_H_
@@ -0,0 +1,259 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_CONFIG_TEST_H_
+#define __SLOG_CONFIG_TEST_H_
+
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <slog/config.h>
+#include "test_utils.h"
+
+using namespace slog;
+
+/**
+ * ConfigTest
+ *
+ * Group of tests to validate the configuration file
+ * and its live reload
+*/
+class ConfigTest: public CppUnit::TestCase
+{
+    CPPUNIT_TEST_SUITE(ConfigTest);
+    CPPUNIT_TEST(testLoad);
+    CPPUNIT_TEST(testInvalid);
+    CPPUNIT_TEST(testReload);
+    CPPUNIT_TEST(testWatch);
+    CPPUNIT_TEST(testHandleCache);
+    CPPUNIT_TEST(testRetired);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    ConfigTest() = default;
+    ~ConfigTest() = default;
+    void setUp() {
+        cleanupTestdata();
+        utils::ensure_directory_path(TEST_DIR);
+    }
+    void tearDown() {
+        cleanupTestdata();
+    }
+
+protected:
+    void testLoad() {
+        writeConfig(baseConfig("info"));
+        Config c{config_file_};
+        auto log = c.Get("app");
+        log.Info("hello %d", 1);
+        log.Debug("filtered");
+        log.Flush();
+
+        // unknown loggers are served by the default logger
+        CPPUNIT_ASSERT(c.Logger("other") == c.Logger("default"));
+        CPPUNIT_ASSERT_EQUAL(std::string("default"), c.Logger("other")->Name());
+
+        auto lines = readLines(log_file_);
+        CPPUNIT_ASSERT_EQUAL(size_t(1), lines.size());
+        CPPUNIT_ASSERT_EQUAL(std::string("info app: hello 1"), lines[0]);
+    }
+
+    void testInvalid() {
+        const char *configs[] = {
+            "[target.a]\ntype = bogus\n",
+            "[target.a]\ntype = file\n",
+            "[target.a]\ntype = file\npath = x\nunknown = 1\n",
+            "[logger.a]\ntargets = missing\n",
+            "[logger.a]\nlevel = loud\n",
+            "[other.a]\n",
+            "key = value\n",
+        };
+        for (auto text : configs) {
+            writeConfig(text);
+            bool thrown = false;
+            try {
+                Config c{config_file_};
+            } catch (ConfigException &e) {
+                thrown = true;
+            }
+            CPPUNIT_ASSERT_MESSAGE(text, thrown);
+        }
+    }
+
+    void testReload() {
+        writeConfig(baseConfig("info"));
+        Config c{config_file_};
+        auto log = c.Get("app");
+        auto before = c.Logger("app");
+        CPPUNIT_ASSERT_EQUAL(uint64_t(0), c.Generation());
+
+        writeConfig(baseConfig("debug"));
+        CPPUNIT_ASSERT(c.Reload());
+        CPPUNIT_ASSERT_EQUAL(uint64_t(1), c.Generation());
+        auto after = c.Logger("app");
+        CPPUNIT_ASSERT(before != after);
+        CPPUNIT_ASSERT_EQUAL(LogLevel::Debug, after->GetLevel());
+        // the unchanged file target is carried over
+        CPPUNIT_ASSERT(before->Targets()[0] == after->Targets()[0]);
+
+        log.Debug("now visible");
+        log.Flush();
+        auto lines = readLines(log_file_);
+        CPPUNIT_ASSERT_EQUAL(size_t(1), lines.size());
+        CPPUNIT_ASSERT_EQUAL(std::string("debug app: now visible"), lines[0]);
+
+        // an invalid configuration keeps the current one
+        writeConfig("[logger.app]\nlevel = loud\n");
+        CPPUNIT_ASSERT(!c.Reload());
+        CPPUNIT_ASSERT(!c.LastError().empty());
+        CPPUNIT_ASSERT(c.Logger("app") == after);
+        CPPUNIT_ASSERT_EQUAL(uint64_t(1), c.Generation());
+    }
+
+    void testWatch() {
+        writeConfig(baseConfig("info"));
+        Config c{config_file_};
+        c.Watch();
+
+        // replace the file the way editors do
+        std::string tmp = config_file_ + ".tmp";
+        {
+            std::ofstream out(tmp);
+            out << baseConfig("trace");
+        }
+        CPPUNIT_ASSERT(rename(tmp.c_str(), config_file_.c_str()) == 0);
+        for (int i = 0; i < 200 && c.Generation() == 0; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        CPPUNIT_ASSERT(c.Generation() > 0);
+        CPPUNIT_ASSERT_EQUAL(LogLevel::Trace, c.Logger("app")->GetLevel());
+        c.Unwatch();
+    }
+
+    void testHandleCache() {
+        writeConfig(baseConfig("info"));
+        std::weak_ptr<Config::logger_t> old;
+        {
+            Config c{config_file_};
+            // the handles of a logger share one cache entry
+            for (int i = 0; i < 100; i++) {
+                c.Get("app").Info("record %d", i);
+            }
+            // the caches hold no reference to the loggers
+            CPPUNIT_ASSERT_EQUAL(2L, c.Logger("app").use_count());
+
+            // the reloaded logger is released by Reload()
+            old = c.Logger("app");
+            CPPUNIT_ASSERT(c.Reload());
+            CPPUNIT_ASSERT(old.expired());
+            c.Get("app").Info("reloaded");
+            old = c.Logger("app");
+        }
+        CPPUNIT_ASSERT(old.expired());
+        Config other{config_file_};
+        other.Get("app").Info("other");
+        other.Get("app").Info() << "streamed";
+        CPPUNIT_ASSERT_EQUAL(2L, other.Logger("app").use_count());
+    }
+
+    void testRetired() {
+        writeConfig(baseConfig("info"));
+        Config c{config_file_};
+        std::weak_ptr<Config::logger_t> old = c.Logger("app");
+        std::weak_ptr<Target> file = c.Logger("app")->Targets()[0];
+
+        // a thread that logged once, then stays idle
+        std::mutex m;
+        std::condition_variable cv;
+        bool logged = false, done = false;
+        std::thread idle([&] {
+            c.Get("app").Info("once");
+            std::unique_lock<std::mutex> lock(m);
+            logged = true;
+            cv.notify_all();
+            cv.wait(lock, [&] { return done; });
+        });
+        {
+            std::unique_lock<std::mutex> lock(m);
+            cv.wait(lock, [&] { return logged; });
+        }
+
+        // the changed target is replaced, the old one closed by Reload()
+        writeConfig(baseConfig("info", "warning"));
+        CPPUNIT_ASSERT(c.Reload());
+        CPPUNIT_ASSERT(old.expired());
+        CPPUNIT_ASSERT(file.expired());
+        {
+            std::lock_guard<std::mutex> lock(m);
+            done = true;
+            cv.notify_all();
+        }
+        idle.join();
+
+        // reloads racing with the logging threads
+        std::atomic<bool> stop{false};
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 4; i++) {
+            threads.emplace_back([&] {
+                auto log = c.Get("app");
+                while (!stop.load()) {
+                    log.Info("record");
+                    SLOG_INFO(log) << "streamed";
+                }
+            });
+        }
+        for (int i = 0; i < 50; i++) {
+            writeConfig(baseConfig("info", i % 2 ? "error" : "warning"));
+            CPPUNIT_ASSERT(c.Reload());
+        }
+        stop = true;
+        for (auto &t : threads) t.join();
+        CPPUNIT_ASSERT_EQUAL(uint64_t(51), c.Generation());
+    }
+
+private:
+    std::string baseConfig(const std::string& level, const std::string& flush_level = "error") {
+        return "# test configuration\n"
+               "[target.file]\n"
+               "type = file\n"
+               "path = " + log_file_ + "\n"
+               "level = trace\n"
+               "flush_level = " + flush_level + "\n"
+               "\n"
+               "[logger.app]\n"
+               "level = " + level + "\n"
+               "pattern = %l %n: %v\n"
+               "targets = file\n"
+               "\n"
+               "[logger.default]\n"
+               "targets =\n";
+    }
+
+    void writeConfig(const std::string& text) {
+        std::ofstream out(config_file_, std::ofstream::trunc);
+        out << text;
+    }
+
+    static std::vector<std::string> readLines(const std::string& file) {
+        std::ifstream in(file);
+        std::vector<std::string> lines;
+        std::string line;
+        while (std::getline(in, line)) lines.push_back(line);
+        return lines;
+    }
+
+    std::string config_file_{TEST_FILE("slog.conf")};
+    std::string log_file_{TEST_FILE("test-logs.txt")};
+}; // class ConfigTest
+
+#endif // __SLOG_CONFIG_TEST_H_
@@ -0,0 +1,109 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_CONSOLE_TARGET_TEST_H_
+#define __SLOG_CONSOLE_TARGET_TEST_H_
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <thread>
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <slog/console_target.h>
+#include "test_utils.h"
+
+using namespace slog;
+
+/**
+ * ConsoleTargetTest
+ *
+ * Group of tests to validate slog::ConsoleTarget, the console
+ * is emulated with a pipe.
+*/
+class ConsoleTargetTest: public CppUnit::TestCase
+{
+    CPPUNIT_TEST_SUITE(ConsoleTargetTest);
+    CPPUNIT_TEST(testBuffering);
+    CPPUNIT_TEST(testFlushInterval);
+    CPPUNIT_TEST(testColors);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    ConsoleTargetTest() = default;
+    ~ConsoleTargetTest() = default;
+    void setUp() {
+        CPPUNIT_ASSERT(pipe(fds_) == 0);
+        fcntl(fds_[0], F_SETFL, O_NONBLOCK);
+    }
+    void tearDown() {
+        close(fds_[0]);
+        close(fds_[1]);
+    }
+
+protected:
+    void testBuffering() {
+        ConsoleOptions opts;
+        opts.buffer_size = 48;
+        opts.flush_interval = std::chrono::milliseconds(0);
+        ConsoleTarget<std::mutex> t{fds_[1], LogLevel::Trace, opts};
+        CPPUNIT_ASSERT(!t.IsTerminal());
+        CPPUNIT_ASSERT(!t.IsColored());
+
+        t.Write(LogLevel::Info, "first record", 12);
+        t.Log(LogLevel::Info, "second %s", "record");
+        CPPUNIT_ASSERT_EQUAL(std::string(), readAll());
+
+        // filling up the buffer writes it out
+        t.Write(LogLevel::Info, "third record with a longer message\n", 35);
+        CPPUNIT_ASSERT_EQUAL(std::string("first record\nsecond record\nthird record with a longer message\n"), readAll());
+
+        t.Write(LogLevel::Error, "fourth", 6);
+        t.Flush();
+        CPPUNIT_ASSERT_EQUAL(std::string("fourth\n"), readAll());
+    }
+
+    void testFlushInterval() {
+        ConsoleOptions opts;
+        opts.flush_interval = std::chrono::milliseconds(10);
+        ConsoleTarget<std::mutex> t{fds_[1], LogLevel::Trace, opts};
+        t.Write(LogLevel::Info, "timed", 5);
+        std::string out;
+        for (int i = 0; i < 100 && out.empty(); i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            out = readAll();
+        }
+        CPPUNIT_ASSERT_EQUAL(std::string("timed\n"), out);
+    }
+
+    void testColors() {
+        ConsoleOptions opts;
+        opts.color = ConsoleOptions::color_always;
+        {
+            ConsoleTarget<std::mutex> t{fds_[1], LogLevel::Trace, opts};
+            CPPUNIT_ASSERT(t.IsColored());
+            t.Write(LogLevel::Error, "error", 5);
+            t.Write(LogLevel::Info, "info", 4);
+        }
+        // flushed on destruction
+        CPPUNIT_ASSERT_EQUAL(std::string("\033[31merror\033[0m\ninfo\n"), readAll());
+    }
+
+private:
+    std::string readAll() {
+        std::string out;
+        char buf[256];
+        ssize_t n;
+        while ((n = read(fds_[0], buf, sizeof(buf))) > 0) out.append(buf, n);
+        return out;
+    }
+
+    int fds_[2];
+}; // class ConsoleTargetTest
+
+#endif // __SLOG_CONSOLE_TARGET_TEST_H_
@@ -0,0 +1,111 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_ESCAPE_TEST_H_
+#define __SLOG_ESCAPE_TEST_H_
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <slog/escape.h>
+#include <slog/logger.h>
+#include "test_utils.h"
+
+using namespace slog;
+
+/**
+ * EscapeTest
+ *
+ * Group of tests to validate escaping the control
+ * characters of the records
+*/
+class EscapeTest: public CppUnit::TestCase
+{
+    CPPUNIT_TEST_SUITE(EscapeTest);
+    CPPUNIT_TEST(testFindControl);
+    CPPUNIT_TEST(testEscape);
+    CPPUNIT_TEST(testFileTarget);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    EscapeTest() = default;
+    ~EscapeTest() = default;
+    void setUp() {
+        cleanupTestdata();
+    }
+    void tearDown() {
+        cleanupTestdata();
+    }
+
+protected:
+    void testFindControl() {
+        std::string clean;
+        for (int c = 0x20; c < 0x100; c++) {
+            if (c != 0x7f) clean += static_cast<char>(c);
+        }
+        clean += "\t";
+        CPPUNIT_ASSERT_EQUAL(clean.size(), find_control(clean.data(), clean.size()));
+        CPPUNIT_ASSERT_EQUAL(clean.size(), find_control_software(clean.data(), clean.size()));
+        CPPUNIT_ASSERT_EQUAL(size_t(0), find_control(clean.data(), 0));
+
+        // every control character, at every offset of the vectors
+        const char controls[] = {'\0', '\n', '\r', '\x1b', '\x1f', '\x7f'};
+        for (char c : controls) {
+            for (size_t len = 1; len <= 80; len++) {
+                for (size_t pos = 0; pos < len; pos++) {
+                    std::string s(len, 'a');
+                    s[pos] = c;
+                    if (pos + 1 < len) s[len-1] = '\n';
+                    CPPUNIT_ASSERT_EQUAL(pos, find_control(s.data(), s.size()));
+                    CPPUNIT_ASSERT_EQUAL(pos, find_control_software(s.data(), s.size()));
+                }
+            }
+        }
+    }
+
+    void testEscape() {
+        std::string out;
+        escape_control("plain\ttext", 10, out);
+        CPPUNIT_ASSERT_EQUAL(std::string("plain\ttext"), out);
+        out.clear();
+        std::string in{"user=bob\n[Mon Oct 19 15:30:41 2026] [1] [C] forged\r\x1b[31mred\x1b[0m\x7f"};
+        escape_control(in.data(), in.size(), out);
+        CPPUNIT_ASSERT_EQUAL(std::string("user=bob\\n[Mon Oct 19 15:30:41 2026] [1] [C] forged\\r"
+                                         "\\x1b[31mred\\x1b[0m\\x7f"), out);
+    }
+
+    void testFileTarget() {
+        FileOptions options;
+        options.escape = true;
+        auto file = std::make_shared<FileTarget<std::mutex> >(log_file_, LogLevel::Trace, options);
+        BasicLogger<Pattern<pattern::Level, pattern::Message>> l{"test", LogLevel::Trace, file};
+        l.Info("clean");
+        l.Error("two\nlines");
+        l.Info() << "bell\a";
+        file->Log(LogLevel::Info, "%s", "formatted\r\n");
+        std::string payload{"data\x01"};
+        l.LogPayload(LogLevel::Info, Payload(payload), "payload");
+        l.Flush();
+
+        std::ifstream in(log_file_, std::ios::binary);
+        std::string content{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+        CPPUNIT_ASSERT_EQUAL(std::string("[I] clean\n[E] two\\nlines\n[I] bell\\x07\nformatted\\r\n"),
+                             content.substr(0, content.find("[I] payload")));
+        std::string last = content.substr(content.find("[I] payload"));
+        CPPUNIT_ASSERT(last.find("data\\x01") != std::string::npos);
+        CPPUNIT_ASSERT_EQUAL(size_t(1), static_cast<size_t>(std::count(last.begin(), last.end(), '\n')));
+    }
+
+private:
+    std::string log_file_{TEST_FILE("escape.log")};
+}; // class EscapeTest
+
+#endif // __SLOG_ESCAPE_TEST_H_
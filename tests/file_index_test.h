@@ -0,0 +1,134 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_FILE_INDEX_TEST_H_
+#define __SLOG_FILE_INDEX_TEST_H_
+
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <slog/file_target.h>
+#include <slog/file_index.h>
+#include <slog/record_format.h>
+#include <slog/logger.h>
+#include "test_utils.h"
+
+using namespace slog;
+
+/**
+ * FileIndexTest
+ *
+ * Group of tests to validate the sparse file index and
+ * the slog::RecordParser interfaces
+*/
+class FileIndexTest: public CppUnit::TestCase
+{
+    CPPUNIT_TEST_SUITE(FileIndexTest);
+    CPPUNIT_TEST(testFileIndexEntries);
+    CPPUNIT_TEST(testFileIndexLookup);
+    CPPUNIT_TEST(testRecordParser);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    FileIndexTest() = default;
+    ~FileIndexTest() = default;
+    void setUp() {
+        cleanupTestdata();
+    }
+    void tearDown() {
+        cleanupTestdata();
+    }
+
+protected:
+    void testFileIndexEntries() {
+        FileOptions opts;
+        opts.index_interval = 100;
+        {
+            FileTarget<std::mutex> t{test_file_, LogLevel::Info, opts};
+            std::string msg(49, 'x'); // 50 bytes with the line feed
+            for (int i = 0; i < 10; i++) {
+                t.Write(LogLevel::Info, msg.data(), msg.size());
+            }
+        }
+
+        FileIndex index;
+        CPPUNIT_ASSERT_MESSAGE("load index", index.Load(test_file_));
+        auto &entries = index.Entries();
+        CPPUNIT_ASSERT_EQUAL(entries.size(), static_cast<size_t>(5));
+        for (size_t i = 0; i < entries.size(); i++) {
+            CPPUNIT_ASSERT_EQUAL(entries[i].offset, static_cast<uint64_t>(i * 100));
+            if (i) CPPUNIT_ASSERT(entries[i].time >= entries[i-1].time);
+        }
+
+        // reopening the file continues the index at its end
+        {
+            FileTarget<std::mutex> t{test_file_, LogLevel::Info, opts};
+            t.Write(LogLevel::Info, "more", 4);
+        }
+        CPPUNIT_ASSERT(index.Load(test_file_));
+        CPPUNIT_ASSERT_EQUAL(index.Entries().size(), static_cast<size_t>(6));
+        CPPUNIT_ASSERT_EQUAL(index.Entries().back().offset, static_cast<uint64_t>(500));
+    }
+
+    void testFileIndexLookup() {
+        FileIndex index;
+        CPPUNIT_ASSERT_MESSAGE("no index file", !index.Load(test_file_));
+        CPPUNIT_ASSERT_EQUAL(index.Begin(10), static_cast<uint64_t>(0));
+        CPPUNIT_ASSERT_EQUAL(index.End(10), static_cast<uint64_t>(UINT64_MAX));
+
+        // hand written index of entries at times 10, 20, 30
+        ::system((std::string("mkdir -p ") + TEST_DIR).c_str());
+        FILE *fp = fopen(FileIndex::Path(test_file_).c_str(), "wb");
+        fwrite("SLGIDX1\0", 1, 8, fp);
+        for (int i = 1; i <= 3; i++) {
+            FileIndex::entry_t e{i * 10, static_cast<uint64_t>(i * 1000)};
+            fwrite(&e, sizeof(e), 1, fp);
+        }
+        fclose(fp);
+        CPPUNIT_ASSERT(index.Load(test_file_));
+
+        CPPUNIT_ASSERT_EQUAL(index.Begin(5), static_cast<uint64_t>(0));
+        CPPUNIT_ASSERT_EQUAL(index.Begin(20), static_cast<uint64_t>(1000));
+        CPPUNIT_ASSERT_EQUAL(index.Begin(25), static_cast<uint64_t>(2000));
+        CPPUNIT_ASSERT_EQUAL(index.End(20), static_cast<uint64_t>(3000));
+        CPPUNIT_ASSERT_EQUAL(index.End(30), static_cast<uint64_t>(UINT64_MAX));
+    }
+
+    void testRecordParser() {
+        RecordParser parser;
+        RecordFields f;
+        std::string line{"[Thu Nov  2 12:38:19 2023] [508754] [W] disk is 90% full"};
+        CPPUNIT_ASSERT(parser.Parse(line.data(), line.size(), f));
+        CPPUNIT_ASSERT_EQUAL(f.pid, 508754L);
+        CPPUNIT_ASSERT(f.level == LogLevel::Warning);
+        CPPUNIT_ASSERT_EQUAL(std::string(f.msg, f.msg_len), std::string("disk is 90% full"));
+
+        struct tm tm{};
+        tm.tm_year = 123; tm.tm_mon = 10; tm.tm_mday = 2;
+        tm.tm_hour = 12; tm.tm_min = 38; tm.tm_sec = 19; tm.tm_isdst = -1;
+        CPPUNIT_ASSERT_EQUAL(f.time, mktime(&tm));
+
+        CPPUNIT_ASSERT_MESSAGE("continuation line", !parser.Parse("  at main()", 11, f));
+
+        // round trip of a record written by the logger
+        Logger l{"test", LogLevel::Info, std::make_shared<FileTarget<std::mutex> >(test_file_, LogLevel::Info)};
+        l.Error("error %d", 7);
+        l.Flush();
+        std::ifstream fs(test_file_, std::ifstream::in);
+        std::getline(fs, line);
+        CPPUNIT_ASSERT(parser.Parse(line.data(), line.size(), f));
+        CPPUNIT_ASSERT(f.level == LogLevel::Error);
+        CPPUNIT_ASSERT_EQUAL(f.pid, static_cast<long>(::getpid()));
+        CPPUNIT_ASSERT(std::abs(f.time - std::time(nullptr)) <= 2);
+    }
+
+private:
+    std::string test_file_{TEST_FILE("test-logs.txt")}; // file name used for testing
+}; // class FileIndexTest
+
+#endif // __SLOG_FILE_INDEX_TEST_H_
@@ -0,0 +1,214 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_FLUSH_POLICY_TEST_H_
+#define __SLOG_FLUSH_POLICY_TEST_H_
+
+#include <dirent.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <slog/file_target.h>
+#include "test_utils.h"
+
+using namespace slog;
+
+/**
+ * CountingTarget counts the flushes and syncs
+ */
+class CountingTarget: public Target {
+public:
+    CountingTarget(): Target(LogLevel::Trace) {}
+    ~CountingTarget() {
+        cancel_flush_timer();
+    }
+
+    std::atomic<int> flushes{0};
+    std::atomic<int> syncs{0};
+    std::atomic<int> entered{0};    // flushes started
+    std::mutex *stall{nullptr};     // held by the test to stall the flushes
+
+protected:
+    bool log(const std::string&, va_list) override { return true; }
+    void flush() override {
+        entered++;
+        if (stall) {
+            std::lock_guard<std::mutex> lock(*stall);
+        }
+        flushes++;
+    }
+    bool sync() override { syncs++; return true; }
+};
+
+/**
+ * FlushPolicyTest
+ *
+ * Group of tests to validate the target flush policies
+ * and the FileTarget group sync
+*/
+class FlushPolicyTest: public CppUnit::TestCase
+{
+    CPPUNIT_TEST_SUITE(FlushPolicyTest);
+    CPPUNIT_TEST(testLevelAndCount);
+    CPPUNIT_TEST(testInterval);
+    CPPUNIT_TEST(testTimerThread);
+    CPPUNIT_TEST(testStalledFlush);
+    CPPUNIT_TEST(testGroupSync);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    FlushPolicyTest() = default;
+    ~FlushPolicyTest() = default;
+    void setUp() {
+        cleanupTestdata();
+    }
+    void tearDown() {
+        cleanupTestdata();
+    }
+
+protected:
+    void testLevelAndCount() {
+        CountingTarget t;
+        CPPUNIT_ASSERT_EQUAL(0, t.flushes.load());
+
+        FlushPolicy policy;
+        policy.level = LogLevel::Error;
+        t.SetFlushPolicy(policy);
+        t.Write(LogLevel::Info, "info", 4);
+        t.Write(LogLevel::Warning, "warning", 7);
+        CPPUNIT_ASSERT_EQUAL(0, t.flushes.load());
+        t.Write(LogLevel::Error, "error", 5);
+        t.Log(LogLevel::Critical, "critical");
+        CPPUNIT_ASSERT_EQUAL(2, t.flushes.load());
+
+        policy = FlushPolicy{};
+        policy.every = 3;
+        policy.sync = true;
+        t.SetFlushPolicy(policy);
+        for (int i = 0; i < 10; i++) t.Write(LogLevel::Info, "info", 4);
+        CPPUNIT_ASSERT_EQUAL(2, t.flushes.load());
+        CPPUNIT_ASSERT_EQUAL(3, t.syncs.load());
+    }
+
+    void testInterval() {
+        CountingTarget t;
+        FlushPolicy policy;
+        policy.interval = std::chrono::milliseconds(10);
+        t.SetFlushPolicy(policy);
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        CPPUNIT_ASSERT(t.flushes.load() >= 3);
+
+        t.SetFlushPolicy(FlushPolicy{});
+        int flushes = t.flushes.load();
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        CPPUNIT_ASSERT_EQUAL(flushes, t.flushes.load());
+    }
+
+    void testTimerThread() {
+        CountingTarget a, b, c;
+        FlushPolicy policy;
+        policy.interval = std::chrono::milliseconds(10);
+        a.SetFlushPolicy(policy);
+        size_t threads = count_threads();
+        // the targets share the one timer thread
+        b.SetFlushPolicy(policy);
+        c.SetFlushPolicy(policy);
+        a.SetFlushPolicy(policy);
+        CPPUNIT_ASSERT_EQUAL(threads, count_threads());
+
+        FlushTimer::Instance().Stop();
+        CPPUNIT_ASSERT_EQUAL(threads - 1, count_threads());
+        int flushes = a.flushes.load();
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        CPPUNIT_ASSERT_EQUAL(flushes, a.flushes.load());
+
+        // started again by a registration
+        a.SetFlushPolicy(policy);
+        CPPUNIT_ASSERT_EQUAL(threads, count_threads());
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        CPPUNIT_ASSERT(a.flushes.load() > flushes);
+    }
+
+    void testStalledFlush() {
+        CountingTarget slow, other;
+        std::mutex stall;
+        stall.lock();
+        slow.stall = &stall;
+        FlushPolicy policy;
+        policy.interval = std::chrono::milliseconds(1);
+        slow.SetFlushPolicy(policy);
+        for (int i = 0; i < 2000 && !slow.entered.load(); i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        CPPUNIT_ASSERT_EQUAL(1, slow.entered.load());
+
+        // the other targets register and unregister meanwhile
+        auto start = std::chrono::steady_clock::now();
+        other.SetFlushPolicy(policy);
+        other.SetFlushPolicy(FlushPolicy{});
+        CPPUNIT_ASSERT(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(500));
+
+        // the stalled target waits for its flush to unregister
+        std::atomic<bool> done{false};
+        std::thread cancel([&]() {
+            slow.SetFlushPolicy(FlushPolicy{});
+            done = true;
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        CPPUNIT_ASSERT(!done.load());
+        stall.unlock();
+        cancel.join();
+        CPPUNIT_ASSERT_EQUAL(1, slow.flushes.load());
+    }
+
+    void testGroupSync() {
+        FileTarget<std::mutex> t{test_file_, LogLevel::Trace};
+        CPPUNIT_ASSERT(t.SyncTo(0));
+
+        std::vector<std::thread> threads;
+        std::atomic<int> failures{0};
+        for (int i = 0; i < 8; i++) {
+            threads.emplace_back([&t, &failures, i]() {
+                for (int j = 0; j < 50; j++) {
+                    t.Log(LogLevel::Info, "thread %d record %d", i, j);
+                    if (!t.SyncTo(t.Sequence())) failures++;
+                }
+            });
+        }
+        for (auto &th : threads) th.join();
+        CPPUNIT_ASSERT_EQUAL(0, failures.load());
+        CPPUNIT_ASSERT_EQUAL(uint64_t(400), t.Sequence());
+        CPPUNIT_ASSERT(t.Sync());
+
+        std::ifstream fs(test_file_);
+        std::string line;
+        int lines = 0;
+        while (std::getline(fs, line)) lines++;
+        CPPUNIT_ASSERT_EQUAL(400, lines);
+    }
+
+private:
+    static size_t count_threads() {
+        size_t n = 0;
+        DIR *dir = opendir("/proc/self/task");
+        if (!dir) return 0;
+        while (struct dirent *e = readdir(dir)) {
+            if (e->d_name[0] != '.') n++;
+        }
+        closedir(dir);
+        return n;
+    }
+
+    std::string test_file_{TEST_FILE("test-logs.txt")}; // file name used for testing
+}; // class FlushPolicyTest
+
+#endif // __SLOG_FLUSH_POLICY_TEST_H_
@@ -0,0 +1,207 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_FRAME_TEST_H_
+#define __SLOG_FRAME_TEST_H_
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <slog/logger.h>
+#include <slog/crc32c.h>
+#include <slog/frame.h>
+#include <slog/file_exception.h>
+#include "test_utils.h"
+
+using namespace slog;
+
+/**
+ * FrameTest
+ *
+ * Group of tests to validate the framed log format
+ * and its recovery
+*/
+class FrameTest: public CppUnit::TestCase
+{
+    CPPUNIT_TEST_SUITE(FrameTest);
+    CPPUNIT_TEST(testCrc32c);
+    CPPUNIT_TEST(testFramedTarget);
+    CPPUNIT_TEST(testRecovery);
+    CPPUNIT_TEST(testSkipDamaged);
+    CPPUNIT_TEST_SUITE_END();
+
+    using logger_t = BasicLogger<Pattern<pattern::Level, pattern::Message>>;
+
+public:
+    FrameTest() = default;
+    ~FrameTest() = default;
+    void setUp() {
+        cleanupTestdata();
+    }
+    void tearDown() {
+        cleanupTestdata();
+    }
+
+protected:
+    void testCrc32c() {
+        CPPUNIT_ASSERT_EQUAL(0xe3069283u, crc32c(0, "123456789", 9));
+        CPPUNIT_ASSERT_EQUAL(0xe3069283u, crc32c_software(0, "123456789", 9));
+        CPPUNIT_ASSERT_EQUAL(0u, crc32c(0, "", 0));
+
+        std::string data;
+        for (int i = 0; i < 1000; i++) data += static_cast<char>(i * 31);
+        uint32_t whole = crc32c_software(0, data.data(), data.size());
+        for (size_t split : {size_t(0), size_t(1), size_t(7), size_t(500), size_t(999)}) {
+            uint32_t crc = crc32c(crc32c(0, data.data(), split), data.data() + split, data.size() - split);
+            CPPUNIT_ASSERT_EQUAL(whole, crc);
+        }
+    }
+
+    void testFramedTarget() {
+        FileOptions options;
+        options.framed = true;
+        std::string body(8192, 'p');
+        {
+            auto file = std::make_shared<FileTarget<std::mutex> >(log_file_, LogLevel::Trace, options);
+            logger_t l{"test", LogLevel::Trace, file};
+            l.Info("one");
+            l.Warning("two\n");
+            l.LogPayload(LogLevel::Debug, Payload(body), "three");
+            file->Log(LogLevel::Info, "four %d", 4);
+        }
+        {
+            // the sequence continues after reopening
+            auto file = std::make_shared<FileTarget<std::mutex> >(log_file_, LogLevel::Trace, options);
+            logger_t l{"test", LogLevel::Trace, file};
+            l.Error("five");
+        }
+
+        FrameReader reader{log_file_};
+        Frame f;
+        const char *want[] = {"[I] one\n", "[W] two\n", nullptr, "four 4\n", "[E] five\n"};
+        for (uint64_t seq = 1; seq <= 5; seq++) {
+            CPPUNIT_ASSERT(reader.Next(f));
+            CPPUNIT_ASSERT_EQUAL(seq, f.seq);
+            if (want[seq-1]) {
+                CPPUNIT_ASSERT_EQUAL(std::string(want[seq-1]), std::string(f.data, f.len));
+            } else {
+                CPPUNIT_ASSERT_EQUAL("[D] three\n" + body + "\n", std::string(f.data, f.len));
+                CPPUNIT_ASSERT_EQUAL(LogLevel::Debug, f.level);
+            }
+        }
+        CPPUNIT_ASSERT(!reader.Next(f));
+        CPPUNIT_ASSERT_EQUAL(uint64_t(0), reader.Skipped());
+
+        // plain text files are not taken for framed ones
+        std::ofstream(plain_file_) << "plain text\n";
+        CPPUNIT_ASSERT_THROW(FileTarget<std::mutex>(plain_file_, LogLevel::Trace, options), FileException);
+    }
+
+    void testRecovery() {
+        FileOptions options;
+        options.framed = true;
+        write_records(options, 3);
+        uint64_t valid = file_size();
+
+        // a torn frame and garbage at the end
+        append(std::string("SLF1\x10\0\0\0", 8) + "garbage after a crash");
+        FrameRecovery r = recover_frames(log_file_, false);
+        CPPUNIT_ASSERT_EQUAL(valid, r.valid_end);
+        CPPUNIT_ASSERT_EQUAL(uint64_t(3), r.last_seq);
+        CPPUNIT_ASSERT(r.size > valid);
+
+        // reopening cuts off the damaged tail
+        write_records(options, 2);
+        FrameReader reader{log_file_};
+        Frame f;
+        for (uint64_t seq = 1; seq <= 5; seq++) {
+            CPPUNIT_ASSERT(reader.Next(f));
+            CPPUNIT_ASSERT_EQUAL(seq, f.seq);
+        }
+        CPPUNIT_ASSERT(!reader.Next(f));
+        CPPUNIT_ASSERT_EQUAL(uint64_t(0), reader.Skipped());
+        CPPUNIT_ASSERT_EQUAL(file_size(), reader.Offset());
+
+        // a file torn within the magic of its first frame
+        for (size_t len = 1; len < sizeof(FrameMagic); len++) {
+            std::ofstream(log_file_, std::ios::binary | std::ios::trunc) << std::string(FrameMagic, len);
+            r = recover_frames(log_file_, false);
+            CPPUNIT_ASSERT_EQUAL(uint64_t(0), r.valid_end);
+            CPPUNIT_ASSERT_EQUAL(uint64_t(len), r.size);
+            write_records(options, 1);
+            FrameReader torn{log_file_};
+            CPPUNIT_ASSERT(torn.Next(f));
+            CPPUNIT_ASSERT_EQUAL(uint64_t(1), f.seq);
+            CPPUNIT_ASSERT(!torn.Next(f));
+        }
+        std::ofstream(log_file_, std::ios::binary | std::ios::trunc) << "SLX";
+        CPPUNIT_ASSERT_THROW(recover_frames(log_file_, false), FileException);
+    }
+
+    void testSkipDamaged() {
+        FileOptions options;
+        options.framed = true;
+        write_records(options, 3);
+
+        // damage the payload of the second record
+        std::string data = read_all();
+        size_t second = data.find("SLF1", 1);
+        data[second + FrameHeaderSize + 2] ^= 0x1;
+        std::ofstream(log_file_, std::ios::binary | std::ios::trunc) << data;
+
+        FrameReader reader{log_file_};
+        Frame f;
+        CPPUNIT_ASSERT(reader.Next(f));
+        CPPUNIT_ASSERT_EQUAL(uint64_t(1), f.seq);
+        CPPUNIT_ASSERT(reader.Next(f));
+        CPPUNIT_ASSERT_EQUAL(uint64_t(3), f.seq);
+        CPPUNIT_ASSERT(!reader.Next(f));
+        CPPUNIT_ASSERT(reader.Skipped() > 0);
+
+        // a frame being written is not skipped, it is read once complete
+        uint64_t offset = reader.Offset();
+        std::string frame = data.substr(data.find("SLF1", second + 1));
+        append(frame.substr(0, 10));
+        CPPUNIT_ASSERT(!reader.Next(f));
+        CPPUNIT_ASSERT_EQUAL(offset, reader.Offset());
+        append(frame.substr(10));
+        CPPUNIT_ASSERT(reader.Next(f));
+        CPPUNIT_ASSERT_EQUAL(uint64_t(3), f.seq);
+    }
+
+private:
+    void write_records(const FileOptions& options, int n) {
+        auto file = std::make_shared<FileTarget<std::mutex> >(log_file_, LogLevel::Trace, options);
+        logger_t l{"test", LogLevel::Trace, file};
+        for (int i = 0; i < n; i++) {
+            l.Info("record %d", i);
+        }
+    }
+
+    void append(const std::string& s) {
+        std::ofstream(log_file_, std::ios::binary | std::ios::app) << s;
+    }
+
+    std::string read_all() {
+        std::ifstream in(log_file_, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    uint64_t file_size() {
+        return read_all().size();
+    }
+
+    std::string log_file_{TEST_FILE("framed.log")};
+    std::string plain_file_{TEST_FILE("plain.log")};
+}; // class FrameTest
+
+#endif // __SLOG_FRAME_TEST_H_
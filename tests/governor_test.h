@@ -0,0 +1,177 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_GOVERNOR_TEST_H_
+#define __SLOG_GOVERNOR_TEST_H_
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <slog/logger.h>
+#include <slog/governor.h>
+#include "test_utils.h"
+
+using namespace slog;
+
+/**
+ * GovernorTest
+ *
+ * Group of tests to validate shedding the records
+ * of the saturated targets
+*/
+class GovernorTest: public CppUnit::TestCase
+{
+    CPPUNIT_TEST_SUITE(GovernorTest);
+    CPPUNIT_TEST(testShedAndRestore);
+    CPPUNIT_TEST(testLockWait);
+    CPPUNIT_TEST(testTargetLevel);
+    CPPUNIT_TEST_SUITE_END();
+
+    using logger_t = BasicLogger<Pattern<pattern::Level, pattern::Message>>;
+
+    // LockedFileTarget exposes the lock of the file target
+    class LockedFileTarget: public FileTarget<std::mutex> {
+    public:
+        using FileTarget<std::mutex>::FileTarget;
+        std::mutex& Lock() {
+            return mutex_;
+        }
+    };
+
+public:
+    GovernorTest() = default;
+    ~GovernorTest() = default;
+    void setUp() {
+        cleanupTestdata();
+    }
+    void tearDown() {
+        cleanupTestdata();
+    }
+
+protected:
+    void testShedAndRestore() {
+        GovernorOptions options;
+        options.latency = std::chrono::microseconds(500);
+        options.interval = std::chrono::milliseconds(0);
+        options.recovery = std::chrono::milliseconds(200);
+        auto governor = std::make_shared<Governor>(options);
+        auto target = std::make_shared<RecordTarget>(LogLevel::Trace);
+        target->SetGovernor(governor);
+        logger_t l{"test", LogLevel::Trace, target};
+
+        // Trace is shed first, then Debug, never Info
+        target->delay = std::chrono::milliseconds(2);
+        l.Trace("t1");
+        CPPUNIT_ASSERT_EQUAL(LogLevel::Debug, governor->Threshold());
+        l.Trace("t2");
+        l.Debug("d1");
+        CPPUNIT_ASSERT_EQUAL(LogLevel::Info, governor->Threshold());
+        l.Debug("d2");
+        l.Info("i1");
+        CPPUNIT_ASSERT_EQUAL(LogLevel::Info, governor->Threshold());
+        CPPUNIT_ASSERT_EQUAL(uint64_t(1), governor->Episodes());
+
+        // the levels are restored one by one, after the recovery time
+        target->delay = std::chrono::milliseconds(0);
+        l.Info("i2");
+        CPPUNIT_ASSERT_EQUAL(LogLevel::Info, governor->Threshold());
+        std::this_thread::sleep_for(std::chrono::milliseconds(250));
+        l.Info("i3");
+        CPPUNIT_ASSERT_EQUAL(LogLevel::Debug, governor->Threshold());
+        l.Debug("d3");
+        l.Trace("t3");
+        std::this_thread::sleep_for(std::chrono::milliseconds(250));
+        l.Info("i4");
+        CPPUNIT_ASSERT_EQUAL(LogLevel::Trace, governor->Threshold());
+        l.Trace("t4");
+
+        CPPUNIT_ASSERT_EQUAL(uint64_t(2), governor->ShedCount(LogLevel::Trace));
+        CPPUNIT_ASSERT_EQUAL(uint64_t(1), governor->ShedCount(LogLevel::Debug));
+        CPPUNIT_ASSERT_EQUAL(size_t(10), target->records.size());
+        CPPUNIT_ASSERT_EQUAL(std::string("[T] t1"), target->records[0]);
+        CPPUNIT_ASSERT(hasSuffix(target->records[1], "shedding trace records"));
+        CPPUNIT_ASSERT_EQUAL(std::string("[D] d1"), target->records[2]);
+        CPPUNIT_ASSERT_EQUAL(std::string("[I] i1"), target->records[3]);
+        CPPUNIT_ASSERT_EQUAL(std::string("[D] d3"), target->records[6]);
+        CPPUNIT_ASSERT_EQUAL(std::string("[I] i4"), target->records[7]);
+        CPPUNIT_ASSERT(hasSuffix(target->records[8], "shed 2 trace, 1 debug records"));
+        CPPUNIT_ASSERT_EQUAL(std::string("[T] t4"), target->records[9]);
+    }
+
+    void testLockWait() {
+        GovernorOptions options;
+        options.latency = std::chrono::seconds(10);
+        options.lock_wait = std::chrono::microseconds(500);
+        options.interval = std::chrono::milliseconds(0);
+        auto governor = std::make_shared<Governor>(options);
+        LockedFileTarget file{TEST_FILE("governed.log"), LogLevel::Trace};
+        file.SetGovernor(governor);
+
+        file.Write(LogLevel::Trace, "free", 4);
+        CPPUNIT_ASSERT_EQUAL(LogLevel::Trace, governor->Threshold());
+
+        // a write waiting for the lock held by another thread
+        std::mutex ready;
+        ready.lock();
+        std::thread holder([&]() {
+            std::lock_guard<std::mutex> lock(file.Lock());
+            ready.unlock();
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        });
+        ready.lock();
+        file.Write(LogLevel::Trace, "contended", 9);
+        holder.join();
+        ready.unlock();
+        CPPUNIT_ASSERT_EQUAL(LogLevel::Debug, governor->Threshold());
+        file.Write(LogLevel::Trace, "shed", 4);
+        CPPUNIT_ASSERT_EQUAL(uint64_t(1), governor->ShedCount(LogLevel::Trace));
+    }
+    void testTargetLevel() {
+        GovernorOptions options;
+        options.latency = std::chrono::microseconds(500);
+        options.interval = std::chrono::milliseconds(0);
+        options.recovery = std::chrono::milliseconds(0);
+        auto governor = std::make_shared<Governor>(options);
+        auto target = std::make_shared<RecordTarget>(LogLevel::Debug);
+        target->SetGovernor(governor);
+        CPPUNIT_ASSERT_EQUAL(LogLevel::Debug, governor->Threshold());
+        logger_t l{"test", LogLevel::Trace, target};
+
+        // the shedding starts from the level of the target
+        target->delay = std::chrono::milliseconds(2);
+        l.Debug("d1");
+        CPPUNIT_ASSERT_EQUAL(LogLevel::Info, governor->Threshold());
+        l.Debug("d2");
+        target->delay = std::chrono::milliseconds(0);
+        l.Info("i1");
+        l.Info("i2");
+        CPPUNIT_ASSERT_EQUAL(LogLevel::Debug, governor->Threshold());
+        CPPUNIT_ASSERT_EQUAL(size_t(5), target->records.size());
+        CPPUNIT_ASSERT(hasSuffix(target->records[1], "shedding debug records"));
+        CPPUNIT_ASSERT_EQUAL(std::string("[I] i1"), target->records[2]);
+        CPPUNIT_ASSERT(hasSuffix(target->records[3], "shed 1 debug records"));
+
+        // nothing to shed above the floor
+        target->SetLogLevel(LogLevel::Info);
+        CPPUNIT_ASSERT_EQUAL(LogLevel::Info, governor->Threshold());
+        target->delay = std::chrono::milliseconds(2);
+        l.Info("i3");
+        l.Info("i4");
+        CPPUNIT_ASSERT_EQUAL(LogLevel::Info, governor->Threshold());
+        CPPUNIT_ASSERT_EQUAL(uint64_t(1), governor->Episodes());
+        CPPUNIT_ASSERT_EQUAL(size_t(7), target->records.size());
+    }
+
+}; // class GovernorTest
+
+#endif // __SLOG_GOVERNOR_TEST_H_
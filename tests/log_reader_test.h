@@ -0,0 +1,185 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_LOG_READER_TEST_H_
+#define __SLOG_LOG_READER_TEST_H_
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <slog/logger.h>
+#include <slog/log_reader.h>
+#include "test_utils.h"
+
+using namespace slog;
+
+/**
+ * LogReaderTest
+ *
+ * Group of tests to validate following the log files
+*/
+class LogReaderTest: public CppUnit::TestCase
+{
+    CPPUNIT_TEST_SUITE(LogReaderTest);
+    CPPUNIT_TEST(testText);
+    CPPUNIT_TEST(testRotation);
+    CPPUNIT_TEST(testFramedCheckpoint);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    LogReaderTest() = default;
+    ~LogReaderTest() = default;
+    void setUp() {
+        cleanupTestdata();
+    }
+    void tearDown() {
+        cleanupTestdata();
+    }
+
+protected:
+    void testText() {
+        auto file = std::make_shared<FileTarget<std::mutex> >(log_file_, LogLevel::Trace);
+        Logger l{"test", LogLevel::Trace, file};
+        LogReader reader{log_file_};
+        LogRecord r;
+        CPPUNIT_ASSERT(!reader.Next(r));
+
+        l.Info("one");
+        l.Error("two\nsecond line\nthird line");
+        l.Debug("three");
+        l.Flush();
+        CPPUNIT_ASSERT(reader.Wait(1000));
+
+        CPPUNIT_ASSERT(reader.Next(r));
+        CPPUNIT_ASSERT_EQUAL(uint64_t(0), r.offset);
+        CPPUNIT_ASSERT_EQUAL(LogLevel::Info, r.fields.level);
+        CPPUNIT_ASSERT_EQUAL(std::string("one"), std::string(r.fields.msg, r.fields.msg_len));
+        CPPUNIT_ASSERT(reader.Next(r));
+        CPPUNIT_ASSERT_EQUAL(LogLevel::Error, r.fields.level);
+        CPPUNIT_ASSERT_EQUAL(std::string("two\nsecond line\nthird line"), std::string(r.fields.msg, r.fields.msg_len));
+        CPPUNIT_ASSERT(hasSuffix(std::string(r.data, r.len), "[E] two\nsecond line\nthird line"));
+        CPPUNIT_ASSERT(reader.Next(r));
+        CPPUNIT_ASSERT_EQUAL(std::string("three"), std::string(r.fields.msg, r.fields.msg_len));
+        CPPUNIT_ASSERT(!reader.Next(r));
+        CPPUNIT_ASSERT(!reader.Wait(10));
+
+        // a record is returned once it is complete
+        std::string record = "[Mon Oct 19 15:30:41 2026] [1] [W] four\n";
+        append(record.substr(0, 20));
+        CPPUNIT_ASSERT(!reader.Next(r));
+        append(record.substr(20));
+        CPPUNIT_ASSERT(reader.Next(r));
+        CPPUNIT_ASSERT_EQUAL(LogLevel::Warning, r.fields.level);
+        CPPUNIT_ASSERT_EQUAL(std::string("four"), std::string(r.fields.msg, r.fields.msg_len));
+        CPPUNIT_ASSERT(!reader.Next(r));
+
+        // lines not in the record layout are records of their own
+        append("plain line\n");
+        CPPUNIT_ASSERT(reader.Next(r));
+        CPPUNIT_ASSERT_EQUAL(LogLevel::Unknown, r.fields.level);
+        CPPUNIT_ASSERT_EQUAL(std::string("plain line"), std::string(r.data, r.len));
+
+        CPPUNIT_ASSERT_EQUAL(file_size(), reader.Checkpoint().offset);
+    }
+
+    void testRotation() {
+        LogReader reader{log_file_};
+        LogRecord r;
+        CPPUNIT_ASSERT(!reader.Next(r));
+
+        auto file = std::make_shared<FileTarget<std::mutex> >(log_file_, LogLevel::Trace);
+        Logger l{"test", LogLevel::Trace, file};
+        l.Info("one");
+        l.Flush();
+        CPPUNIT_ASSERT(reader.Next(r));
+        CPPUNIT_ASSERT_EQUAL(std::string("one"), std::string(r.fields.msg, r.fields.msg_len));
+
+        // the records written to the rotated file are read first
+        CPPUNIT_ASSERT_EQUAL(0, rename(log_file_.c_str(), (log_file_ + ".1").c_str()));
+        l.Info("two");
+        l.Flush();
+        CPPUNIT_ASSERT(reader.Next(r));
+        CPPUNIT_ASSERT_EQUAL(std::string("two"), std::string(r.fields.msg, r.fields.msg_len));
+        CPPUNIT_ASSERT(!reader.Next(r));
+
+        auto next = std::make_shared<FileTarget<std::mutex> >(log_file_, LogLevel::Trace);
+        Logger l2{"test", LogLevel::Trace, next};
+        l2.Info("three");
+        l2.Flush();
+        CPPUNIT_ASSERT(reader.Next(r));
+        CPPUNIT_ASSERT_EQUAL(std::string("three"), std::string(r.fields.msg, r.fields.msg_len));
+        CPPUNIT_ASSERT_EQUAL(uint64_t(0), r.offset);
+        CPPUNIT_ASSERT_EQUAL(uint64_t(1), reader.Rotations());
+
+        // copytruncate
+        CPPUNIT_ASSERT_EQUAL(0, truncate(log_file_.c_str(), 0));
+        append("[Mon Oct 19 15:30:41 2026] [1] [I] four\n");
+        CPPUNIT_ASSERT(reader.Next(r));
+        CPPUNIT_ASSERT_EQUAL(std::string("four"), std::string(r.fields.msg, r.fields.msg_len));
+        CPPUNIT_ASSERT_EQUAL(uint64_t(1), reader.Truncations());
+        CPPUNIT_ASSERT_EQUAL(uint64_t(0), reader.Skipped());
+    }
+
+    void testFramedCheckpoint() {
+        FileOptions options;
+        options.framed = true;
+        auto file = std::make_shared<FileTarget<std::mutex> >(log_file_, LogLevel::Trace, options);
+        BasicLogger<Pattern<pattern::Level, pattern::Message>> l{"test", LogLevel::Trace, file};
+        l.Info("one");
+        l.Warning("two");
+        l.Flush();
+
+        std::string checkpoint_file = TEST_FILE("reader.checkpoint");
+        {
+            LogReader reader{log_file_};
+            LogRecord r;
+            CPPUNIT_ASSERT(reader.Next(r));
+            CPPUNIT_ASSERT_EQUAL(uint64_t(1), r.seq);
+            CPPUNIT_ASSERT_EQUAL(LogLevel::Info, r.fields.level);
+            CPPUNIT_ASSERT_EQUAL(std::string("[I] one"), std::string(r.data, r.len));
+            CPPUNIT_ASSERT(reader.Checkpoint().Save(checkpoint_file));
+        }
+
+        l.Error("three");
+        l.Flush();
+        ReaderCheckpoint checkpoint;
+        CPPUNIT_ASSERT(checkpoint.Load(checkpoint_file));
+        LogReader reader{log_file_, checkpoint};
+        LogRecord r;
+        CPPUNIT_ASSERT(reader.Next(r));
+        CPPUNIT_ASSERT_EQUAL(uint64_t(2), r.seq);
+        CPPUNIT_ASSERT(reader.Next(r));
+        CPPUNIT_ASSERT_EQUAL(uint64_t(3), r.seq);
+        CPPUNIT_ASSERT_EQUAL(std::string("[E] three"), std::string(r.data, r.len));
+        CPPUNIT_ASSERT(!reader.Next(r));
+
+        // a checkpoint of another file is not applied
+        checkpoint.inode++;
+        LogReader other{log_file_, checkpoint};
+        CPPUNIT_ASSERT(other.Next(r));
+        CPPUNIT_ASSERT_EQUAL(uint64_t(1), r.seq);
+    }
+
+private:
+    void append(const std::string& s) {
+        std::ofstream(log_file_, std::ios::binary | std::ios::app) << s;
+    }
+
+    uint64_t file_size() {
+        std::ifstream in(log_file_, std::ios::binary | std::ios::ate);
+        return static_cast<uint64_t>(in.tellg());
+    }
+
+    std::string log_file_{TEST_FILE("reader.log")};
+}; // class LogReaderTest
+
+#endif // __SLOG_LOG_READER_TEST_H_
@@ -0,0 +1,110 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_LOG_STREAM_TEST_H_
+#define __SLOG_LOG_STREAM_TEST_H_
+
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <slog/logger.h>
+#include "test_utils.h"
+
+using namespace slog;
+
+/**
+ * LogStreamTest
+ *
+ * Group of tests to validate the streaming API
+*/
+class LogStreamTest: public CppUnit::TestCase
+{
+    CPPUNIT_TEST_SUITE(LogStreamTest);
+    CPPUNIT_TEST(testStream);
+    CPPUNIT_TEST(testDisabled);
+    CPPUNIT_TEST(testNested);
+    CPPUNIT_TEST_SUITE_END();
+
+    using logger_t = BasicLogger<Pattern<pattern::Level, pattern::Message>>;
+
+    // Point logs a record while being streamed
+    struct Point {
+        logger_t& log;
+        int x, y;
+    };
+
+    friend std::ostream& operator<<(std::ostream& os, const Point& p) {
+        p.log.Debug() << "streaming a point";
+        return os << '(' << p.x << ", " << p.y << ')';
+    }
+
+public:
+    LogStreamTest() = default;
+    ~LogStreamTest() = default;
+
+protected:
+    void testStream() {
+        auto target = std::make_shared<RecordTarget>(LogLevel::Trace);
+        logger_t l{"test", LogLevel::Trace, target};
+
+        l.Info() << "x=" << 42 << ' ' << 1.5 << " " << std::string("str") << std::endl;
+        l.Warning() << std::hex << std::setw(4) << std::setfill('0') << 255 << std::boolalpha << true;
+        // the formatting of the previous record is not carried over
+        l.Error() << 255 << ' ' << true << ' ' << 3.14159265;
+        SLOG_CRITICAL(l) << "macro " << 1;
+        l.Info() << "";
+        // the streamed bytes are copied as they are, not as a format
+        l.Info() << "100%s " << std::string("a\0b", 3);
+
+        CPPUNIT_ASSERT_EQUAL(size_t(6), target->records.size());
+        CPPUNIT_ASSERT_EQUAL(std::string("[I] x=42 1.5 str\n"), target->records[0]);
+        CPPUNIT_ASSERT_EQUAL(std::string("[W] 00fftrue"), target->records[1]);
+        CPPUNIT_ASSERT_EQUAL(std::string("[E] 255 1 3.14159"), target->records[2]);
+        CPPUNIT_ASSERT_EQUAL(std::string("[C] macro 1"), target->records[3]);
+        CPPUNIT_ASSERT_EQUAL(std::string("[I] "), target->records[4]);
+        CPPUNIT_ASSERT_EQUAL(std::string("[I] 100%s a\0b", 13), target->records[5]);
+    }
+
+    void testDisabled() {
+        auto target = std::make_shared<RecordTarget>(LogLevel::Info);
+        logger_t l{"test", LogLevel::Trace, target};
+        int calls = 0;
+        auto expensive = [&calls]() { return ++calls; };
+
+        CPPUNIT_ASSERT(!l.Enabled(LogLevel::Debug));
+        CPPUNIT_ASSERT(l.Enabled(LogLevel::Info));
+        SLOG_DEBUG(l) << expensive();
+        CPPUNIT_ASSERT_EQUAL(0, calls);
+        CPPUNIT_ASSERT(!l.Debug());
+        l.Debug() << "dropped";
+        CPPUNIT_ASSERT(target->records.empty());
+
+        if (calls == 0) SLOG_INFO(l) << expensive();
+        else CPPUNIT_FAIL("unexpected branch");
+        CPPUNIT_ASSERT_EQUAL(1, calls);
+        CPPUNIT_ASSERT_EQUAL(std::string("[I] 1"), target->records.back());
+    }
+
+    void testNested() {
+        auto target = std::make_shared<RecordTarget>(LogLevel::Trace);
+        logger_t l{"test", LogLevel::Trace, target};
+
+        l.Info() << "point " << Point{l, 1, 2} << " done";
+        CPPUNIT_ASSERT_EQUAL(size_t(2), target->records.size());
+        CPPUNIT_ASSERT_EQUAL(std::string("[D] streaming a point"), target->records[0]);
+        CPPUNIT_ASSERT_EQUAL(std::string("[I] point (1, 2) done"), target->records[1]);
+
+        l.Info() << "reused";
+        CPPUNIT_ASSERT_EQUAL(std::string("[I] reused"), target->records[2]);
+    }
+}; // class LogStreamTest
+
+#endif // __SLOG_LOG_STREAM_TEST_H_
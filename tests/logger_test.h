@@ -9,6 +9,7 @@
 #ifndef __SLOG_LOGGER_TEST_H_
 #define __SLOG_LOGGER_TEST_H_
 
+#include <thread>
 #include <cppunit/TestCase.h>
 #include <cppunit/extensions/HelperMacros.h>
 
@@ -29,6 +30,7 @@ class LoggerTest: public CppUnit::TestCase
     CPPUNIT_TEST(testWithDefaltOptions);
     CPPUNIT_TEST(testWithCustomOptions);
     CPPUNIT_TEST(testLoggingToTarget);
+    CPPUNIT_TEST(testBatch);
     CPPUNIT_TEST_SUITE_END();
 
     #define TEST_DIR "testdata"
@@ -100,6 +102,45 @@ protected:
         std::getline(fs, msg);
         CPPUNIT_ASSERT_MESSAGE("expected a nil string, but read: " + msg, msg.length() == 0);
     }
+    void testBatch() {
+        auto file = std::make_shared<FileTarget<std::mutex> >(test_file_, LogLevel::Info);
+        BasicLogger<Pattern<pattern::Message>> l{"test", LogLevel::Debug, file};
+
+        std::thread other([&l]() {
+            for (int i = 0; i < 200; i++) l.Info("single %d", i);
+        });
+        for (int b = 0; b < 20; b++) {
+            auto batch = l.Batch();
+            for (int i = 0; i < 10; i++) {
+                batch.Info("batch %d line %d", b, i);
+                // filtered by the target level
+                batch.Debug("batch %d debug %d", b, i);
+            }
+        }
+        other.join();
+        {
+            // an empty batch writes nothing, a moved-from one neither
+            auto batch = l.Batch();
+            auto moved = std::move(batch);
+            moved.Info("last");
+        }
+        l.Flush();
+
+        std::ifstream fs(test_file_, std::ifstream::in);
+        std::vector<std::string> lines;
+        std::string line;
+        while (std::getline(fs, line)) lines.push_back(line);
+        CPPUNIT_ASSERT_EQUAL(size_t(200 + 200 + 1), lines.size());
+        CPPUNIT_ASSERT_EQUAL(std::string("last"), lines.back());
+        // the records of a batch are contiguous
+        for (size_t n = 0; n < lines.size(); n++) {
+            if (lines[n].compare(0, 6, "batch ") != 0 || lines[n].find(" line 0") == std::string::npos) continue;
+            for (int i = 1; i < 10; i++) {
+                CPPUNIT_ASSERT_MESSAGE(lines[n + i], lines[n + i].find(" line " + std::to_string(i)) != std::string::npos);
+            }
+        }
+    }
+
     // FIXME(avalluri): add more logging tests to cover:
     //  > Multi-target logging
     //  > Concurrent logging
@@ -0,0 +1,165 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_MEMORY_TEST_H_
+#define __SLOG_MEMORY_TEST_H_
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <slog/logger.h>
+#include <slog/memory.h>
+#include "test_utils.h"
+
+using namespace slog;
+
+/**
+ * MemoryTest
+ *
+ * Group of tests to validate the memory accounting
+ * and the logging under memory pressure
+*/
+class MemoryTest: public CppUnit::TestCase
+{
+    CPPUNIT_TEST_SUITE(MemoryTest);
+    CPPUNIT_TEST(testAccount);
+    CPPUNIT_TEST(testDegrade);
+    CPPUNIT_TEST(testFileTarget);
+    CPPUNIT_TEST(testTargetPressure);
+    CPPUNIT_TEST_SUITE_END();
+
+    using logger_t = BasicLogger<Pattern<pattern::Level, pattern::Message>>;
+
+public:
+    MemoryTest() = default;
+    ~MemoryTest() = default;
+    void setUp() {
+        cleanupTestdata();
+    }
+    void tearDown() {
+        cleanupTestdata();
+    }
+
+protected:
+    void testAccount() {
+        auto parent = std::make_shared<MemoryAccount>(1000);
+        MemoryAccount child{0, parent};
+        {
+            std::vector<char, Allocator<char> > v{Allocator<char>(&child)};
+            v.reserve(600);
+            CPPUNIT_ASSERT_EQUAL(size_t(600), child.Current());
+            CPPUNIT_ASSERT_EQUAL(size_t(600), parent->Current());
+
+            // the parent budget applies to the child allocations
+            CPPUNIT_ASSERT_THROW(v.reserve(1200), std::bad_alloc);
+            CPPUNIT_ASSERT_EQUAL(size_t(600), v.capacity());
+            CPPUNIT_ASSERT_EQUAL(size_t(600), child.Current());
+            CPPUNIT_ASSERT_EQUAL(uint64_t(1), parent->Refused());
+            CPPUNIT_ASSERT(!child.UnderPressure());
+            CPPUNIT_ASSERT(!parent->UnderPressure());
+
+            MemoryBuffer b{Allocator<char>(parent.get())};
+            b.reserve(200);
+            CPPUNIT_ASSERT(parent->UnderPressure());
+        }
+        CPPUNIT_ASSERT_EQUAL(size_t(0), child.Current());
+        CPPUNIT_ASSERT_EQUAL(size_t(0), parent->Current());
+        CPPUNIT_ASSERT_EQUAL(size_t(600), child.Peak());
+        CPPUNIT_ASSERT(parent->Peak() > 800);
+        CPPUNIT_ASSERT(!parent->UnderPressure());
+    }
+
+    void testDegrade() {
+        auto target = std::make_shared<RecordTarget>(LogLevel::Trace);
+        logger_t l{"test", LogLevel::Trace, target};
+        auto account = std::make_shared<MemoryAccount>(1000);
+        l.SetMemoryAccount(account);
+
+        l.Trace("one");
+        void *p = account->Allocate(800);
+        CPPUNIT_ASSERT(!l.Enabled(LogLevel::Trace));
+        CPPUNIT_ASSERT(l.Enabled(LogLevel::Debug));
+        l.Trace("two");
+        l.Trace() << "three";
+        l.Debug("four");
+        account->Deallocate(p, 800);
+        l.Trace("five");
+
+        CPPUNIT_ASSERT_EQUAL(uint64_t(1), l.Dropped());
+        CPPUNIT_ASSERT_EQUAL(size_t(3), target->records.size());
+        CPPUNIT_ASSERT_EQUAL(std::string("[T] one"), target->records[0]);
+        CPPUNIT_ASSERT_EQUAL(std::string("[D] four"), target->records[1]);
+        CPPUNIT_ASSERT_EQUAL(std::string("[T] five"), target->records[2]);
+
+        // batches grow only as far as the budget allows
+        account->SetPressureLimit(0);
+        {
+            auto batch = l.Batch();
+            for (int i = 0; i < 100; i++) {
+                batch.Info("record %d", i);
+            }
+            CPPUNIT_ASSERT(account->Current() <= account->Budget());
+        }
+        CPPUNIT_ASSERT(l.Dropped() > 1);
+        CPPUNIT_ASSERT_EQUAL(size_t(100 + 4) - l.Dropped(), target->records.size());
+        CPPUNIT_ASSERT_EQUAL(std::string("[I] record 0"), target->records[3]);
+        CPPUNIT_ASSERT_EQUAL(size_t(0), account->Current());
+    }
+
+    void testFileTarget() {
+        auto account = std::make_shared<MemoryAccount>();
+        FileOptions options;
+        options.memory = account;
+        {
+            FileTarget<std::mutex> file{TEST_FILE("buffered.log"), LogLevel::Trace, options};
+            CPPUNIT_ASSERT(account->Current() >= BUFSIZ);
+            file.Write(LogLevel::Info, "buffered", 8);
+        }
+        CPPUNIT_ASSERT_EQUAL(size_t(0), account->Current());
+        CPPUNIT_ASSERT_EQUAL(std::string("buffered\n"), read_file(TEST_FILE("buffered.log")));
+
+        // without the memory for the stdio buffer the file is written unbuffered
+        options.memory = std::make_shared<MemoryAccount>(64);
+        FileTarget<std::mutex> file{TEST_FILE("unbuffered.log"), LogLevel::Trace, options};
+        file.Write(LogLevel::Info, "unbuffered", 10);
+        CPPUNIT_ASSERT_EQUAL(std::string("unbuffered\n"), read_file(TEST_FILE("unbuffered.log")));
+    }
+
+    void testTargetPressure() {
+        auto account = std::make_shared<MemoryAccount>(4 * BUFSIZ);
+        FileOptions options;
+        options.memory = account;
+        auto file = std::make_shared<FileTarget<std::mutex> >(TEST_FILE("pressure.log"), LogLevel::Trace, options);
+        logger_t l{"test", LogLevel::Trace, file};
+
+        l.Trace("one");
+        // fill the target budget, the logger sheds its trace records
+        void *p = account->Allocate(3 * BUFSIZ);
+        CPPUNIT_ASSERT(account->UnderPressure());
+        CPPUNIT_ASSERT(!l.Enabled(LogLevel::Trace));
+        l.Trace("two");
+        l.Debug("three");
+        account->Deallocate(p, 3 * BUFSIZ);
+        l.Trace("four");
+        l.Flush();
+
+        CPPUNIT_ASSERT_EQUAL(uint64_t(1), l.Dropped());
+        CPPUNIT_ASSERT_EQUAL(std::string("[T] one\n[D] three\n[T] four\n"), read_file(TEST_FILE("pressure.log")));
+    }
+
+private:
+    std::string read_file(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+}; // class MemoryTest
+
+#endif // __SLOG_MEMORY_TEST_H_
@@ -0,0 +1,162 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_PATTERN_TEST_H_
+#define __SLOG_PATTERN_TEST_H_
+
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <slog/pattern.h>
+#include <slog/runtime_pattern.h>
+#include <slog/decorators.h>
+#include <slog/logger.h>
+#include "test_utils.h"
+
+using namespace slog;
+
+/**
+ * PatternTest
+ *
+ * Group of tests to validate the compile-time and the runtime
+ * record patterns
+*/
+class PatternTest: public CppUnit::TestCase
+{
+    CPPUNIT_TEST_SUITE(PatternTest);
+    CPPUNIT_TEST(testDefaultPattern);
+    CPPUNIT_TEST(testCustomPattern);
+    CPPUNIT_TEST(testLoggerPattern);
+    CPPUNIT_TEST(testRuntimePattern);
+    CPPUNIT_TEST(testRuntimeLoggerPattern);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    PatternTest() = default;
+    ~PatternTest() = default;
+    void setUp() {
+        cleanupTestdata();
+    }
+    void tearDown() {
+        cleanupTestdata();
+    }
+
+protected:
+    void testDefaultPattern() {
+        std::string name{"test"}, out;
+        auto now = std::chrono::system_clock::now();
+        pattern::Record r{LogLevel::Warning, name, now};
+        CPPUNIT_ASSERT(DefaultPattern().Format(out, r, "value %d of %s", 42, "answer"));
+
+        // same layout as the decorators
+        std::string expected = DateTimeDecorator(std::chrono::system_clock::to_time_t(now)).string() +
+            " " + PidDecorator().string() + " " + LogLevelDecorator(LogLevel::Warning).string() +
+            " value 42 of answer";
+        CPPUNIT_ASSERT_EQUAL(expected, out);
+    }
+
+    void testCustomPattern() {
+        std::string name{"net"}, out;
+        auto time = fixedTime() + std::chrono::microseconds(4321);
+        pattern::Record r{LogLevel::Error, name, time};
+
+        Pattern<pattern::Timestamp<pattern::us>, pattern::Level, pattern::Name, pattern::Message> p1;
+        CPPUNIT_ASSERT(p1.Format(out, r, "%s", "down"));
+        CPPUNIT_ASSERT_EQUAL(std::string("[2023-11-02 12:38:19.004321] [E] [net] down"), out);
+
+        // the message could be anywhere in the pattern
+        Pattern<pattern::Level, pattern::Message, pattern::Timestamp<pattern::ms>> p2;
+        CPPUNIT_ASSERT(p2.Format(out, r, "link"));
+        CPPUNIT_ASSERT_EQUAL(std::string("[E] link [2023-11-02 12:38:19.004]"), out);
+
+        Pattern<pattern::Timestamp<pattern::seconds>, pattern::Message> p3;
+        CPPUNIT_ASSERT(p3.Format(out, r, "up"));
+        CPPUNIT_ASSERT_EQUAL(std::string("[2023-11-02 12:38:19] up"), out);
+
+        Pattern<pattern::Message> p4;
+        CPPUNIT_ASSERT(p4.Format(out, r, "%05d", 7));
+        CPPUNIT_ASSERT_EQUAL(std::string("00007"), out);
+    }
+
+    void testLoggerPattern() {
+        using MyLogger = BasicLogger<Pattern<pattern::Level, pattern::Name, pattern::Message>>;
+        MyLogger l{"app", LogLevel::Info, std::make_shared<FileTarget<std::mutex> >(test_file_, LogLevel::Trace)};
+        l.Info("hello %s", "world");
+        l.Debug("filtered");
+        l.Flush();
+
+        std::ifstream fs(test_file_, std::ifstream::in);
+        std::string msg;
+        std::getline(fs, msg);
+        CPPUNIT_ASSERT_EQUAL(std::string("[I] [app] hello world"), msg);
+        CPPUNIT_ASSERT(!std::getline(fs, msg));
+    }
+
+    void testRuntimePattern() {
+        std::string name{"net"}, out, expected;
+        auto now = std::chrono::system_clock::now();
+        pattern::Record r{LogLevel::Info, name, now};
+
+        // the default runtime pattern matches the default pattern
+        CPPUNIT_ASSERT(DefaultPattern().Format(expected, r, "n=%d", 5));
+        CPPUNIT_ASSERT(RuntimePattern().Format(out, r, "n=%d", 5));
+        CPPUNIT_ASSERT_EQUAL(expected, out);
+
+        r.time = fixedTime() + std::chrono::nanoseconds(4321987);
+        RuntimePattern p1{"%Y-%m-%d %H:%M:%S.%f [%p:%t] %l %n: %v"};
+        CPPUNIT_ASSERT(p1.Format(out, r, "%s", "up"));
+        Pattern<pattern::Pid, pattern::ThreadId> ids;
+        ids.Format(expected, r, "");
+        expected = "2023-11-02 12:38:19.004321 " + expected.replace(expected.find("] ["), 3, ":") +
+            " info net: up";
+        CPPUNIT_ASSERT_EQUAL(expected, out);
+
+        RuntimePattern p2{"%v|%e|%F|%L|100%%|%H:%M 50%%|%"};
+        CPPUNIT_ASSERT(p2.Format(out, r, "msg"));
+        CPPUNIT_ASSERT_EQUAL(std::string("msg|004|004321987|I|100%|12:38 50%|%"), out);
+        CPPUNIT_ASSERT_EQUAL(std::string("%v|%e|%F|%L|100%%|%H:%M 50%%|%"), p2.String());
+
+        // the strftime() results are cached per second
+        r.time = fixedTime() + std::chrono::seconds(61);
+        CPPUNIT_ASSERT(p2.Format(out, r, "msg"));
+        CPPUNIT_ASSERT_EQUAL(std::string("msg|000|000000000|I|100%|12:39 50%|%"), out);
+
+        // a message already rendered is copied as it is
+        CPPUNIT_ASSERT(p2.Format(out, r, nullptr, pattern::Text{"%d%%", 4}));
+        CPPUNIT_ASSERT_EQUAL(std::string("%d%%|000|000000000|I|100%|12:39 50%|%"), out);
+        Pattern<pattern::Level, pattern::Message> level;
+        CPPUNIT_ASSERT(level.Format(out, r, nullptr, pattern::Text{"%d%%", 4}));
+        CPPUNIT_ASSERT_EQUAL(std::string("[I] %d%%"), out);
+    }
+
+    void testRuntimeLoggerPattern() {
+        BasicLogger<RuntimePattern> l{"app", LogLevel::Info,
+            std::make_shared<FileTarget<std::mutex> >(test_file_, LogLevel::Trace)};
+        l.SetPattern(RuntimePattern{"%l %n: %v"});
+        l.Warning("disk %d%% full", 91);
+        l.Flush();
+
+        std::ifstream fs(test_file_, std::ifstream::in);
+        std::string msg;
+        std::getline(fs, msg);
+        CPPUNIT_ASSERT_EQUAL(std::string("warning app: disk 91% full"), msg);
+    }
+
+private:
+    // fixedTime returns the local time 2023-11-02 12:38:19
+    static std::chrono::system_clock::time_point fixedTime() {
+        std::tm tm{};
+        tm.tm_year = 2023 - 1900; tm.tm_mon = 10; tm.tm_mday = 2;
+        tm.tm_hour = 12; tm.tm_min = 38; tm.tm_sec = 19; tm.tm_isdst = -1;
+        return std::chrono::system_clock::from_time_t(std::mktime(&tm));
+    }
+
+    std::string test_file_{TEST_FILE("test-logs.txt")}; // file name used for testing
+}; // class PatternTest
+
+#endif // __SLOG_PATTERN_TEST_H_
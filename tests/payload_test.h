@@ -0,0 +1,142 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_PAYLOAD_TEST_H_
+#define __SLOG_PAYLOAD_TEST_H_
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <slog/logger.h>
+#include <slog/payload.h>
+#include "test_utils.h"
+
+using namespace slog;
+
+/**
+ * PayloadTest
+ *
+ * Group of tests to validate logging the payloads
+ * and the hex dumps
+*/
+class PayloadTest: public CppUnit::TestCase
+{
+    CPPUNIT_TEST_SUITE(PayloadTest);
+    CPPUNIT_TEST(testHexdump);
+    CPPUNIT_TEST(testLargePayload);
+    CPPUNIT_TEST(testJoinedPayload);
+    CPPUNIT_TEST_SUITE_END();
+
+    using logger_t = BasicLogger<Pattern<pattern::Level, pattern::Message>>;
+
+public:
+    PayloadTest() = default;
+    ~PayloadTest() = default;
+    void setUp() {
+        cleanupTestdata();
+    }
+    void tearDown() {
+        cleanupTestdata();
+    }
+
+protected:
+    void testHexdump() {
+        std::string out;
+        hexdump(out, "hello world\n", 12);
+        CPPUNIT_ASSERT_EQUAL(std::string(
+            "00000000  68 65 6c 6c 6f 20 77 6f  72 6c 64 0a              |hello world.|\n"), out);
+
+        // all the byte values, on full and partial lines
+        std::vector<unsigned char> data(256 + 7);
+        for (size_t i = 0; i < data.size(); i++) data[i] = static_cast<unsigned char>(i * 7);
+        out.clear();
+        hexdump(out, data.data(), data.size());
+        CPPUNIT_ASSERT_EQUAL(reference(data), out);
+
+        out = "keep";
+        hexdump(out, data.data(), 0);
+        CPPUNIT_ASSERT_EQUAL(std::string("keep"), out);
+    }
+
+    void testLargePayload() {
+        std::string body(100 * 1024, 'x');
+        body[0] = '<';
+        {
+            auto file = std::make_shared<FileTarget<std::mutex> >(log_file_, LogLevel::Trace);
+            logger_t l{"test", LogLevel::Info, file};
+            l.SetPayloadLimit(80 * 1024);
+            l.Info("before");
+            l.LogPayload(LogLevel::Info, Payload(body), "body of %d", 1);
+            l.LogPayload(LogLevel::Debug, Payload(body), "disabled");
+            l.LogPayload(LogLevel::Warning, Hexdump(body.data(), 20), "dump");
+            l.Info("after");
+        }
+
+        std::ifstream fs(log_file_);
+        std::vector<std::string> lines;
+        for (std::string line; std::getline(fs, line); ) lines.push_back(line);
+        CPPUNIT_ASSERT_EQUAL(size_t(8), lines.size());
+        CPPUNIT_ASSERT_EQUAL(std::string("[I] before"), lines[0]);
+        CPPUNIT_ASSERT_EQUAL(std::string("[I] body of 1"), lines[1]);
+        CPPUNIT_ASSERT_EQUAL(size_t(80 * 1024), lines[2].size());
+        CPPUNIT_ASSERT_EQUAL(body.substr(0, 80 * 1024), lines[2]);
+        CPPUNIT_ASSERT_EQUAL(std::string("[20480 of 102400 bytes truncated]"), lines[3]);
+        CPPUNIT_ASSERT_EQUAL(std::string("[W] dump"), lines[4]);
+        CPPUNIT_ASSERT_EQUAL(std::string("00000000  3c 78 78 78 78 78 78 78  78 78 78 78 78 78 78 78  |<xxxxxxxxxxxxxxx|"), lines[5]);
+        CPPUNIT_ASSERT_EQUAL(std::string("00000010  78 78 78 78                                       |xxxx|"), lines[6]);
+        CPPUNIT_ASSERT_EQUAL(std::string("[I] after"), lines[7]);
+    }
+
+    void testJoinedPayload() {
+        auto target = std::make_shared<RecordTarget>();
+        logger_t l{"test", LogLevel::Info, target};
+        std::vector<unsigned char> bytes{1, 2, 3};
+        l.LogPayload(LogLevel::Info, Hexdump(bytes), "bytes");
+        l.SetPayloadLimit(2);
+        l.LogPayload(LogLevel::Info, Payload("abc", 3), "text");
+        CPPUNIT_ASSERT_EQUAL(std::string(
+            "[I] bytes\n"
+            "00000000  01 02 03                                          |...|\n"
+            "[I] text\n"
+            "ab\n"
+            "[1 of 3 bytes truncated]\n"), target->Joined());
+    }
+
+private:
+    // reference renders the hex dump the plain way
+    static std::string reference(const std::vector<unsigned char>& data) {
+        std::string out;
+        char buf[24];
+        for (size_t off = 0; off < data.size(); off += 16) {
+            snprintf(buf, sizeof(buf), "%08zx", off);
+            out += std::string(buf, 8) + " ";
+            std::string text;
+            for (size_t i = 0; i < 16; i++) {
+                if (i == 8) out += " ";
+                if (off + i < data.size()) {
+                    unsigned char c = data[off + i];
+                    snprintf(buf, sizeof(buf), " %02x", c);
+                    out += buf;
+                    text += (c >= 0x20 && c < 0x7f) ? static_cast<char>(c) : '.';
+                } else {
+                    out += "   ";
+                }
+            }
+            out += "  |" + text + "|\n";
+        }
+        return out;
+    }
+
+    std::string log_file_{TEST_FILE("test-logs.txt")};
+}; // class PayloadTest
+
+#endif // __SLOG_PAYLOAD_TEST_H_
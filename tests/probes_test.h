@@ -0,0 +1,165 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_PROBES_TEST_H_
+#define __SLOG_PROBES_TEST_H_
+
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <set>
+#include <string>
+#include <sys/uio.h>
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <slog/probes.h>
+#include <slog/target.h>
+#include "test_utils.h"
+
+#if defined(SLOG_PROBE_NOTE_)
+#include <cxxabi.h>
+#include <elf.h>
+#endif
+
+using namespace slog;
+
+// probedWriteIov and probedWriteBatch keep a function of their own, which
+// holds the probes of the Target method should the compiler inline it
+__attribute__((noinline)) static bool probedWriteIov(Target& target) {
+    struct iovec iov[2] = {{(void *)"record", 6}, {(void *)" payload", 8}};
+    return target.WriteIov(LogLevel::Info, iov, 2);
+}
+
+__attribute__((noinline)) static bool probedWriteBatch(Target& target) {
+    RecordBatch batch;
+    batch.Add(LogLevel::Info, "one", 3);
+    batch.Add(LogLevel::Debug, "two", 3);
+    return target.WriteBatch(batch);
+}
+
+/**
+ * ProbesTest
+ *
+ * Group of tests to validate the static tracing probes
+ * recorded in the .note.stapsdt section of the binary
+*/
+class ProbesTest: public CppUnit::TestCase
+{
+    CPPUNIT_TEST_SUITE(ProbesTest);
+    CPPUNIT_TEST(testNotes);
+    CPPUNIT_TEST(testTargetProbes);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    ProbesTest() = default;
+    ~ProbesTest() = default;
+
+protected:
+    void testNotes() {
+#if defined(SLOG_PROBE_NOTE_)
+        auto probes = read_probes();
+        const char *names[] = {"log_entry", "target_enter", "target_accept", "lock_acquire",
+                               "lock_acquired", "lock_release", "flush_begin", "flush_end"};
+        for (auto name : names) {
+            CPPUNIT_ASSERT_MESSAGE(name, probes.count(name) != 0);
+        }
+        CPPUNIT_ASSERT_EQUAL(size_t(8), probes.size());
+#endif
+    }
+
+    void testTargetProbes() {
+        RecordTarget target;
+        CPPUNIT_ASSERT(probedWriteIov(target));
+        CPPUNIT_ASSERT(probedWriteBatch(target));
+        CPPUNIT_ASSERT_EQUAL(std::string("record payload\none\ntwo\n"), target.Joined());
+#if defined(SLOG_PROBE_NOTE_)
+        // both probes are in the write path of WriteIov() and WriteBatch()
+        auto probes = read_probes();
+        const char *methods[] = {"WriteIov", "WriteBatch"};
+        for (auto method : methods) {
+            CPPUNIT_ASSERT_MESSAGE(method, has_probe(probes["target_enter"], method));
+            CPPUNIT_ASSERT_MESSAGE(method, has_probe(probes["target_accept"], method));
+        }
+#endif
+    }
+
+private:
+#if defined(SLOG_PROBE_NOTE_)
+    // probes_t maps the slog probes to the functions holding them
+    using probes_t = std::map<std::string, std::set<std::string> >;
+
+    static bool has_probe(const std::set<std::string>& functions, const char *method) {
+        for (auto &f : functions) {
+            if (f.find(method) != std::string::npos) return true;
+        }
+        return false;
+    }
+
+    // read_probes reads the probe notes and the symbols of the test binary
+    static probes_t read_probes() {
+        std::ifstream in("/proc/self/exe", std::ios::binary);
+        std::string elf((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        CPPUNIT_ASSERT(elf.size() >= sizeof(Elf64_Ehdr));
+        CPPUNIT_ASSERT(memcmp(elf.data(), ELFMAG, SELFMAG) == 0);
+        auto ehdr = reinterpret_cast<const Elf64_Ehdr *>(elf.data());
+        auto shdrs = reinterpret_cast<const Elf64_Shdr *>(elf.data() + ehdr->e_shoff);
+        const char *shstr = elf.data() + shdrs[ehdr->e_shstrndx].sh_offset;
+
+        std::map<uint64_t, std::string> notes; // probe address -> name
+        std::map<uint64_t, std::pair<uint64_t, std::string> > functions; // address -> size, name
+        for (int i = 0; i < ehdr->e_shnum; i++) {
+            auto &sh = shdrs[i];
+            const char *base = elf.data() + sh.sh_offset;
+            if (sh.sh_type == SHT_NOTE && strcmp(shstr + sh.sh_name, ".note.stapsdt") == 0) {
+                for (size_t off = 0; off + sizeof(Elf64_Nhdr) <= sh.sh_size;) {
+                    auto nhdr = reinterpret_cast<const Elf64_Nhdr *>(base + off);
+                    const char *desc = base + off + sizeof(Elf64_Nhdr) + ((nhdr->n_namesz + 3) & ~3);
+                    // the addresses of the probe, the base and the semaphore
+                    const char *provider = desc + 3 * sizeof(uint64_t);
+                    if (nhdr->n_type == 3 && strcmp(provider, "slog") == 0) {
+                        uint64_t pc;
+                        memcpy(&pc, desc, sizeof(pc));
+                        notes[pc] = provider + strlen(provider) + 1;
+                    }
+                    off = desc - base + ((nhdr->n_descsz + 3) & ~3);
+                }
+            } else if (sh.sh_type == SHT_SYMTAB) {
+                auto syms = reinterpret_cast<const Elf64_Sym *>(base);
+                const char *strtab = elf.data() + shdrs[sh.sh_link].sh_offset;
+                for (size_t j = 0; j < sh.sh_size / sizeof(Elf64_Sym); j++) {
+                    if (ELF64_ST_TYPE(syms[j].st_info) != STT_FUNC || !syms[j].st_value) continue;
+                    functions[syms[j].st_value] = std::make_pair(syms[j].st_size,
+                                                                 demangle(strtab + syms[j].st_name));
+                }
+            }
+        }
+
+        probes_t probes;
+        for (auto &note : notes) {
+            auto &holders = probes[note.second];
+            auto f = functions.upper_bound(note.first);
+            if (f == functions.begin()) continue;
+            --f;
+            if (note.first < f->first + f->second.first) holders.insert(f->second.second);
+        }
+        return probes;
+    }
+
+    static std::string demangle(const char *symbol) {
+        int status = 0;
+        char *name = abi::__cxa_demangle(symbol, nullptr, nullptr, &status);
+        if (!name) return symbol;
+        std::string s(name);
+        free(name);
+        return s;
+    }
+#endif
+}; // class ProbesTest
+
+#endif // __SLOG_PROBES_TEST_H_
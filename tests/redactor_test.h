@@ -0,0 +1,155 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_REDACTOR_TEST_H_
+#define __SLOG_REDACTOR_TEST_H_
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <slog/logger.h>
+#include <slog/redactor.h>
+#include "test_utils.h"
+
+using namespace slog;
+
+/**
+ * RedactorTest
+ *
+ * Group of tests to validate masking the secrets
+ * in the records
+*/
+class RedactorTest: public CppUnit::TestCase
+{
+    CPPUNIT_TEST_SUITE(RedactorTest);
+    CPPUNIT_TEST(testPatterns);
+    CPPUNIT_TEST(testCardNumbers);
+    CPPUNIT_TEST(testTargets);
+    CPPUNIT_TEST(testOwnMasks);
+    CPPUNIT_TEST_SUITE_END();
+
+    using logger_t = BasicLogger<Pattern<pattern::Level, pattern::Message>>;
+
+public:
+    RedactorTest() = default;
+    ~RedactorTest() = default;
+
+protected:
+    void testPatterns() {
+        RedactorOptions o;
+        o.patterns = {"password=*", "Bearer *", "s3cr3t", "cr3tive"};
+        Redactor r{o};
+
+        CPPUNIT_ASSERT_EQUAL(std::string("user=bob password=*** next"), redact(r, "user=bob password=abc next"));
+        CPPUNIT_ASSERT_EQUAL(std::string("PASSWORD=***&x=1"), redact(r, "PASSWORD=abc&x=1"));
+        CPPUNIT_ASSERT_EQUAL(std::string("Authorization: bearer *******"), redact(r, "Authorization: bearer eyJhbGc"));
+        // overlapping literals
+        CPPUNIT_ASSERT_EQUAL(std::string("a ********* b"), redact(r, "a s3cr3tive b"));
+        CPPUNIT_ASSERT_EQUAL(std::string("nothing here"), redact(r, "nothing here"));
+
+        // matches beyond the first SIMD blocks, and at the very end
+        std::string line(100, '.');
+        line += "s3cr3t";
+        line += std::string(37, '-');
+        line += "password=";
+        std::string want(100, '.');
+        want += "******" + std::string(37, '-') + "password=";
+        CPPUNIT_ASSERT_EQUAL(want, redact(r, line));
+        CPPUNIT_ASSERT_EQUAL(std::string("x s3cr3"), redact(r, "x s3cr3"));
+
+        o.ignore_case = false;
+        Redactor exact{o};
+        CPPUNIT_ASSERT_EQUAL(std::string("PASSWORD=abc S3CR3T"), redact(exact, "PASSWORD=abc S3CR3T"));
+
+        o.patterns = {"ok", "*"};
+        CPPUNIT_ASSERT_THROW(Redactor{o}, std::invalid_argument);
+    }
+
+    void testCardNumbers() {
+        RedactorOptions o;
+        o.card_numbers = true;
+        Redactor r{o};
+
+        CPPUNIT_ASSERT_EQUAL(std::string("card ************1111 ok"), redact(r, "card 4111111111111111 ok"));
+        CPPUNIT_ASSERT_EQUAL(std::string("card ****-****-****-1111."), redact(r, "card 4111-1111-1111-1111."));
+        CPPUNIT_ASSERT_EQUAL(std::string("amex ***********0005"), redact(r, "amex 378282246310005"));
+        // failing the Luhn check, too short, or not a number on its own
+        CPPUNIT_ASSERT_EQUAL(std::string("id 4111111111111112"), redact(r, "id 4111111111111112"));
+        CPPUNIT_ASSERT_EQUAL(std::string("n 411111111111"), redact(r, "n 411111111111"));
+        CPPUNIT_ASSERT_EQUAL(std::string("x4111111111111111"), redact(r, "x4111111111111111"));
+        CPPUNIT_ASSERT_EQUAL(std::string("1 2 3 4 5 6 7 8 9 1 2 3 4 5 6 7"), redact(r, "1 2 3 4 5 6 7 8 9 1 2 3 4 5 6 7"));
+    }
+
+    void testTargets() {
+        auto raw = std::make_shared<RecordTarget>();
+        auto masked = std::make_shared<RecordTarget>();
+        auto other = std::make_shared<RecordTarget>();
+        RedactorOptions o;
+        o.patterns = {"token=*"};
+        masked->SetRedactor(std::make_shared<Redactor>(o));
+        other->SetRedactor(masked->GetRedactor());
+        // the redacted targets come first, the logger orders them
+        logger_t l{"test", LogLevel::Trace, {masked, raw, other}};
+
+        l.Info("login token=%s", "abcd");
+        {
+            auto batch = l.Batch();
+            batch.Info("batch token=%d", 42);
+        }
+        std::string body = "body token=xyz";
+        l.LogPayload(LogLevel::Info, Payload(body), "payload");
+
+        CPPUNIT_ASSERT_EQUAL(std::string("[I] login token=abcd\n[I] batch token=42\n[I] payload\nbody token=xyz\n"), raw->Joined());
+        CPPUNIT_ASSERT_EQUAL(std::string("[I] login token=****\n[I] batch token=**\n[I] payload\nbody token=***\n"), masked->Joined());
+        CPPUNIT_ASSERT_EQUAL(masked->Joined(), other->Joined());
+        CPPUNIT_ASSERT_EQUAL(std::string("body token=xyz"), body);
+    }
+
+    void testOwnMasks() {
+        auto secrets = std::make_shared<RecordTarget>();
+        auto cards = std::make_shared<RecordTarget>();
+        RedactorOptions o;
+        o.patterns = {"password=*"};
+        secrets->SetRedactor(std::make_shared<Redactor>(o));
+        o.patterns.clear();
+        o.card_numbers = true;
+        cards->SetRedactor(std::make_shared<Redactor>(o));
+        logger_t l{"test", LogLevel::Trace, {secrets, cards}};
+
+        // each target gets the masks of its own redactor only
+        l.Info("password=%s card=%s", "hunter2", "4111111111111111");
+        {
+            auto batch = l.Batch();
+            batch.Info("password=%s card=%s", "hunter2", "4111111111111111");
+        }
+        std::string body = "password=hunter2 card=4111111111111111";
+        l.LogPayload(LogLevel::Info, Payload(body), "password=%s", "hunter2");
+
+        CPPUNIT_ASSERT_EQUAL(std::string(
+            "[I] password=******* card=4111111111111111\n"
+            "[I] password=******* card=4111111111111111\n"
+            "[I] password=*******\n"
+            "password=******* card=4111111111111111\n"), secrets->Joined());
+        CPPUNIT_ASSERT_EQUAL(std::string(
+            "[I] password=hunter2 card=************1111\n"
+            "[I] password=hunter2 card=************1111\n"
+            "[I] password=hunter2\n"
+            "password=hunter2 card=************1111\n"), cards->Joined());
+    }
+
+private:
+    static std::string redact(const Redactor& r, std::string s) {
+        r.Redact(&s[0], s.size());
+        return s;
+    }
+}; // class RedactorTest
+
+#endif // __SLOG_REDACTOR_TEST_H_
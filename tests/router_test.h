@@ -0,0 +1,178 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_ROUTER_TEST_H_
+#define __SLOG_ROUTER_TEST_H_
+
+#include <string>
+#include <vector>
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <slog/logger.h>
+#include <slog/router.h>
+#include "test_utils.h"
+
+using namespace slog;
+
+/**
+ * RouterTest
+ *
+ * Group of tests to validate the routing tables
+ * of the loggers and the Router routes
+*/
+class RouterTest: public CppUnit::TestCase
+{
+    CPPUNIT_TEST_SUITE(RouterTest);
+    CPPUNIT_TEST(testLevels);
+    CPPUNIT_TEST(testPrefixRoutes);
+    CPPUNIT_TEST(testRebuilds);
+    CPPUNIT_TEST(testBatchRoutes);
+    CPPUNIT_TEST_SUITE_END();
+
+    using logger_t = BasicLogger<Pattern<pattern::Level, pattern::Message>>;
+
+public:
+    RouterTest() = default;
+    ~RouterTest() = default;
+    void setUp() {
+        Router::Instance().Clear();
+    }
+    void tearDown() {
+        Router::Instance().Clear();
+    }
+
+protected:
+    void testLevels() {
+        auto info = std::make_shared<RecordTarget>(LogLevel::Info);
+        auto debug = std::make_shared<RecordTarget>(LogLevel::Debug);
+        logger_t l{"test", LogLevel::Debug, {info, debug}};
+
+        l.Debug("one");
+        l.Info("two");
+        CPPUNIT_ASSERT_EQUAL(std::string("[I] two"), join(info->records));
+        CPPUNIT_ASSERT_EQUAL(std::string("[D] one|[I] two"), join(debug->records));
+
+        // the table follows the level changes
+        info->SetLogLevel(LogLevel::Trace);
+        l.SetLevel(LogLevel::Trace);
+        l.Trace("three");
+        CPPUNIT_ASSERT_EQUAL(std::string("[T] three"), info->records.back());
+        CPPUNIT_ASSERT_EQUAL(std::string("[I] two"), debug->records.back());
+
+        auto other = std::make_shared<RecordTarget>(LogLevel::Error);
+        l.AddTarget(other);
+        l.Error("four");
+        l.RemoveTarget(info);
+        l.Error("five");
+        CPPUNIT_ASSERT_EQUAL(std::string("[E] four"), info->records.back());
+        CPPUNIT_ASSERT_EQUAL(std::string("[E] four|[E] five"), join(other->records));
+
+        // targets accepting no level of the logger are still flushed
+        l.SetLevel(LogLevel::Critical);
+        l.Flush();
+        CPPUNIT_ASSERT_EQUAL(1, debug->flushes);
+    }
+
+    void testPrefixRoutes() {
+        auto own = std::make_shared<RecordTarget>(LogLevel::Trace);
+        auto net = std::make_shared<RecordTarget>(LogLevel::Trace);
+        logger_t http{"net.http", LogLevel::Trace, own};
+        logger_t db{"db", LogLevel::Trace, own};
+
+        Router::Instance().Add(Route{"net.", LogLevel::Debug, net});
+        Router::Instance().Add(Route{"", LogLevel::Error, net});
+        http.Trace("http trace");
+        http.Debug("http debug");
+        db.Debug("db debug");
+        db.Error("db error");
+        CPPUNIT_ASSERT_EQUAL(std::string("[D] http debug|[E] db error"), join(net->records));
+        CPPUNIT_ASSERT_EQUAL(size_t(4), own->records.size());
+
+        // a target is written once, even if it is routed more than once
+        Router::Instance().Add(Route{"db", LogLevel::Trace, own});
+        db.Info("db info");
+        CPPUNIT_ASSERT_EQUAL(size_t(5), own->records.size());
+
+        Router::Instance().Remove(net);
+        http.Error("http error");
+        CPPUNIT_ASSERT_EQUAL(std::string("[E] db error"), net->records.back());
+    }
+
+    void testRebuilds() {
+        auto target = std::make_shared<RecordTarget>(LogLevel::Trace);
+        logger_t l{"test", LogLevel::Info, target};
+        l.Info("one");
+        long refs = target.use_count();
+
+        // the replaced tables are freed, with their target references
+        for (int i = 0; i < 100; i++) {
+            l.SetLevel(i % 2 ? LogLevel::Info : LogLevel::Debug);
+            l.Info("record");
+        }
+        CPPUNIT_ASSERT_EQUAL(refs, target.use_count());
+        CPPUNIT_ASSERT_EQUAL(size_t(101), target->records.size());
+
+        // out of range levels are not logged
+        CPPUNIT_ASSERT(!l.Enabled(LogLevel::Max));
+        CPPUNIT_ASSERT(!l.Enabled(static_cast<LogLevel::level_t>(-1)));
+        l.Stream(LogLevel::Max) << "invalid";
+        CPPUNIT_ASSERT_EQUAL(size_t(101), target->records.size());
+    }
+
+    void testBatchRoutes() {
+        auto own = std::make_shared<RecordTarget>(LogLevel::Trace);
+        auto net = std::make_shared<RecordTarget>(LogLevel::Trace);
+        logger_t http{"net.http", LogLevel::Trace, own};
+        Router::Instance().Add(Route{"net.", LogLevel::Warning, net});
+
+        // the batched records are capped by the route level too
+        {
+            auto batch = http.Batch();
+            batch.Debug("debug");
+            batch.Warning("warning");
+            batch.Error("error");
+        }
+        CPPUNIT_ASSERT_EQUAL(std::string("[W] warning|[E] error"), join(net->records));
+        CPPUNIT_ASSERT_EQUAL(size_t(3), own->records.size());
+        {
+            auto batch = http.Batch();
+            batch.Debug("debug only");
+        }
+        CPPUNIT_ASSERT_EQUAL(size_t(2), net->records.size());
+        CPPUNIT_ASSERT_EQUAL(size_t(4), own->records.size());
+
+        // and so are the spans, which count as Info records
+        {
+            SLOG_SPAN(http, "span");
+        }
+        http.Flush();
+        CPPUNIT_ASSERT_EQUAL(size_t(0), net->spans);
+        CPPUNIT_ASSERT_EQUAL(size_t(1), own->spans);
+        Router::Instance().Add(Route{"net.http", LogLevel::Info, net});
+        {
+            SLOG_SPAN(http, "span");
+        }
+        http.Flush();
+        CPPUNIT_ASSERT_EQUAL(size_t(1), net->spans);
+        CPPUNIT_ASSERT_EQUAL(size_t(2), own->spans);
+    }
+
+private:
+    // join joins the records with '|'
+    static std::string join(const std::vector<std::string>& records) {
+        std::string s;
+        for (auto &r : records) {
+            if (!s.empty()) s += '|';
+            s += r;
+        }
+        return s;
+    }
+}; // class RouterTest
+
+#endif // __SLOG_ROUTER_TEST_H_
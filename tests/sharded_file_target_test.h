@@ -0,0 +1,109 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_SHARDED_FILE_TARGET_TEST_H_
+#define __SLOG_SHARDED_FILE_TARGET_TEST_H_
+
+#include <vector>
+#include <thread>
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <slog/sharded_file_target.h>
+#include "test_utils.h"
+
+using namespace slog;
+
+/**
+ * ShardedFileTargetTest
+ *
+ * Group of tests to validate slog::ShardedFileTarget interface
+*/
+class ShardedFileTargetTest: public CppUnit::TestCase
+{
+    CPPUNIT_TEST_SUITE(ShardedFileTargetTest);
+    CPPUNIT_TEST(testShardPrefix);
+    CPPUNIT_TEST(testShardPerThread);
+    CPPUNIT_TEST(testShardCache);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    ShardedFileTargetTest() = default;
+    ~ShardedFileTargetTest() = default;
+    void setUp() {
+        cleanupTestdata();
+    }
+    void tearDown() {
+        cleanupTestdata();
+    }
+
+protected:
+    void testShardPrefix() {
+        char buf[sharding::prefix_size];
+        uint64_t ns = 1698928699123456789ull, parsed = 0;
+        sharding::render_prefix(buf, ns);
+        CPPUNIT_ASSERT_EQUAL(std::string(buf, sizeof(buf)), std::string("1698928699123456789 "));
+        CPPUNIT_ASSERT(sharding::parse_prefix(buf, sizeof(buf), parsed));
+        CPPUNIT_ASSERT_EQUAL(parsed, ns);
+        CPPUNIT_ASSERT_MESSAGE("continuation line", !sharding::parse_prefix("  at foo()", 10, parsed));
+    }
+
+    void testShardPerThread() {
+        ShardedFileTarget t{test_file_, LogLevel::Info};
+        const int threads = 4, msgs = 50;
+        auto log_messages = [&t]() {
+            for (int i = 0; i < msgs; i++) {
+                std::string msg = "message " + std::to_string(i);
+                t.Write(LogLevel::Info, msg.data(), msg.size());
+            }
+            // filtered by the target level
+            t.Write(LogLevel::Debug, "debug", 5);
+        };
+
+        std::vector<std::thread> workers;
+        for (int i = 0; i < threads; i++) {
+            workers.emplace_back(log_messages);
+        }
+        for (auto &w : workers) {
+            w.join();
+        }
+        t.Flush();
+
+        auto shards = t.Shards();
+        CPPUNIT_ASSERT_EQUAL(shards.size(), static_cast<size_t>(threads));
+        for (auto &shard : shards) {
+            CPPUNIT_ASSERT(hasSuffix(utils::dirname(shard), TEST_DIR));
+            std::ifstream fs(shard, std::ifstream::in);
+            int lines = 0;
+            uint64_t prev = 0;
+            for (std::string line; std::getline(fs, line); lines++) {
+                uint64_t ts = 0;
+                CPPUNIT_ASSERT(sharding::parse_prefix(line.data(), line.size(), ts));
+                CPPUNIT_ASSERT_MESSAGE("timestamps are ordered within a shard", ts >= prev);
+                CPPUNIT_ASSERT(hasSuffix(line, "message " + std::to_string(lines)));
+                prev = ts;
+            }
+            CPPUNIT_ASSERT_EQUAL(lines, msgs);
+        }
+    }
+
+    void testShardCache() {
+        size_t cached = ShardedFileTarget::CachedShards();
+        for (int i = 0; i < 10; i++) {
+            ShardedFileTarget t{test_file_, LogLevel::Info};
+            t.Write(LogLevel::Info, "message", 7);
+        }
+        // the entries of the destroyed targets are not kept
+        CPPUNIT_ASSERT(ShardedFileTarget::CachedShards() <= cached + 1);
+    }
+
+private:
+    std::string test_file_{TEST_FILE("test-logs.txt")}; // file name used for testing
+}; // class ShardedFileTargetTest
+
+#endif // __SLOG_SHARDED_FILE_TARGET_TEST_H_
@@ -0,0 +1,257 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_SHM_QUEUE_TEST_H_
+#define __SLOG_SHM_QUEUE_TEST_H_
+
+#include <sys/wait.h>
+#include <signal.h>
+#include <unistd.h>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <string>
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <slog/shm_queue.h>
+#include <slog/shm_target.h>
+#include <slog/file_target.h>
+#include "test_utils.h"
+
+using namespace slog;
+
+/**
+ * ShmQueueTest
+ *
+ * Group of tests to validate slog::ShmQueue, slog::ShmTarget
+ * and slog::ShmCollector interfaces
+*/
+class ShmQueueTest: public CppUnit::TestCase
+{
+    CPPUNIT_TEST_SUITE(ShmQueueTest);
+    CPPUNIT_TEST(testShmQueuePushDrain);
+    CPPUNIT_TEST(testShmQueueFull);
+    CPPUNIT_TEST(testShmQueueDeadProducer);
+    CPPUNIT_TEST(testShmQueueStalledProducer);
+    CPPUNIT_TEST(testShmQueueStalledDeadProducer);
+    CPPUNIT_TEST(testShmQueueMultiProcess);
+    CPPUNIT_TEST(testShmCollector);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    ShmQueueTest() = default;
+    ~ShmQueueTest() = default;
+    void setUp() {
+        cleanupTestdata();
+        ShmQueue::Unlink(queue_name_);
+    }
+    void tearDown() {
+        ShmQueue::Unlink(queue_name_);
+        cleanupTestdata();
+    }
+
+protected:
+    void testShmQueuePushDrain() {
+        ShmQueue q{queue_name_, 8, 64};
+        CPPUNIT_ASSERT_EQUAL(q.Capacity(), static_cast<uint32_t>(8));
+        CPPUNIT_ASSERT_EQUAL(q.SlotSize(), static_cast<uint32_t>(64));
+
+        CPPUNIT_ASSERT(q.Push(LogLevel::Info, "first", 5));
+        CPPUNIT_ASSERT(q.Push(LogLevel::Error, "second", 6));
+
+        // a second handle on the same queue shares its geometry and records
+        ShmQueue other{queue_name_};
+        CPPUNIT_ASSERT_EQUAL(other.Capacity(), static_cast<uint32_t>(8));
+
+        std::vector<std::string> msgs;
+        std::vector<LogLevel::level_t> levels;
+        other.Drain([&](LogLevel::level_t l, const char *msg, size_t len) {
+            levels.push_back(l);
+            msgs.emplace_back(msg, len);
+        });
+        CPPUNIT_ASSERT_EQUAL(msgs.size(), static_cast<size_t>(2));
+        CPPUNIT_ASSERT_EQUAL(msgs[0], std::string("first"));
+        CPPUNIT_ASSERT_EQUAL(msgs[1], std::string("second"));
+        CPPUNIT_ASSERT(levels[0] == LogLevel::Info);
+        CPPUNIT_ASSERT(levels[1] == LogLevel::Error);
+
+        // records longer than a slot are truncated
+        std::string long_msg(100, 'x');
+        CPPUNIT_ASSERT(q.Push(LogLevel::Info, long_msg.data(), long_msg.size()));
+        size_t len = 0;
+        q.Drain([&](LogLevel::level_t, const char *, size_t l) { len = l; });
+        CPPUNIT_ASSERT_EQUAL(len, static_cast<size_t>(64));
+    }
+
+    void testShmQueueFull() {
+        ShmQueue q{queue_name_, 4, 32};
+        for (int i = 0; i < 4; i++) {
+            CPPUNIT_ASSERT(q.Push(LogLevel::Info, "msg", 3));
+        }
+        CPPUNIT_ASSERT_MESSAGE("push to a full queue should fail", !q.Push(LogLevel::Info, "msg", 3));
+        CPPUNIT_ASSERT_EQUAL(q.Dropped(), static_cast<uint64_t>(1));
+
+        size_t n = q.Drain([](LogLevel::level_t, const char *, size_t) {});
+        CPPUNIT_ASSERT_EQUAL(n, static_cast<size_t>(4));
+        // slots are reusable after draining
+        CPPUNIT_ASSERT(q.Push(LogLevel::Info, "msg", 3));
+    }
+
+    void testShmQueueDeadProducer() {
+        ShmQueue q{queue_name_, 8, 32};
+        CPPUNIT_ASSERT(q.Push(LogLevel::Info, "before", 6));
+
+        // a producer that dies after claiming a slot
+        pid_t pid = fork();
+        if (pid == 0) {
+            ShmQueue child{queue_name_};
+            uint64_t ticket;
+            child.Claim(ticket);
+            _exit(0);
+        }
+        waitpid(pid, nullptr, 0);
+        CPPUNIT_ASSERT(q.Push(LogLevel::Info, "after", 5));
+
+        std::vector<std::string> msgs;
+        q.Drain([&](LogLevel::level_t, const char *msg, size_t len) {
+            msgs.emplace_back(msg, len);
+        });
+        CPPUNIT_ASSERT_EQUAL(msgs.size(), static_cast<size_t>(2));
+        CPPUNIT_ASSERT_EQUAL(msgs[1], std::string("after"));
+        CPPUNIT_ASSERT_EQUAL(q.Abandoned(), static_cast<uint64_t>(1));
+    }
+
+    void testShmQueueStalledProducer() {
+        ShmQueue q{queue_name_, 4, 32};
+        q.SetStaleTimeout(std::chrono::milliseconds(1));
+        std::vector<std::string> msgs;
+        auto collect = [&](LogLevel::level_t, const char *msg, size_t len) {
+            msgs.emplace_back(msg, len);
+        };
+
+        // a producer of this process stalls after claiming a slot
+        uint64_t ticket;
+        char *stale = q.Claim(ticket);
+        CPPUNIT_ASSERT(stale != nullptr);
+        CPPUNIT_ASSERT(q.Push(LogLevel::Info, "next", 4));
+        CPPUNIT_ASSERT_EQUAL(size_t(0), q.Drain(collect));
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        CPPUNIT_ASSERT_EQUAL(size_t(1), q.Drain(collect));
+        CPPUNIT_ASSERT_EQUAL(uint64_t(1), q.Abandoned());
+
+        // the skipped slot is held, not handed over to the next lap
+        CPPUNIT_ASSERT(q.Push(LogLevel::Info, "two", 3));
+        CPPUNIT_ASSERT(q.Push(LogLevel::Info, "three", 5));
+        CPPUNIT_ASSERT(!q.Push(LogLevel::Info, "four", 4));
+        CPPUNIT_ASSERT_EQUAL(size_t(2), q.Drain(collect));
+
+        // its late write and commit do not touch another record
+        memcpy(stale, "stale", 5);
+        CPPUNIT_ASSERT(!q.Commit(ticket, LogLevel::Error, 5));
+        CPPUNIT_ASSERT(q.Push(LogLevel::Info, "after", 5));
+        CPPUNIT_ASSERT_EQUAL(size_t(1), q.Drain(collect));
+        CPPUNIT_ASSERT_EQUAL(size_t(4), msgs.size());
+        CPPUNIT_ASSERT_EQUAL(std::string("next"), msgs[0]);
+        CPPUNIT_ASSERT_EQUAL(std::string("three"), msgs[2]);
+        CPPUNIT_ASSERT_EQUAL(std::string("after"), msgs[3]);
+    }
+
+    void testShmQueueStalledDeadProducer() {
+        ShmQueue q{queue_name_, 4, 32};
+        q.SetStaleTimeout(std::chrono::milliseconds(1));
+        size_t drained = 0;
+        auto count = [&](LogLevel::level_t, const char *, size_t) {
+            drained++;
+        };
+
+        // a producer that stalls after claiming a slot, and is killed
+        // once the collector skipped it
+        int ready[2];
+        CPPUNIT_ASSERT_EQUAL(0, pipe(ready));
+        pid_t pid = fork();
+        if (pid == 0) {
+            ShmQueue child{queue_name_};
+            uint64_t ticket;
+            child.Claim(ticket);
+            if (::write(ready[1], "x", 1) != 1) _exit(1);
+            pause();
+            _exit(0);
+        }
+        char c;
+        CPPUNIT_ASSERT_EQUAL(ssize_t(1), ::read(ready[0], &c, 1));
+        close(ready[0]);
+        close(ready[1]);
+        q.Drain(count);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        q.Drain(count);
+        CPPUNIT_ASSERT_EQUAL(uint64_t(1), q.Abandoned());
+        kill(pid, SIGKILL);
+        waitpid(pid, nullptr, 0);
+
+        // the held slot is freed, the queue keeps going lap after lap
+        for (int i = 0; i < 20; i++) {
+            q.Drain(count);
+            CPPUNIT_ASSERT_MESSAGE(std::to_string(i), q.Push(LogLevel::Info, "lap", 3));
+        }
+        q.Drain(count);
+        CPPUNIT_ASSERT_EQUAL(size_t(20), drained);
+        CPPUNIT_ASSERT_EQUAL(uint64_t(0), q.Dropped());
+    }
+
+    void testShmQueueMultiProcess() {
+        ShmQueue q{queue_name_, 1024, 64};
+        const int procs = 4, msgs = 200;
+        std::vector<pid_t> children;
+        for (int p = 0; p < procs; p++) {
+            pid_t pid = fork();
+            if (pid == 0) {
+                ShmQueue child{queue_name_};
+                for (int i = 0; i < msgs; i++) {
+                    std::string msg = "message " + std::to_string(i);
+                    child.Push(LogLevel::Info, msg.data(), msg.size());
+                }
+                _exit(0);
+            }
+            children.push_back(pid);
+        }
+        for (auto pid : children) {
+            waitpid(pid, nullptr, 0);
+        }
+        size_t n = q.Drain([](LogLevel::level_t, const char *, size_t) {});
+        CPPUNIT_ASSERT_EQUAL(n, static_cast<size_t>(procs * msgs));
+    }
+
+    void testShmCollector() {
+        auto q = std::make_shared<ShmQueue>(queue_name_, 64, 128);
+        auto file = std::make_shared<FileTarget<std::mutex> >(test_file_, LogLevel::Info);
+        ShmTarget t{q, LogLevel::Trace};
+
+        t.Write(LogLevel::Info, "info message", 12);
+        t.Write(LogLevel::Debug, "debug message", 13);
+        t.Log(LogLevel::Error, "error %d", 42);
+        {
+            ShmCollector collector{q, {file}};
+            collector.Start();
+        } // stopping the collector drains the queue
+
+        std::ifstream fs(test_file_, std::ifstream::in);
+        std::string line;
+        std::getline(fs, line);
+        CPPUNIT_ASSERT_EQUAL(line, std::string("info message"));
+        // debug message is filtered by the file target
+        std::getline(fs, line);
+        CPPUNIT_ASSERT_EQUAL(line, std::string("error 42"));
+    }
+
+private:
+    std::string queue_name_{"/slog-test-" + std::to_string(::getpid())};
+    std::string test_file_{TEST_FILE("test-logs.txt")}; // file name used for testing
+}; // class ShmQueueTest
+
+#endif // __SLOG_SHM_QUEUE_TEST_H_
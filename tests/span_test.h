@@ -0,0 +1,123 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_SPAN_TEST_H_
+#define __SLOG_SPAN_TEST_H_
+
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <slog/logger.h>
+#include <slog/span.h>
+#include <slog/trace_target.h>
+#include "test_utils.h"
+
+using namespace slog;
+
+/**
+ * SpanTest
+ *
+ * Group of tests to validate the tracing spans
+ * and the Chrome trace target
+*/
+class SpanTest: public CppUnit::TestCase
+{
+    CPPUNIT_TEST_SUITE(SpanTest);
+    CPPUNIT_TEST(testChromeTrace);
+    CPPUNIT_TEST(testThreshold);
+    CPPUNIT_TEST(testBufferRelease);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    SpanTest() = default;
+    ~SpanTest() = default;
+    void setUp() {
+        cleanupTestdata();
+    }
+    void tearDown() {
+        cleanupTestdata();
+    }
+
+protected:
+    void testChromeTrace() {
+        const int spans = SpanCollector::BufferSize * 2 + 10;
+        {
+            auto trace = std::make_shared<ChromeTraceTarget>(trace_file_, LogLevel::Info);
+            Logger l{"test", LogLevel::Info, trace};
+            auto work = [&l, spans]() {
+                for (int i = 0; i < spans; i++) {
+                    SLOG_SPAN(l, "work \"item\"");
+                }
+            };
+            std::thread other(work);
+            work();
+            other.join();
+            l.Info("done");
+            l.Flush();
+        }
+
+        std::ifstream fs(trace_file_);
+        std::stringstream ss;
+        ss << fs.rdbuf();
+        std::string json = ss.str();
+        CPPUNIT_ASSERT(json.compare(0, 2, "[\n") == 0);
+        CPPUNIT_ASSERT(hasSuffix(json, "\n]\n"));
+        CPPUNIT_ASSERT_EQUAL(size_t(2 * spans), count(json, "\"ph\":\"X\""));
+        CPPUNIT_ASSERT_EQUAL(size_t(2 * spans), count(json, "\"name\":\"work \\\"item\\\"\""));
+        CPPUNIT_ASSERT_EQUAL(size_t(1), count(json, "\"ph\":\"i\""));
+        CPPUNIT_ASSERT(json.find("] [I] done\"") != std::string::npos);
+    }
+
+    void testThreshold() {
+        auto file = std::make_shared<FileTarget<std::mutex> >(log_file_, LogLevel::Trace);
+        BasicLogger<Pattern<pattern::Level, pattern::Message>> l{"test", LogLevel::Info, file};
+        l.SetSpanThreshold(std::chrono::milliseconds(5));
+        {
+            SLOG_SPAN(l, "fast");
+        }
+        {
+            SLOG_SPAN(l, "slow");
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        l.Flush();
+
+        std::ifstream fs(log_file_);
+        std::string line;
+        CPPUNIT_ASSERT(std::getline(fs, line));
+        CPPUNIT_ASSERT_MESSAGE(line, line.compare(0, 19, "[W] span slow took ") == 0);
+        CPPUNIT_ASSERT(!std::getline(fs, line));
+    }
+
+    void testBufferRelease() {
+        size_t cached = SpanCollector::CachedBuffers();
+        for (int i = 0; i < 10; i++) {
+            SpanCollector c{nullptr};
+            c.Add("span", 0, 1);
+        }
+        // the buffer of the last collector is released on the next one
+        CPPUNIT_ASSERT(SpanCollector::CachedBuffers() <= cached + 1);
+        SpanCollector c{nullptr};
+        c.Add("span", 0, 1);
+        CPPUNIT_ASSERT(SpanCollector::CachedBuffers() <= cached + 1);
+    }
+
+private:
+    static size_t count(const std::string& s, const std::string& what) {
+        size_t n = 0;
+        for (size_t pos = s.find(what); pos != std::string::npos; pos = s.find(what, pos + 1)) n++;
+        return n;
+    }
+
+    std::string trace_file_{TEST_FILE("trace.json")};
+    std::string log_file_{TEST_FILE("test-logs.txt")};
+}; // class SpanTest
+
+#endif // __SLOG_SPAN_TEST_H_
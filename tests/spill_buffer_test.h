@@ -0,0 +1,178 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_SPILL_BUFFER_TEST_H_
+#define __SLOG_SPILL_BUFFER_TEST_H_
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <slog/file_target.h>
+#include <slog/spill_buffer.h>
+#include "test_utils.h"
+
+using namespace slog;
+
+/**
+ * SpillBufferTest
+ *
+ * Group of tests to validate spilling the records of
+ * the file targets that could not be written
+*/
+class SpillBufferTest: public CppUnit::TestCase
+{
+    CPPUNIT_TEST_SUITE(SpillBufferTest);
+    CPPUNIT_TEST(testDiskFull);
+    CPPUNIT_TEST(testStall);
+    CPPUNIT_TEST(testCompressedFlush);
+    CPPUNIT_TEST_SUITE_END();
+
+    // SickFileTarget could swap its file for one that fails all the writes
+    class SickFileTarget: public FileTarget<std::mutex> {
+    public:
+        using FileTarget<std::mutex>::FileTarget;
+        ~SickFileTarget() {
+            Heal();
+        }
+        void Break() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ::fflush(fp_);
+            healthy_ = fp_;
+            fp_ = fopen("/dev/full", "w");
+            setvbuf(fp_, nullptr, _IONBF, 0);
+        }
+        void Heal() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!healthy_) return;
+            fclose(fp_);
+            fp_ = healthy_;
+            healthy_ = nullptr;
+        }
+        std::mutex& Lock() {
+            return mutex_;
+        }
+    private:
+        FILE *healthy_{nullptr};
+    };
+
+public:
+    SpillBufferTest() = default;
+    ~SpillBufferTest() = default;
+    void setUp() {
+        cleanupTestdata();
+    }
+    void tearDown() {
+        cleanupTestdata();
+    }
+
+protected:
+    void testDiskFull() {
+        FileOptions options;
+        options.spill = 16;
+        options.spill_retry = std::chrono::milliseconds(1);
+        SickFileTarget file{log_file_, LogLevel::Trace, options};
+        file.Write(LogLevel::Info, "one", 3);
+
+        file.Break();
+        CPPUNIT_ASSERT(file.Write(LogLevel::Info, "two", 3));
+        CPPUNIT_ASSERT(file.Spill()->Active());
+        CPPUNIT_ASSERT(file.Write(LogLevel::Info, "three", 5));
+        // does not fit into the spill buffer
+        CPPUNIT_ASSERT(!file.Write(LogLevel::Info, "four: too long", 14));
+        CPPUNIT_ASSERT_EQUAL(uint64_t(2), file.Spill()->Spilled());
+        CPPUNIT_ASSERT_EQUAL(uint64_t(1), file.Spill()->Dropped());
+        CPPUNIT_ASSERT_EQUAL(uint64_t(14), file.Spill()->DroppedBytes());
+        CPPUNIT_ASSERT_EQUAL(size_t(8), file.Spill()->Bytes());
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        CPPUNIT_ASSERT(file.Spill()->Retries() > 0);
+        CPPUNIT_ASSERT(file.Spill()->Active());
+
+        // replayed in order once the file could be written
+        file.Heal();
+        CPPUNIT_ASSERT(wait_replayed(file));
+        file.Write(LogLevel::Info, "five", 4);
+        file.Flush();
+        CPPUNIT_ASSERT_EQUAL(uint64_t(2), file.Spill()->Replayed());
+        CPPUNIT_ASSERT_EQUAL(std::string("one\ntwo\nthree\nfive\n"), read_file());
+    }
+
+    void testStall() {
+        FileOptions options;
+        options.spill = 1024;
+        options.spill_timeout = std::chrono::milliseconds(5);
+        options.spill_retry = std::chrono::milliseconds(1);
+        SickFileTarget file{log_file_, LogLevel::Trace, options};
+        file.Write(LogLevel::Info, "one", 3);
+
+        // a write holding the file for longer than the timeout
+        std::mutex ready, done;
+        ready.lock();
+        done.lock();
+        std::thread holder([&]() {
+            std::lock_guard<std::mutex> lock(file.Lock());
+            ready.unlock();
+            done.lock();
+            done.unlock();
+        });
+        ready.lock();
+        auto start = std::chrono::steady_clock::now();
+        CPPUNIT_ASSERT(file.Write(LogLevel::Info, "two", 3));
+        CPPUNIT_ASSERT(file.Write(LogLevel::Info, "three", 5));
+        // nor do the flushes and the syncs of the flush policy
+        FlushPolicy policy;
+        policy.level = LogLevel::Error;
+        policy.sync = true;
+        file.SetFlushPolicy(policy);
+        CPPUNIT_ASSERT(file.Write(LogLevel::Error, "four", 4));
+        CPPUNIT_ASSERT(!file.Sync());
+        file.Flush();
+        CPPUNIT_ASSERT(std::chrono::steady_clock::now() - start < std::chrono::seconds(1));
+        CPPUNIT_ASSERT_EQUAL(uint64_t(3), file.Spill()->Spilled());
+        done.unlock();
+        holder.join();
+        ready.unlock();
+
+        CPPUNIT_ASSERT(wait_replayed(file));
+        file.Flush();
+        CPPUNIT_ASSERT_EQUAL(std::string("one\ntwo\nthree\nfour\n"), read_file());
+        CPPUNIT_ASSERT(file.Sync());
+    }
+
+    void testCompressedFlush() {
+        FileOptions options;
+        options.spill = 1024;
+        options.compress_block = 4096;
+        FileTarget<std::mutex> file{log_file_, LogLevel::Trace, options};
+        file.Write(LogLevel::Info, "one", 3);
+        file.Flush();
+        CPPUNIT_ASSERT(!read_file().empty());
+    }
+
+private:
+    bool wait_replayed(SickFileTarget& file) {
+        for (int i = 0; i < 2000 && file.Spill()->Active(); i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return !file.Spill()->Active();
+    }
+
+    std::string read_file() {
+        std::ifstream in(log_file_, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    std::string log_file_{TEST_FILE("spill.log")};
+}; // class SpillBufferTest
+
+#endif // __SLOG_SPILL_BUFFER_TEST_H_
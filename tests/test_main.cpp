@@ -15,10 +15,52 @@
 #include "log_level_test.h"
 #include "file_target_test.h"
 #include "logger_test.h"
+#include "shm_queue_test.h"
+#include "sharded_file_target_test.h"
+#include "file_index_test.h"
+#include "compression_test.h"
+#include "flush_policy_test.h"
+#include "pattern_test.h"
+#include "thread_context_test.h"
+#include "console_target_test.h"
+#include "config_test.h"
+#include "span_test.h"
+#include "payload_test.h"
+#include "router_test.h"
+#include "redactor_test.h"
+#include "frame_test.h"
+#include "log_stream_test.h"
+#include "memory_test.h"
+#include "log_reader_test.h"
+#include "governor_test.h"
+#include "spill_buffer_test.h"
+#include "escape_test.h"
+#include "probes_test.h"
 
 CPPUNIT_TEST_SUITE_REGISTRATION(LogLevelTest);
 CPPUNIT_TEST_SUITE_REGISTRATION(FileTargetTest);
 CPPUNIT_TEST_SUITE_REGISTRATION(LoggerTest);
+CPPUNIT_TEST_SUITE_REGISTRATION(ShmQueueTest);
+CPPUNIT_TEST_SUITE_REGISTRATION(ShardedFileTargetTest);
+CPPUNIT_TEST_SUITE_REGISTRATION(FileIndexTest);
+CPPUNIT_TEST_SUITE_REGISTRATION(CompressionTest);
+CPPUNIT_TEST_SUITE_REGISTRATION(FlushPolicyTest);
+CPPUNIT_TEST_SUITE_REGISTRATION(PatternTest);
+CPPUNIT_TEST_SUITE_REGISTRATION(ThreadContextTest);
+CPPUNIT_TEST_SUITE_REGISTRATION(ConsoleTargetTest);
+CPPUNIT_TEST_SUITE_REGISTRATION(ConfigTest);
+CPPUNIT_TEST_SUITE_REGISTRATION(SpanTest);
+CPPUNIT_TEST_SUITE_REGISTRATION(PayloadTest);
+CPPUNIT_TEST_SUITE_REGISTRATION(RouterTest);
+CPPUNIT_TEST_SUITE_REGISTRATION(RedactorTest);
+CPPUNIT_TEST_SUITE_REGISTRATION(FrameTest);
+CPPUNIT_TEST_SUITE_REGISTRATION(LogStreamTest);
+CPPUNIT_TEST_SUITE_REGISTRATION(MemoryTest);
+CPPUNIT_TEST_SUITE_REGISTRATION(LogReaderTest);
+CPPUNIT_TEST_SUITE_REGISTRATION(GovernorTest);
+CPPUNIT_TEST_SUITE_REGISTRATION(SpillBufferTest);
+CPPUNIT_TEST_SUITE_REGISTRATION(EscapeTest);
+CPPUNIT_TEST_SUITE_REGISTRATION(ProbesTest);
 
 int main() {
     CPPUNIT_NS::TestResult testresult;
@@ -9,9 +9,13 @@
 #ifndef __SLOG_TEST_UTILS_H_
 #define __SLOG_TEST_UTILS_H_
 
+#include <chrono>
 #include <string>
 #include <cstdlib>
+#include <thread>
+#include <vector>
 #include <slog/utils.h>
+#include <slog/target.h>
 #include <ostream>
 
 
@@ -26,4 +30,37 @@ auto hasSuffix = [](const std::string& msg, const std::string& suffix) -> bool {
            msg.compare(msg.length()-suffix.length(), suffix.length(), suffix) == 0;
 };
 
+// RecordTarget keeps the records written to it
+class RecordTarget: public slog::Target {
+public:
+    explicit RecordTarget(slog::LogLevel::level_t lvl = slog::LogLevel::Trace): Target(lvl) {}
+    std::vector<std::string> records;
+    int flushes{0};
+    size_t spans{0};
+    std::chrono::milliseconds delay{0}; // taken by every write
+
+    // Joined returns the records, each one ending with a newline
+    std::string Joined() const {
+        std::string s;
+        for (auto &r : records) {
+            s += r;
+            if (r.empty() || r[r.size()-1] != '\n') s += '\n';
+        }
+        return s;
+    }
+
+protected:
+    bool log(const std::string&, va_list) override { return false; }
+    bool write(slog::LogLevel::level_t, const char *msg, size_t len) override {
+        if (delay.count()) std::this_thread::sleep_for(delay);
+        records.emplace_back(msg, len);
+        return true;
+    }
+    bool write_spans(const slog::SpanEvent *, size_t n) override {
+        spans += n;
+        return true;
+    }
+    void flush() override { flushes++; }
+};
+
 #endif // __SLOG_TEST_UTILS_H_
\ No newline at end of file
@@ -0,0 +1,125 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#ifndef __SLOG_THREAD_CONTEXT_TEST_H_
+#define __SLOG_THREAD_CONTEXT_TEST_H_
+
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <thread>
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <slog/thread_context.h>
+#include <slog/pattern.h>
+#include <slog/runtime_pattern.h>
+#include "test_utils.h"
+
+using namespace slog;
+
+/**
+ * ThreadContextTest
+ *
+ * Group of tests to validate the per-thread context
+ * and the mapped diagnostic context
+*/
+class ThreadContextTest: public CppUnit::TestCase
+{
+    CPPUNIT_TEST_SUITE(ThreadContextTest);
+    CPPUNIT_TEST(testIds);
+    CPPUNIT_TEST(testFork);
+    CPPUNIT_TEST(testMdc);
+    CPPUNIT_TEST(testPatterns);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    ThreadContextTest() = default;
+    ~ThreadContextTest() = default;
+
+protected:
+    void testIds() {
+        auto &context = ThreadContext::Current();
+        CPPUNIT_ASSERT_EQUAL(::getpid(), context.Pid());
+        CPPUNIT_ASSERT_EQUAL(static_cast<pid_t>(::syscall(SYS_gettid)), context.Tid());
+        CPPUNIT_ASSERT(context.Number() > 0);
+
+        pid_t tid = 0;
+        uint32_t number = 0;
+        std::string name;
+        std::thread th([&]() {
+            ThreadContext::Current().SetName("worker");
+            tid = ThreadContext::Current().Tid();
+            number = ThreadContext::Current().Number();
+            name = ThreadContext::Current().Name();
+        });
+        th.join();
+        CPPUNIT_ASSERT(tid != context.Tid());
+        CPPUNIT_ASSERT(number != context.Number());
+        CPPUNIT_ASSERT_EQUAL(std::string("worker"), name);
+    }
+
+    void testFork() {
+        ThreadContext::Current();
+        pid_t child = fork();
+        if (child == 0) {
+            auto &context = ThreadContext::Current();
+            bool ok = context.Pid() == ::getpid() &&
+                      context.Tid() == static_cast<pid_t>(::syscall(SYS_gettid));
+            _exit(ok ? 0 : 1);
+        }
+        CPPUNIT_ASSERT(child > 0);
+        int status = 0;
+        waitpid(child, &status, 0);
+        CPPUNIT_ASSERT_MESSAGE("stale ids in the child process", WIFEXITED(status) && WEXITSTATUS(status) == 0);
+        CPPUNIT_ASSERT_EQUAL(::getpid(), ThreadContext::Current().Pid());
+    }
+
+    void testMdc() {
+        auto &context = ThreadContext::Current();
+        context.Clear();
+        CPPUNIT_ASSERT(context.Mdc().empty());
+        context.Put("request", "42");
+        context.Put("user", "bob");
+        CPPUNIT_ASSERT_EQUAL(std::string("request=42 user=bob"), context.Mdc());
+        {
+            MdcScope scope{"request", "43"};
+            MdcScope other{"session", "s1"};
+            CPPUNIT_ASSERT_EQUAL(std::string("request=43 user=bob session=s1"), context.Mdc());
+        }
+        CPPUNIT_ASSERT_EQUAL(std::string("request=42 user=bob"), context.Mdc());
+        std::string value;
+        CPPUNIT_ASSERT(context.Get("user", value));
+        CPPUNIT_ASSERT_EQUAL(std::string("bob"), value);
+        context.Remove("request");
+        CPPUNIT_ASSERT(!context.Get("request", value));
+        CPPUNIT_ASSERT_EQUAL(std::string("user=bob"), context.Mdc());
+        context.Clear();
+    }
+
+    void testPatterns() {
+        auto &context = ThreadContext::Current();
+        std::string name{"app"}, out;
+        pattern::Record r{LogLevel::Info, name, std::chrono::system_clock::now()};
+
+        // an empty context is left out with its separator
+        Pattern<pattern::Level, pattern::Mdc, pattern::Message> p;
+        CPPUNIT_ASSERT(p.Format(out, r, "hi"));
+        CPPUNIT_ASSERT_EQUAL(std::string("[I] hi"), out);
+
+        MdcScope scope{"request", "42"};
+        CPPUNIT_ASSERT(p.Format(out, r, "hi"));
+        CPPUNIT_ASSERT_EQUAL(std::string("[I] request=42 hi"), out);
+
+        RuntimePattern rp{"%L %i %K %v"};
+        CPPUNIT_ASSERT(rp.Format(out, r, "hi"));
+        CPPUNIT_ASSERT_EQUAL("I " + std::to_string(context.Number()) + " request=42 hi", out);
+    }
+}; // class ThreadContextTest
+
+#endif // __SLOG_THREAD_CONTEXT_TEST_H_
@@ -0,0 +1,79 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <slog/shm_queue.h>
+#include <slog/file_target.h>
+
+/**
+  * slog-collector drains a shared memory log queue, written by the
+  * processes using `slog::ShmTarget`, into a single log file.
+  *
+  * usage: slog-collector [-l level] [-s slots] [-b slot-size] <queue> <log-file>
+  */
+
+static volatile std::sig_atomic_t stop = 0;
+
+static void on_signal(int) {
+    stop = 1;
+}
+
+static int usage(const char *prog) {
+    std::cerr << "usage: " << prog << " [-l level] [-s slots] [-b slot-size] <queue> <log-file>\n";
+    return 2;
+}
+
+int main(int argc, char *argv[])
+{
+    slog::LogLevel level{slog::LogLevel::Trace};
+    uint32_t slots = slog::ShmQueue::DefaultSlots;
+    uint32_t slot_size = slog::ShmQueue::DefaultSlotSize;
+
+    int i = 1;
+    for (; i < argc && argv[i][0] == '-'; i += 2) {
+        std::string opt{argv[i]};
+        if (i + 1 >= argc) return usage(argv[0]);
+        if (opt == "-l") {
+            level = slog::LogLevel{std::string(argv[i+1])};
+        } else if (opt == "-s") {
+            slots = static_cast<uint32_t>(std::strtoul(argv[i+1], nullptr, 10));
+        } else if (opt == "-b") {
+            slot_size = static_cast<uint32_t>(std::strtoul(argv[i+1], nullptr, 10));
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    if (argc - i != 2) return usage(argv[0]);
+
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+
+    try {
+        auto queue = std::make_shared<slog::ShmQueue>(argv[i], slots, slot_size);
+        auto file = std::make_shared<slog::FileTarget<std::mutex> >(argv[i+1], level.Get());
+        slog::ShmCollector collector{queue, {file}};
+
+        collector.Start();
+        while (!stop) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        collector.Stop();
+
+        if (queue->Dropped() || queue->Abandoned()) {
+            std::cerr << "dropped: " << queue->Dropped()
+                      << ", abandoned: " << queue->Abandoned() << std::endl;
+        }
+    } catch(slog::FileException &exp) {
+        std::cerr << "Exception: " << exp.what() << ": " << exp.file() << std::endl;
+        return 1;
+    }
+    return 0;
+}
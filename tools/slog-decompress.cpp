@@ -0,0 +1,85 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <slog/compression.h>
+
+/**
+  * slog-decompress streams the records of a compressed log file,
+  * written by a `slog::FileTarget` with `FileOptions::compress_block`,
+  * to the standard output.
+  *
+  * usage: slog-decompress <log-file>
+  *
+  * Corrupt frames are skipped by resynchronizing on the next frame
+  * header, a torn frame at the end of the file is ignored.
+  */
+
+using namespace slog;
+
+int main(int argc, char *argv[])
+{
+    if (argc != 2) {
+        std::cerr << "usage: " << argv[0] << " <log-file>\n";
+        return 2;
+    }
+
+    int fd = ::open(argv[1], O_RDONLY);
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) != 0) {
+        std::cerr << "failed to open " << argv[1] << std::endl;
+        return 1;
+    }
+    size_t size = info.st_size;
+    if (size == 0) return 0;
+    void *map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        std::cerr << "failed to map " << argv[1] << std::endl;
+        return 1;
+    }
+    madvise(map, size, MADV_SEQUENTIAL);
+    const char *data = static_cast<const char *>(map);
+
+    int res = 0;
+    std::string out;
+    size_t pos = 0;
+    while (pos < size) {
+        size_t consumed = 0;
+        out.clear();
+        auto status = lz::DecodeFrame(data + pos, size - pos, out, consumed);
+        if (status == lz::frame_ok) {
+            fwrite(out.data(), 1, out.size(), stdout);
+            pos += consumed;
+            continue;
+        }
+        if (status == lz::frame_incomplete) {
+            std::cerr << "truncated frame at offset " << pos << std::endl;
+            res = 1;
+            break;
+        }
+        // resynchronize on the next frame magic
+        std::cerr << "corrupt frame at offset " << pos << std::endl;
+        res = 1;
+        const uint32_t magic = lz::frame_magic;
+        const char *next = static_cast<const char *>(
+            memmem(data + pos + 1, size - pos - 1, &magic, sizeof(magic)));
+        if (!next) break;
+        pos = next - data;
+    }
+
+    munmap(map, size);
+    return res;
+}
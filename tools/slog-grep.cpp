@@ -0,0 +1,266 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include <slog/file_index.h>
+#include <slog/record_format.h>
+
+/**
+  * slog-grep searches a log file written by `slog::FileTarget`.
+  *
+  * usage: slog-grep [-f from] [-t to] [-l level] [-j threads] [pattern] <log-file>
+  *
+  *   -f, -t  time range of the records, either as seconds since the epoch
+  *           or as local time "YYYY-mm-dd HH:MM:SS"
+  *   -l      show only records of the given level or more severe
+  *   -j      number of threads to scan with, defaults to the number of cores
+  *
+  * If the file has a sparse time index ("<log-file>.idx", see
+  * FileOptions::index_interval), only the part of the file that might
+  * hold the requested time range is read. The range is split into line
+  * aligned chunks which are scanned in parallel.
+  *
+  * Lines which are not in the record layout (like continuation lines of
+  * a multi-line message) are not shown when a time range or level is given.
+  */
+
+using namespace slog;
+
+namespace {
+
+struct options_t {
+    std::time_t from{0};
+    std::time_t to{0};
+    bool has_from{false};
+    bool has_to{false};
+    LogLevel::level_t level{LogLevel::Unknown};
+    std::string pattern;
+
+    bool need_fields() const {
+        return has_from || has_to || level != LogLevel::Unknown;
+    }
+};
+
+bool parse_time_arg(const char *arg, std::time_t& t) {
+    char *end;
+    long long v = strtoll(arg, &end, 10);
+    if (*end == '\0') {
+        t = static_cast<std::time_t>(v);
+        return true;
+    }
+    struct tm tm{};
+    const char *rest = strptime(arg, "%Y-%m-%d %H:%M:%S", &tm);
+    if (!rest || *rest) return false;
+    tm.tm_isdst = -1;
+    t = mktime(&tm);
+    return true;
+}
+
+// find returns the position of needle in the haystack, or n if not found.
+// It compares the first and the last needle byte on 16 positions at a
+// time and verifies the whole needle only on the candidate positions.
+size_t find(const char *hay, size_t n, const std::string& needle) {
+    const size_t m = needle.size();
+    if (m == 0) return 0;
+    if (m > n) return n;
+    if (m == 1) {
+        const void *p = memchr(hay, needle[0], n);
+        return p ? static_cast<const char *>(p) - hay : n;
+    }
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[m-1]);
+    for (; i + m - 1 + 16 <= n; i += 16) {
+        __m128i bf = _mm_loadu_si128(reinterpret_cast<const __m128i *>(hay + i));
+        __m128i bl = _mm_loadu_si128(reinterpret_cast<const __m128i *>(hay + i + m - 1));
+        unsigned mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, bf),
+                                                        _mm_cmpeq_epi8(last, bl)));
+        while (mask) {
+            unsigned bit = __builtin_ctz(mask);
+            if (memcmp(hay + i + bit + 1, needle.data() + 1, m - 2) == 0) {
+                return i + bit;
+            }
+            mask &= mask - 1;
+        }
+    }
+#endif
+    for (; i + m <= n; i++) {
+        if (hay[i] == needle[0] && memcmp(hay + i, needle.data(), m) == 0) {
+            return i;
+        }
+    }
+    return n;
+}
+
+class Scanner {
+public:
+    Scanner(const options_t& opts, const char *data, size_t begin, size_t end)
+        : opts_(opts), data_(data), begin_(begin), end_(end) {}
+
+    void Run() {
+        size_t pos = begin_;
+        while (pos < end_) {
+            if (!opts_.pattern.empty()) {
+                size_t hit = find(data_ + pos, end_ - pos, opts_.pattern);
+                if (hit == end_ - pos) break;
+                // back up to the beginning of the matching line
+                size_t start = pos + hit;
+                while (start > pos && data_[start-1] != '\n') start--;
+                pos = start;
+            }
+            const char *nl = static_cast<const char *>(memchr(data_ + pos, '\n', end_ - pos));
+            size_t line_end = nl ? nl - data_ : end_;
+            if (accept(data_ + pos, line_end - pos)) {
+                out_.append(data_ + pos, line_end - pos);
+                out_.push_back('\n');
+            }
+            pos = line_end + 1;
+        }
+    }
+
+    const std::string& Output() const {
+        return out_;
+    }
+
+private:
+    bool accept(const char *line, size_t len) {
+        if (!opts_.need_fields()) return true;
+        RecordFields f;
+        if (!parser_.Parse(line, len, f)) return false;
+        if (opts_.level != LogLevel::Unknown &&
+            (f.level == LogLevel::Unknown || f.level > opts_.level)) {
+            return false;
+        }
+        if (opts_.has_from && f.time < opts_.from) return false;
+        if (opts_.has_to && f.time > opts_.to) return false;
+        return true;
+    }
+
+    const options_t& opts_;
+    const char *data_;
+    size_t begin_, end_;
+    RecordParser parser_;
+    std::string out_;
+};
+
+int usage(const char *prog) {
+    std::cerr << "usage: " << prog
+              << " [-f from] [-t to] [-l level] [-j threads] [pattern] <log-file>\n";
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    options_t opts;
+    unsigned threads = std::thread::hardware_concurrency();
+
+    int i = 1;
+    for (; i + 1 < argc && argv[i][0] == '-'; i += 2) {
+        std::string opt{argv[i]};
+        if (opt == "-f") {
+            if (!parse_time_arg(argv[i+1], opts.from)) return usage(argv[0]);
+            opts.has_from = true;
+        } else if (opt == "-t") {
+            if (!parse_time_arg(argv[i+1], opts.to)) return usage(argv[0]);
+            opts.has_to = true;
+        } else if (opt == "-l") {
+            opts.level = LogLevel{std::string(argv[i+1])}.Get();
+        } else if (opt == "-j") {
+            threads = static_cast<unsigned>(atoi(argv[i+1]));
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    if (argc - i == 2) {
+        opts.pattern = argv[i++];
+    }
+    if (argc - i != 1) return usage(argv[0]);
+    if (threads == 0) threads = 1;
+    const std::string file{argv[i]};
+
+    int fd = ::open(file.c_str(), O_RDONLY);
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) != 0) {
+        std::cerr << "failed to open " << file << std::endl;
+        return 1;
+    }
+    size_t size = info.st_size;
+    if (size == 0) return 0;
+    void *map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        std::cerr << "failed to map " << file << std::endl;
+        return 1;
+    }
+    const char *data = static_cast<const char *>(map);
+
+    // narrow down the range to scan using the index
+    size_t begin = 0, end = size;
+    FileIndex index;
+    if ((opts.has_from || opts.has_to) && index.Load(file)) {
+        const int64_t ns = 1000000000ll;
+        if (opts.has_from) {
+            begin = std::min<uint64_t>(index.Begin(opts.from * ns), size);
+        }
+        if (opts.has_to) {
+            // the record time is taken a little before it is written,
+            // and it is truncated to seconds.
+            end = std::min<uint64_t>(index.End((opts.to + 2) * ns), size);
+        }
+    }
+    if (begin >= end) return 0;
+    madvise(const_cast<char *>(data) + (begin & ~static_cast<size_t>(4095)),
+            end - (begin & ~static_cast<size_t>(4095)), MADV_SEQUENTIAL);
+
+    // split the range into line aligned chunks
+    std::vector<size_t> bounds{begin};
+    size_t chunk = (end - begin) / threads + 1;
+    for (unsigned t = 1; t < threads; t++) {
+        size_t pos = bounds.back() + chunk;
+        if (pos >= end) break;
+        const void *nl = memchr(data + pos, '\n', end - pos);
+        if (!nl) break;
+        bounds.push_back(static_cast<const char *>(nl) - data + 1);
+    }
+    bounds.push_back(end);
+
+    std::vector<Scanner> scanners;
+    for (size_t c = 0; c + 1 < bounds.size(); c++) {
+        scanners.emplace_back(opts, data, bounds[c], bounds[c+1]);
+    }
+    std::vector<std::thread> workers;
+    for (auto &s : scanners) {
+        workers.emplace_back(&Scanner::Run, &s);
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+    for (auto &s : scanners) {
+        fwrite(s.Output().data(), 1, s.Output().size(), stdout);
+    }
+
+    munmap(map, size);
+    return 0;
+}
@@ -0,0 +1,206 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <iostream>
+#include <queue>
+#include <string>
+#include <vector>
+#include <slog/sharded_file_target.h>
+
+/**
+  * slog-merge merges the shard files written by `slog::ShardedFileTarget`
+  * into one stream ordered by the record timestamps.
+  *
+  * usage: slog-merge [-k] [-o output] <log-file | shard...>
+  *
+  * Given the log file name the tool merges all its "<log-file>.<tid>"
+  * shards. The timestamp prefixes are stripped unless -k is given.
+  *
+  * The shards are memory mapped and k-way merged through a heap of
+  * one cursor per shard, so the merge is a single linear pass over
+  * the input for a fixed number of shards.
+  */
+
+using namespace slog;
+
+namespace {
+
+struct shard_t {
+    std::string path;
+    const char *data{nullptr};
+    size_t size{0};
+    size_t pos{0};         // start of the next record
+    uint64_t ts{0};        // timestamp of the next record
+};
+
+// map_file maps the whole file read-only, returns false on failure.
+bool map_file(shard_t& s) {
+    int fd = ::open(s.path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        ::close(fd);
+        return false;
+    }
+    s.size = info.st_size;
+    if (s.size) {
+        void *p = mmap(nullptr, s.size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            ::close(fd);
+            return false;
+        }
+        madvise(p, s.size, MADV_SEQUENTIAL);
+        s.data = static_cast<const char *>(p);
+    }
+    ::close(fd);
+    return true;
+}
+
+// line_end returns the position after the line that starts at pos.
+inline size_t line_end(const shard_t& s, size_t pos) {
+    const void *nl = memchr(s.data + pos, '\n', s.size - pos);
+    return nl ? static_cast<const char *>(nl) - s.data + 1 : s.size;
+}
+
+// record_end returns the position after the record that starts at
+// pos, including its continuation lines, i.e. the lines which do
+// not start with a timestamp prefix.
+size_t record_end(const shard_t& s, size_t pos) {
+    size_t end = line_end(s, pos);
+    uint64_t ts;
+    while (end < s.size && !sharding::parse_prefix(s.data + end, s.size - end, ts)) {
+        end = line_end(s, end);
+    }
+    return end;
+}
+
+// shard_files returns the shards of the given log file,
+// sorted by name for a stable order of equal timestamps.
+std::vector<std::string> shard_files(const std::string& log_file) {
+    std::vector<std::string> files;
+    std::string dir = utils::dirname(log_file);
+    std::string base = dir.empty() ? log_file : log_file.substr(dir.size() + 1);
+    DIR *d = opendir(dir.empty() ? "." : dir.c_str());
+    if (!d) return files;
+    while (struct dirent *e = readdir(d)) {
+        std::string name{e->d_name};
+        if (name.size() <= base.size() + 1 || name.compare(0, base.size(), base) != 0 ||
+            name[base.size()] != '.') {
+            continue;
+        }
+        if (name.find_first_not_of("0123456789", base.size() + 1) != std::string::npos) {
+            continue;
+        }
+        files.push_back(dir.empty() ? name : dir + directory_separator + name);
+    }
+    closedir(d);
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+int usage(const char *prog) {
+    std::cerr << "usage: " << prog << " [-k] [-o output] <log-file | shard...>\n";
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    bool keep_prefix = false;
+    const char *output = nullptr;
+
+    int i = 1;
+    for (; i < argc && argv[i][0] == '-'; i++) {
+        std::string opt{argv[i]};
+        if (opt == "-k") {
+            keep_prefix = true;
+        } else if (opt == "-o" && i + 1 < argc) {
+            output = argv[++i];
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    if (i == argc) return usage(argv[0]);
+
+    std::vector<std::string> files;
+    if (argc - i == 1 && !utils::file_exists(argv[i])) {
+        files = shard_files(argv[i]);
+        if (files.empty()) {
+            std::cerr << "no shards found for " << argv[i] << std::endl;
+            return 1;
+        }
+    } else {
+        files.assign(argv + i, argv + argc);
+    }
+
+    std::vector<shard_t> shards(files.size());
+    for (size_t n = 0; n < files.size(); n++) {
+        shards[n].path = files[n];
+        if (!map_file(shards[n])) {
+            std::cerr << "failed to read " << files[n] << std::endl;
+            return 1;
+        }
+    }
+
+    FILE *out = output ? fopen(output, "wb") : stdout;
+    if (!out) {
+        std::cerr << "failed to open " << output << std::endl;
+        return 1;
+    }
+    static char out_buf[1 << 20];
+    setvbuf(out, out_buf, _IOFBF, sizeof(out_buf));
+
+    // min-heap of (timestamp, shard index) of the next record of each shard
+    typedef std::pair<uint64_t, size_t> cursor_t;
+    std::priority_queue<cursor_t, std::vector<cursor_t>, std::greater<cursor_t> > heap;
+    for (size_t n = 0; n < shards.size(); n++) {
+        shard_t& s = shards[n];
+        if (s.size == 0) continue;
+        // leading lines without a prefix sort before everything else
+        if (!sharding::parse_prefix(s.data, s.size, s.ts)) s.ts = 0;
+        heap.push(cursor_t(s.ts, n));
+    }
+
+    while (!heap.empty()) {
+        size_t n = heap.top().second;
+        shard_t& s = shards[n];
+        heap.pop();
+
+        size_t end = record_end(s, s.pos);
+        size_t skip = keep_prefix ? 0 : std::min(sharding::prefix_size, end - s.pos);
+        uint64_t ts;
+        if (!sharding::parse_prefix(s.data + s.pos, end - s.pos, ts)) skip = 0;
+        fwrite(s.data + s.pos + skip, 1, end - s.pos - skip, out);
+        if (s.data[end-1] != '\n') fputc('\n', out);
+
+        s.pos = end;
+        if (s.pos < s.size) {
+            sharding::parse_prefix(s.data + s.pos, s.size - s.pos, s.ts);
+            heap.push(cursor_t(s.ts, n));
+        }
+    }
+
+    if (fflush(out) != 0) {
+        std::cerr << "failed to write the output" << std::endl;
+        return 1;
+    }
+    if (output) fclose(out);
+    for (auto &s : shards) {
+        if (s.data) munmap(const_cast<char *>(s.data), s.size);
+    }
+    return 0;
+}
@@ -0,0 +1,290 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <slog/config.h>
+#include <slog/logger.h>
+#include <slog/record_format.h>
+#include <slog/shm_target.h>
+
+/**
+  * slog-replay replays the logging load recorded in a text log file,
+  * to reproduce it through a logger and target graph.
+  *
+  * usage: slog-replay [-c config] [-n logger] [-o out-file] [-s speed] [-j threads] <log-file>
+  *
+  *   -c  configuration file of the replaying logger, see slog::Config
+  *   -n  name of the configured logger, defaults to "replay"
+  *   -o  log file written without a configuration, defaults to
+  *       logs/slog-replay.log
+  *   -s  speed up factor of the recorded timing, 1 replays in real
+  *       time, 0 as fast as possible. Defaults to 1.
+  *   -j  number of threads replaying the records, defaults to 1
+  *
+  * The records keep their level and message, so the level mix and the
+  * message sizes are those of the recorded load. The record times have
+  * a resolution of a second, the records of the same second are spread
+  * evenly over it. The records are dealt out to the threads round robin.
+  *
+  * Reports the throughput, the latency of the log calls, the calls
+  * blocked for a millisecond or more, how far behind the schedule the
+  * replay fell, and the records dropped by shared memory targets.
+  */
+
+using namespace slog;
+using namespace std::chrono;
+
+namespace {
+
+struct options_t {
+    std::string config;
+    std::string name{"replay"};
+    std::string out{"logs/slog-replay.log"};
+    double speed{1};
+    unsigned threads{1};
+};
+
+// record_t is a recorded log record
+struct record_t {
+    double offset;            // seconds since the first record
+    LogLevel::level_t level;
+    const char *msg;
+    size_t len;
+};
+
+// calls that take this long are counted as blocked
+const int64_t blocked_ns = 1000000;
+
+// parse reads the records of the log file, continuation lines are
+// part of the message of the previous record.
+std::vector<record_t> parse(const char *data, size_t size) {
+    std::vector<record_t> records;
+    std::vector<std::time_t> times;
+    RecordParser parser;
+    for (size_t pos = 0; pos < size; ) {
+        const char *nl = static_cast<const char *>(memchr(data + pos, '\n', size - pos));
+        size_t end = nl ? nl - data : size;
+        RecordFields f;
+        if (parser.Parse(data + pos, end - pos, f)) {
+            LogLevel::level_t level = f.level;
+            if (level <= LogLevel::None || level >= LogLevel::Max) level = LogLevel::Info;
+            records.push_back(record_t{0, level, f.msg, f.msg_len});
+            times.push_back(f.time);
+        } else if (!records.empty()) {
+            record_t &r = records.back();
+            r.len = data + end - r.msg;
+        }
+        pos = end + 1;
+    }
+
+    // spread the records of each second evenly over it
+    for (size_t i = 0; i < records.size(); ) {
+        size_t j = i;
+        while (j < records.size() && times[j] == times[i]) j++;
+        for (size_t k = i; k < j; k++) {
+            records[k].offset = static_cast<double>(times[i] - times[0]) +
+                static_cast<double>(k - i) / static_cast<double>(j - i);
+        }
+        i = j;
+    }
+    return records;
+}
+
+// stats_t is what a replaying thread measured
+struct stats_t {
+    std::vector<int64_t> latencies; // nanoseconds
+    uint64_t bytes{0};
+    int64_t blocked{0};             // time spent in blocked calls
+    uint64_t blocked_calls{0};
+    int64_t max_lag{0};             // nanoseconds behind the schedule
+};
+
+template <typename LoggerT>
+void log_record(LoggerT& log, const record_t& r) {
+    int len = static_cast<int>(r.len);
+    switch (r.level) {
+    case LogLevel::Critical: log.Critical("%.*s", len, r.msg); break;
+    case LogLevel::Error:    log.Error("%.*s", len, r.msg); break;
+    case LogLevel::Warning:  log.Warning("%.*s", len, r.msg); break;
+    case LogLevel::Debug:    log.Debug("%.*s", len, r.msg); break;
+    case LogLevel::Trace:    log.Trace("%.*s", len, r.msg); break;
+    default:                 log.Info("%.*s", len, r.msg); break;
+    }
+}
+
+template <typename LoggerT>
+void replay_thread(LoggerT& log, const std::vector<record_t>& records, unsigned id, unsigned threads,
+                   double speed, steady_clock::time_point start, stats_t& stats) {
+    stats.latencies.reserve(records.size() / threads + 1);
+    for (size_t i = id; i < records.size(); i += threads) {
+        const record_t &r = records[i];
+        if (speed > 0) {
+            auto due = start + duration_cast<steady_clock::duration>(duration<double>(r.offset / speed));
+            auto now = steady_clock::now();
+            if (due > now) {
+                std::this_thread::sleep_until(due);
+            } else {
+                stats.max_lag = std::max<int64_t>(stats.max_lag, duration_cast<nanoseconds>(now - due).count());
+            }
+        }
+        auto t0 = steady_clock::now();
+        log_record(log, r);
+        int64_t ns = duration_cast<nanoseconds>(steady_clock::now() - t0).count();
+        stats.latencies.push_back(ns);
+        stats.bytes += r.len;
+        if (ns >= blocked_ns) {
+            stats.blocked += ns;
+            stats.blocked_calls++;
+        }
+    }
+}
+
+// dropped returns the number of records dropped by the shared memory
+// targets of the logger
+template <typename LoggerT>
+uint64_t dropped(LoggerT& log) {
+    uint64_t n = 0;
+    for (auto &t : log.Targets()) {
+        auto shm = std::dynamic_pointer_cast<ShmTarget>(t);
+        if (shm) n += shm->Queue()->Dropped();
+    }
+    return n;
+}
+
+template <typename LoggerT>
+void replay(LoggerT& log, const std::vector<record_t>& records, const options_t& opts) {
+    uint64_t dropped_before = dropped(log);
+    std::vector<stats_t> stats(opts.threads);
+    std::vector<std::thread> workers;
+    auto start = steady_clock::now();
+    for (unsigned t = 0; t < opts.threads; t++) {
+        workers.emplace_back([&, t]() {
+            replay_thread(log, records, t, opts.threads, opts.speed, start, stats[t]);
+        });
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+    log.Flush();
+    double elapsed = duration<double>(steady_clock::now() - start).count();
+
+    stats_t all;
+    for (auto &s : stats) {
+        all.latencies.insert(all.latencies.end(), s.latencies.begin(), s.latencies.end());
+        all.bytes += s.bytes;
+        all.blocked += s.blocked;
+        all.blocked_calls += s.blocked_calls;
+        all.max_lag = std::max(all.max_lag, s.max_lag);
+    }
+    std::sort(all.latencies.begin(), all.latencies.end());
+    auto percentile = [&all](double p) -> double {
+        if (all.latencies.empty()) return 0;
+        size_t i = static_cast<size_t>(p / 100 * (all.latencies.size() - 1) + 0.5);
+        return all.latencies[i] / 1e3;
+    };
+
+    size_t n = all.latencies.size();
+    printf("records:    %zu in %.3f s, %u threads\n", n, elapsed, opts.threads);
+    printf("throughput: %.0f records/s, %.2f MiB/s\n", n / elapsed, all.bytes / elapsed / (1024 * 1024));
+    printf("latency us: p50 %.2f, p90 %.2f, p99 %.2f, p99.9 %.2f, max %.2f\n",
+           percentile(50), percentile(90), percentile(99), percentile(99.9), percentile(100));
+    printf("blocked:    %llu calls >= 1 ms, %.3f s\n",
+           static_cast<unsigned long long>(all.blocked_calls), all.blocked / 1e9);
+    if (opts.speed > 0) {
+        printf("lag:        %.3f s behind the schedule at most\n", all.max_lag / 1e9);
+    }
+    printf("dropped:    %llu records\n", static_cast<unsigned long long>(dropped(log) - dropped_before));
+}
+
+int usage(const char *prog) {
+    std::cerr << "usage: " << prog
+              << " [-c config] [-n logger] [-o out-file] [-s speed] [-j threads] <log-file>\n";
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    options_t opts;
+
+    int i = 1;
+    for (; i + 1 < argc && argv[i][0] == '-'; i += 2) {
+        std::string opt{argv[i]};
+        if (opt == "-c") {
+            opts.config = argv[i+1];
+        } else if (opt == "-n") {
+            opts.name = argv[i+1];
+        } else if (opt == "-o") {
+            opts.out = argv[i+1];
+        } else if (opt == "-s") {
+            opts.speed = atof(argv[i+1]);
+        } else if (opt == "-j") {
+            opts.threads = static_cast<unsigned>(atoi(argv[i+1]));
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    if (argc - i != 1 || opts.speed < 0) return usage(argv[0]);
+    if (opts.threads == 0) opts.threads = 1;
+    const std::string file{argv[i]};
+
+    int fd = ::open(file.c_str(), O_RDONLY);
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) != 0) {
+        std::cerr << "failed to open " << file << std::endl;
+        return 1;
+    }
+    size_t size = info.st_size;
+    if (size == 0) return 0;
+    void *map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        std::cerr << "failed to map " << file << std::endl;
+        return 1;
+    }
+    auto records = parse(static_cast<const char *>(map), size);
+    if (records.empty()) {
+        std::cerr << "no records found in " << file << std::endl;
+        munmap(map, size);
+        return 1;
+    }
+
+    try {
+        if (!opts.config.empty()) {
+            Config config{opts.config};
+            replay(*config.Logger(opts.name), records, opts);
+        } else {
+            auto target = std::make_shared<FileTarget<std::mutex> >(opts.out, LogLevel::Trace);
+            Logger log{opts.name, LogLevel::Trace, target};
+            replay(log, records, opts);
+        }
+    } catch(FileException &exp) {
+        std::cerr << "Exception: " << exp.what() << ": " << exp.file() << std::endl;
+        return 1;
+    } catch(ConfigException &exp) {
+        std::cerr << "Exception: " << exp.what() << std::endl;
+        return 1;
+    }
+
+    munmap(map, size);
+    return 0;
+}
@@ -0,0 +1,453 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <slog/log_level.h>
+#include <slog/record_format.h>
+
+/**
+  * slog-stats summarizes text log files in the Logger record layout,
+  * for a quick look at a large amount of logs.
+  *
+  * usage: slog-stats [-j threads] [-n top] [-f text|csv] <log-file>...
+  *
+  *   -j  number of threads, defaults to the number of cores
+  *   -n  number of the most frequent formats reported, defaults to 20
+  *   -f  report format, text (default) or csv
+  *
+  * Reports the records per level per minute, the most frequent message
+  * formats, i.e. the messages with their numbers replaced by '#', and
+  * the records and their rate per process id. The lines that are not
+  * in the record layout continue the previous record, and are counted
+  * apart.
+  *
+  * The files are mapped into memory and split into line aligned chunks,
+  * processed by all the threads, each into its own tables which are
+  * merged at the end.
+  */
+
+using namespace slog;
+
+namespace {
+
+struct options_t {
+    unsigned threads{0};
+    size_t top{20};
+    bool csv{false};
+};
+
+// a format is identified by the hash of its normalized message
+struct format_t {
+    uint64_t count{0};
+    LogLevel::level_t level{LogLevel::Unknown}; // level of the first record
+    const char *msg{nullptr};                   // message of the first record
+    size_t len{0};
+};
+
+struct pid_stats_t {
+    uint64_t records{0};
+    uint64_t bytes{0};
+    std::time_t first{0};
+    std::time_t last{0};
+};
+
+using level_counts_t = std::array<uint64_t, LogLevel::Max>;
+
+// stats_t holds the aggregates of a chunk, or of all of them
+struct stats_t {
+    uint64_t records{0};
+    uint64_t bytes{0};
+    uint64_t continuations{0}; // lines that are not in the record layout
+    std::time_t first{0};
+    std::time_t last{0};
+    level_counts_t levels{};
+    std::unordered_map<std::time_t, level_counts_t> minutes;
+    std::unordered_map<uint64_t, format_t> formats;
+    std::unordered_map<long, pid_stats_t> pids;
+
+    void merge(const stats_t& other);
+};
+
+// chunk_t is a line aligned part of a mapped file
+struct chunk_t {
+    const char *begin;
+    const char *end;
+};
+
+// formats longer than this are told apart by their beginning only
+const size_t max_format_len = 256;
+
+bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+bool is_number_char(char c) {
+    return is_digit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F') ||
+           c == 'x' || c == 'X' || c == '.' || c == ':' || c == '-';
+}
+
+// normalize calls out(c) for each character of the format of the
+// message: the numbers, with their hexadecimal digits, decimal points,
+// and time or address separators, are replaced by '#'.
+template <typename Out>
+void normalize(const char *msg, size_t len, Out out) {
+    if (len > max_format_len) len = max_format_len;
+    for (size_t i = 0; i < len; ) {
+        if (is_digit(msg[i])) {
+            while (i < len && is_number_char(msg[i])) i++;
+            out('#');
+        } else {
+            out(msg[i++]);
+        }
+    }
+}
+
+// format_hash is the FNV-1a hash of the format of the message
+uint64_t format_hash(const char *msg, size_t len) {
+    uint64_t h = 14695981039346656037ull;
+    normalize(msg, len, [&h](char c) {
+        h = (h ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+    });
+    return h;
+}
+
+std::string format_text(const format_t& f) {
+    std::string s;
+    normalize(f.msg, f.len, [&s](char c) {
+        s += c == '\n' ? ' ' : c;
+    });
+    if (f.len > max_format_len) s += "...";
+    return s;
+}
+
+void stats_t::merge(const stats_t& other) {
+    if (!other.records) {
+        continuations += other.continuations;
+        return;
+    }
+    if (!records || other.first < first) first = other.first;
+    if (!records || other.last > last) last = other.last;
+    records += other.records;
+    bytes += other.bytes;
+    continuations += other.continuations;
+    for (int l = 0; l < LogLevel::Max; l++) {
+        levels[l] += other.levels[l];
+    }
+    for (auto &kv : other.minutes) {
+        auto &counts = minutes[kv.first];
+        for (int l = 0; l < LogLevel::Max; l++) {
+            counts[l] += kv.second[l];
+        }
+    }
+    for (auto &kv : other.formats) {
+        auto it = formats.find(kv.first);
+        if (it == formats.end()) {
+            formats.insert(kv);
+        } else {
+            it->second.count += kv.second.count;
+            if (kv.second.msg < it->second.msg) {
+                // keep the earliest record of a file as the example
+                it->second.msg = kv.second.msg;
+                it->second.len = kv.second.len;
+                it->second.level = kv.second.level;
+            }
+        }
+    }
+    for (auto &kv : other.pids) {
+        auto &p = pids[kv.first];
+        if (!p.records || kv.second.first < p.first) p.first = kv.second.first;
+        if (!p.records || kv.second.last > p.last) p.last = kv.second.last;
+        p.records += kv.second.records;
+        p.bytes += kv.second.bytes;
+    }
+}
+
+// process aggregates the records of the chunk
+void process(const chunk_t& chunk, stats_t& stats) {
+    RecordParser parser;
+    stats.formats.reserve(1024);
+    // the records of the same minute and process follow each other,
+    // remember the last table entries
+    std::time_t minute = -1;
+    level_counts_t *counts = nullptr;
+    long pid = 0;
+    pid_stats_t *p = nullptr;
+
+    for (const char *pos = chunk.begin; pos < chunk.end; ) {
+        const char *nl = static_cast<const char *>(memchr(pos, '\n', chunk.end - pos));
+        const char *end = nl ? nl : chunk.end;
+        RecordFields f;
+        if (!parser.Parse(pos, end - pos, f)) {
+            stats.continuations++;
+            pos = end + 1;
+            continue;
+        }
+        size_t len = end - pos;
+        if (!stats.records || f.time < stats.first) stats.first = f.time;
+        if (!stats.records || f.time > stats.last) stats.last = f.time;
+        stats.records++;
+        stats.bytes += len + 1;
+        stats.levels[f.level]++;
+
+        if (f.time - f.time % 60 != minute || !counts) {
+            minute = f.time - f.time % 60;
+            counts = &stats.minutes[minute];
+        }
+        (*counts)[f.level]++;
+
+        format_t &fmt = stats.formats[format_hash(f.msg, f.msg_len)];
+        if (!fmt.count++) {
+            fmt.level = f.level;
+            fmt.msg = f.msg;
+            fmt.len = f.msg_len;
+        }
+
+        if (f.pid != pid || !p) {
+            pid = f.pid;
+            p = &stats.pids[pid];
+            if (!p->records) p->first = f.time;
+        }
+        p->records++;
+        p->bytes += len + 1;
+        if (f.time > p->last) p->last = f.time;
+        if (f.time < p->first) p->first = f.time;
+
+        pos = end + 1;
+    }
+}
+
+// split splits the file into about n line aligned chunks
+void split(const char *data, size_t size, size_t n, std::vector<chunk_t>& chunks) {
+    size_t chunk_size = size / n + 1;
+    const char *begin = data;
+    const char *end = data + size;
+    while (begin < end) {
+        const char *stop = begin + std::min(chunk_size, static_cast<size_t>(end - begin));
+        if (stop < end) {
+            const char *nl = static_cast<const char *>(memchr(stop, '\n', end - stop));
+            stop = nl ? nl + 1 : end;
+        }
+        chunks.push_back(chunk_t{begin, stop});
+        begin = stop;
+    }
+}
+
+std::string time_text(std::time_t t, const char *fmt) {
+    char buf[32];
+    struct tm tm;
+    localtime_r(&t, &tm);
+    strftime(buf, sizeof(buf), fmt, &tm);
+    return buf;
+}
+
+// csv_quote quotes the field for a CSV file
+std::string csv_quote(const std::string& s) {
+    std::string q{"\""};
+    for (char c : s) {
+        if (c == '"') q += '"';
+        q += c;
+    }
+    return q + "\"";
+}
+
+std::vector<const std::pair<const uint64_t, format_t> *> top_formats(const stats_t& stats, size_t top) {
+    std::vector<const std::pair<const uint64_t, format_t> *> formats;
+    formats.reserve(stats.formats.size());
+    for (auto &kv : stats.formats) {
+        formats.push_back(&kv);
+    }
+    size_t n = std::min(top, formats.size());
+    std::partial_sort(formats.begin(), formats.begin() + n, formats.end(),
+        [](const std::pair<const uint64_t, format_t> *a, const std::pair<const uint64_t, format_t> *b) {
+            return a->second.count > b->second.count;
+        });
+    formats.resize(n);
+    return formats;
+}
+
+void report_text(const stats_t& stats, const options_t& opts) {
+    const int levels[] = {LogLevel::Critical, LogLevel::Error, LogLevel::Warning,
+                          LogLevel::Info, LogLevel::Debug, LogLevel::Trace};
+
+    printf("records: %llu, %llu continuation lines, %s to %s\n",
+           static_cast<unsigned long long>(stats.records), static_cast<unsigned long long>(stats.continuations),
+           time_text(stats.first, "%Y-%m-%d %H:%M:%S").c_str(), time_text(stats.last, "%Y-%m-%d %H:%M:%S").c_str());
+    printf("levels: ");
+    for (int l : levels) {
+        printf(" %c %llu", LogLevel(l).ToChar(), static_cast<unsigned long long>(stats.levels[l]));
+    }
+
+    printf("\n\nper minute:        %10s %10s %10s %10s %10s %10s\n", "critical", "error", "warning", "info", "debug", "trace");
+    std::vector<std::time_t> minutes;
+    for (auto &kv : stats.minutes) {
+        minutes.push_back(kv.first);
+    }
+    std::sort(minutes.begin(), minutes.end());
+    for (auto m : minutes) {
+        auto &counts = stats.minutes.at(m);
+        printf("%s  ", time_text(m, "%Y-%m-%d %H:%M").c_str());
+        for (int l : levels) {
+            printf(" %10llu", static_cast<unsigned long long>(counts[l]));
+        }
+        printf("\n");
+    }
+
+    printf("\ntop formats:\n");
+    for (auto f : top_formats(stats, opts.top)) {
+        printf("%10llu  [%c] %s\n", static_cast<unsigned long long>(f->second.count),
+               LogLevel(f->second.level).ToChar(), format_text(f->second).c_str());
+    }
+
+    printf("\nper pid:      %10s %10s %12s\n", "records", "KiB", "records/s");
+    std::vector<std::pair<long, pid_stats_t> > pids(stats.pids.begin(), stats.pids.end());
+    std::sort(pids.begin(), pids.end(), [](const std::pair<long, pid_stats_t>& a, const std::pair<long, pid_stats_t>& b) {
+        return a.second.records > b.second.records;
+    });
+    for (auto &p : pids) {
+        printf("%-12ld  %10llu %10llu %12.1f\n", p.first, static_cast<unsigned long long>(p.second.records),
+               static_cast<unsigned long long>(p.second.bytes / 1024),
+               static_cast<double>(p.second.records) / static_cast<double>(p.second.last - p.second.first + 1));
+    }
+}
+
+void report_csv(const stats_t& stats, const options_t& opts) {
+    printf("minute,critical,error,warning,info,debug,trace\n");
+    std::vector<std::time_t> minutes;
+    for (auto &kv : stats.minutes) {
+        minutes.push_back(kv.first);
+    }
+    std::sort(minutes.begin(), minutes.end());
+    for (auto m : minutes) {
+        auto &counts = stats.minutes.at(m);
+        printf("%s", time_text(m, "%Y-%m-%dT%H:%M").c_str());
+        for (int l = LogLevel::Critical; l <= LogLevel::Trace; l++) {
+            printf(",%llu", static_cast<unsigned long long>(counts[l]));
+        }
+        printf("\n");
+    }
+
+    printf("\ncount,level,format\n");
+    for (auto f : top_formats(stats, opts.top)) {
+        printf("%llu,%s,%s\n", static_cast<unsigned long long>(f->second.count),
+               LogLevel(f->second.level).ToString().c_str(), csv_quote(format_text(f->second)).c_str());
+    }
+
+    printf("\npid,records,bytes,first,last\n");
+    for (auto &kv : stats.pids) {
+        printf("%ld,%llu,%llu,%s,%s\n", kv.first, static_cast<unsigned long long>(kv.second.records),
+               static_cast<unsigned long long>(kv.second.bytes),
+               time_text(kv.second.first, "%Y-%m-%dT%H:%M:%S").c_str(),
+               time_text(kv.second.last, "%Y-%m-%dT%H:%M:%S").c_str());
+    }
+}
+
+int usage(const char *prog) {
+    std::cerr << "usage: " << prog << " [-j threads] [-n top] [-f text|csv] <log-file>...\n";
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    options_t opts;
+
+    int i = 1;
+    for (; i + 1 < argc && argv[i][0] == '-'; i += 2) {
+        std::string opt{argv[i]};
+        if (opt == "-j") {
+            opts.threads = static_cast<unsigned>(atoi(argv[i+1]));
+        } else if (opt == "-n") {
+            opts.top = static_cast<size_t>(atol(argv[i+1]));
+        } else if (opt == "-f" && (std::string(argv[i+1]) == "text" || std::string(argv[i+1]) == "csv")) {
+            opts.csv = std::string(argv[i+1]) == "csv";
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    if (i == argc) return usage(argv[0]);
+    if (opts.threads == 0) opts.threads = std::max(1u, std::thread::hardware_concurrency());
+
+    // the mappings stay until the end, the formats point into them
+    std::vector<std::pair<void *, size_t> > maps;
+    std::vector<chunk_t> chunks;
+    size_t total = 0;
+    for (; i < argc; i++) {
+        int fd = ::open(argv[i], O_RDONLY);
+        struct stat info;
+        if (fd < 0 || fstat(fd, &info) != 0) {
+            std::cerr << "failed to open " << argv[i] << std::endl;
+            return 1;
+        }
+        size_t size = info.st_size;
+        if (size == 0) {
+            ::close(fd);
+            continue;
+        }
+        void *map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (map == MAP_FAILED) {
+            std::cerr << "failed to map " << argv[i] << std::endl;
+            return 1;
+        }
+        madvise(map, size, MADV_SEQUENTIAL);
+        maps.emplace_back(map, size);
+        total += size;
+        // several chunks per thread even out the uneven ones
+        split(static_cast<const char *>(map), size, opts.threads * 4, chunks);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<stats_t> stats(opts.threads);
+    std::vector<std::thread> workers;
+    std::atomic<size_t> next{0};
+    for (unsigned t = 0; t < opts.threads; t++) {
+        workers.emplace_back([&, t]() {
+            for (size_t c; (c = next.fetch_add(1)) < chunks.size(); ) {
+                process(chunks[c], stats[t]);
+            }
+        });
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+    stats_t all;
+    for (auto &s : stats) {
+        all.merge(s);
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (opts.csv) {
+        report_csv(all, opts);
+    } else {
+        report_text(all, opts);
+        printf("\nread %.1f MiB in %.3f s (%.0f MiB/s) on %u threads\n", total / (1024.0 * 1024),
+               elapsed, total / (1024.0 * 1024) / elapsed, opts.threads);
+    }
+
+    for (auto &m : maps) {
+        munmap(m.first, m.second);
+    }
+    return 0;
+}
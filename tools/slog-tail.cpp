@@ -0,0 +1,94 @@
+/* Copyright (C) 2023 Amarnath Valluri - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: , or visit:
+ * https://opensource.org/license/MIT/
+ */
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <slog/log_reader.h>
+#include <slog/file_exception.h>
+
+/**
+  * slog-tail follows a log file written by `slog::FileTarget`, plain
+  * text or framed, across rotations and truncations, and writes its
+  * records to the standard output.
+  *
+  * usage: slog-tail [-c checkpoint-file] [-l level] [-n] <log-file>
+  *
+  *   -c  resume from the checkpoint saved in the file, and save the
+  *       checkpoint there whenever the reader caught up with the file
+  *   -l  show only records of the given level or more severe
+  *   -n  do not follow, stop at the end of the file
+  */
+
+static volatile std::sig_atomic_t stop = 0;
+
+static void on_signal(int) {
+    stop = 1;
+}
+
+static int usage(const char *prog) {
+    std::cerr << "usage: " << prog << " [-c checkpoint-file] [-l level] [-n] <log-file>\n";
+    return 2;
+}
+
+int main(int argc, char *argv[])
+{
+    std::string checkpoint_file;
+    slog::LogLevel::level_t level = slog::LogLevel::Unknown;
+    bool follow = true;
+
+    int i = 1;
+    for (; i < argc && argv[i][0] == '-'; i++) {
+        std::string opt{argv[i]};
+        if (opt == "-n") {
+            follow = false;
+        } else if (opt == "-c" && i + 1 < argc) {
+            checkpoint_file = argv[++i];
+        } else if (opt == "-l" && i + 1 < argc) {
+            level = slog::LogLevel{std::string(argv[++i])}.Get();
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    if (argc - i != 1) return usage(argv[0]);
+
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+
+    try {
+        slog::ReaderCheckpoint checkpoint;
+        if (!checkpoint_file.empty()) {
+            checkpoint.Load(checkpoint_file);
+        }
+        slog::LogReader reader{argv[i], checkpoint};
+        slog::LogRecord r;
+        while (!stop) {
+            while (!stop && reader.Next(r)) {
+                if (level != slog::LogLevel::Unknown &&
+                    (r.fields.level == slog::LogLevel::Unknown || r.fields.level > level)) {
+                    continue;
+                }
+                fwrite(r.data, 1, r.len, stdout);
+                fputc('\n', stdout);
+            }
+            fflush(stdout);
+            if (!checkpoint_file.empty() && !reader.Checkpoint().Save(checkpoint_file)) {
+                std::cerr << "failed to save the checkpoint to " << checkpoint_file << std::endl;
+                return 1;
+            }
+            if (!follow) break;
+            reader.Wait(1000);
+        }
+    } catch(slog::FileException &exp) {
+        std::cerr << "Exception: " << exp.what() << ": " << exp.file() << std::endl;
+        return 1;
+    }
+    return 0;
+}